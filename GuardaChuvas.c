@@ -13,26 +13,49 @@
 #include "hardware/adc.h"          // Funções para conversão analógico-digital (ADC)
 #include "hardware/i2c.h"          // Funções para comunicação I2C (usada pelo display OLED)
 #include "hardware/pwm.h"          // Funções para modulação por largura de pulso (PWM) para LED RGB e buzzer
+#include "hardware/clocks.h"       // Frequência do sistema (bancada dos filtros)
 #include "lib/ssd1306.h"           // Biblioteca para controle do display OLED SSD1306
 #include "lib/font.h"              // Fonte para exibição de caracteres no display OLED
 #include "FreeRTOS.h"              // Núcleo do FreeRTOS para gerenciamento de tarefas e filas
 #include "task.h"                  // Funções para criação e manipulação de tarefas
 #include "queue.h"                 // Funções para criação e uso de filas
+#include "timers.h"                // Software timers (silêncio e limpeza do alarme)
 #include <stdio.h>                 // Funções padrão de entrada/saída (ex.: printf para depuração)
 #include <string.h>                // Funções para manipulação de strings (ex.: snprintf)
 #include "pico/bootrom.h"          // Funções para reinicialização em modo BOOTSEL
-#include "lib/animacoes.h"         // Funções para animações na matriz WS2812B 5x5
+#include "lib/matrizled.h"         // Driver WS2812B por instância (PIO + DMA)
+#include "lib/animador.h"          // Motor de animação da matriz (linhas do tempo e crossfade)
+#include "lib/anim_linhas.h"       // Linhas do tempo da matriz (nível de água e estado)
+#include "lib/historico.h"         // Histórico em cascata (10 Hz, 1 Hz, 1/min) dos sensores
+#include "lib/tendencia.h"         // Gráficos de tendência (sparklines) no display OLED
+#include "lib/compositor.h"        // Widgets retidos e envio parcial do display OLED
+#include "lib/rotulos.h"           // Rótulos de estado pré-rasterizados (tools/rasterizar_rotulos.py)
+#include "lib/telemetria.h"        // Telemetria binária (COBS + CRC) pela USB
+#include "lib/config.h"            // Configuração de campo em flash (limiares, períodos, padrões)
+#include "lib/alerta.h"            // Estados de risco e classificação
+#include "lib/alarme.h"            // Reconhecimento, escalada e limpeza do alarme
+#include "lib/calibracao.h"        // Conversão inteira (offset/ganho, %, mm, mm/h) sem divisão
+#include "lib/sensores.h"          // Registro de canais de sensores (ADC, temperatura, I2C)
+#include "lib/filtros.h"           // Mediana, EMA e biquad em Q15 para a cadeia dos canais
+#include "lib/efeito_rgb.h"        // Efeitos do LED RGB numa interrupção de tique fixo
+#include "lib/supervisor.h"        // Watchdog com batidas e prazos por tarefa
+#include "lib/botoes.h"            // Debounce e gestos dos botões (clique, duplo, longo)
+#include "lib/publicador.h"        // Lotes de telemetria por MQTT com armazenamento e reenvio
+#include "lib/boot.h"              // Marcas de tempo da partida até a primeira amostra nas saídas
+#include "lib/perfil_xip.h"        // Código quente na SRAM e perfil do cache XIP por estágio
 
 /* === Definições de Hardware === */
 // Pinos I2C para o display OLED SSD1306
 #define I2C_PORT i2c1              // Porta I2C usada (i2c1)
 #define I2C_SDA 14                 // Pino SDA (GPIO14)
 #define I2C_SCL 15                 // Pino SCL (GPIO15)
+#define I2C_FREQ 400000            // 400 kHz
 #define ENDERECO_OLED 0x3C         // Endereço I2C do display OLED (0x3C)
 
 // Pinos ADC para sensores simulados
 #define ADC_SENSOR_CHUVA 26        // GPIO26 (ADC0) para sensor de volume de chuva
 #define ADC_SENSOR_AGUA 27         // GPIO27 (ADC1) para sensor de nível de água
+#define ADC_PRIMEIRO_GPIO 26       // GPIO do ADC0
 
 // Pinos PWM para LED RGB
 #define LED_RGB_RED 13             // GPIO13 para canal vermelho do LED RGB
@@ -45,11 +68,61 @@
 // Pino PWM para buzzer
 #define BUZZER 21                  // GPIO21 para buzzer
 
-// Pino de entrada para botão
-#define BOTAO_B 6                  // GPIO6 para botão B (BOOTSEL)
+// Pinos de entrada para botões
+#define BOTAO_A 5                  // GPIO5 para botão A (troca de tela)
+#define BOTAO_B 6                  // GPIO6 para botão B (silenciar alarme; BOOTSEL na pressão longa)
+#define BOTAO_A_LONGO_MS 1000      // Pressão longa no A: volta à tela de valores
+#define BOTAO_B_LONGO_MS 3000      // Pressão longa no B: BOOTSEL (só de propósito)
 
-// Definição redundante (já declarada acima, pode ser um erro no código original)
-#define MATRIZ_WS2812B 7           // Repetição do pino da matriz WS2812B
+// Telemetria binária pela USB (TELEMETRIA_ATIVA em lib/telemetria.h)
+#ifndef TELEMETRIA_BRUTO_HZ
+#define TELEMETRIA_BRUTO_HZ 0      // Pares ADC0/ADC1 por segundo no modo bruto (0 = desligado)
+#endif
+#define TAREFAS_RELATORIO_MS 10000 // Pior ativação de cada tarefa (tools/escalonabilidade.py --medidas)
+
+// Bancada dos filtros no boot: ciclos por amostra de cada estágio pelo printf
+#ifndef FILTROS_MEDIR
+#define FILTROS_MEDIR 0
+#endif
+
+// Publicador MQTT pelo Wi-Fi do Pico W (o CMake liga quando WIFI_SSID e MQTT_BROKER são definidos)
+#ifndef PUBLICADOR_ATIVO
+#define PUBLICADOR_ATIVO 0
+#endif
+#define MQTT_PORTA 1883
+#define PUBLICADOR_EVENTOS 16      // Eventos aguardando a tarefa do publicador
+#define PUBLICADOR_SERVIR_MS 100   // Maior intervalo entre voltas da rede
+#define PRAZO_PUBLICADOR_MS 2000   // Nenhuma chamada de rede bloqueia: só um travamento vence
+
+#if PUBLICADOR_ATIVO
+#include "pico/unique_id.h"        // Nome da estação no tópico e id do cliente MQTT
+#include "pico/rand.h"             // Sessão sorteada a cada boot
+#include "lib/mqtt_picow.h"        // Wi-Fi do CYW43 e cliente MQTT da lwIP
+#endif
+
+// Logs de texto só quando a USB não está ocupada com a telemetria binária
+#if TELEMETRIA_ATIVA
+#define LOG(...) ((void)0)
+#else
+#define LOG(...) printf(__VA_ARGS__)
+#endif
+
+// Relógio de quadros da matriz
+#define MATRIZ_QUADRO_MS 20        // 50 quadros/s para fades e crossfades suaves
+#define MATRIZ_FADE_NIVEL_MS 300   // Crossfade ao mudar a faixa de nível de água
+#define MATRIZ_FADE_ESTADO_MS 500  // Crossfade ao mudar de estado
+
+// Efeitos do LED RGB
+#define LED_FADE_MS 400            // Crossfade entre os efeitos de dois estados
+#define LED_COR_PARTIDA 0x101010   // Branco fraco: ligado, ainda sem classificação
+
+// Prazos do supervisor (maior intervalo entre batidas de cada tarefa)
+#define PRAZO_FOLGA_MS 1000        // Somada aos períodos configuráveis
+#define PRAZO_MATRIZ_MS 500        // Relógio de quadros fixo (20 ms)
+
+// Grupos de animação da matriz
+#define GRUPO_NIVEL 0              // Barras de nível de água
+#define GRUPO_ESTADO 1             // Sobreposição do estado (chuva, pulso)
 
 /* === Estrutura de Dados === */
 // Estrutura para armazenar leituras dos sensores
@@ -57,214 +130,583 @@ typedef struct
 {
     uint16_t chuva;                // Valor bruto do sensor de chuva (0–4095)
     uint16_t agua;                 // Valor bruto do sensor de nível de água (0–4095)
+    uint8_t nivel_agua;            // Nível de água calibrado (0–100%)
+    uint8_t volume_chuva;          // Volume de chuva calibrado (0–100%)
+    uint16_t agua_mm;              // Nível de água em mm
+    uint16_t chuva_mmh_x10;        // Intensidade de chuva em 0,1 mm/h
+    alert_state_t estado;          // Estado classificado pela vSensorTask com a configuração ativa
 } sensor_data_t;
 
-/* === Enumeração de Estados === */
-// Estados possíveis do sistema com base nas condições de risco
+// Evento para a tarefa do publicador (amostra ou transição)
+typedef struct
+{
+    tel_tipo_t tipo;               // TEL_AMOSTRA, TEL_ESTADO ou TEL_ALARME
+    uint32_t t_ms;
+    uint16_t v[4];                 // Amostra: agua, chuva, agua_mm, chuva_mmh_x10; transições: de, para, causa
+} pub_evento_t;
+
+/* === Canais de Sensores === */
+// Ids na ordem de registro; um sensor novo é uma entrada aqui e uma linha em CANAIS
 typedef enum
 {
-    SEGURO,                        // Condição segura (baixo risco)
-    ALERTA,                        // Condição de alerta (risco moderado)
-    ENCHENTE                       // Condição de enchente (alto risco)
-} alert_state_t;
+    CANAL_CHUVA,                   // Volume de chuva (ADC0)
+    CANAL_AGUA,                    // Nível de água (ADC1)
+    CANAL_TEMPERATURA,             // Temperatura interna do RP2040 (0,1 °C)
+    CANAIS_TOTAL
+} canal_t;
+
+// Filtros entre a leitura e a classificação: um pico isolado não troca o estado
+static filtro_mediana_t mediana_chuva = FILTRO_MEDIANA(FILTRO_PADRAO_MEDIANA);
+static filtro_mediana_t mediana_agua = FILTRO_MEDIANA(FILTRO_PADRAO_MEDIANA);
+static filtro_ema_q15_t ema_chuva = FILTRO_EMA_Q15(FILTRO_PADRAO_ALFA);
+static filtro_biquad_t biquad_agua;    // Coeficientes dependem do período (vSensorTask)
+static const sensor_filtro_t FILTROS_CHUVA[] = {{filtro_mediana, &mediana_chuva}, {filtro_ema_q15, &ema_chuva}};
+static const sensor_filtro_t FILTROS_AGUA[] = {{filtro_mediana, &mediana_agua}, {filtro_biquad, &biquad_agua}};
+
+static const sensor_desc_t CANAIS[CANAIS_TOTAL] = {
+    [CANAL_CHUVA] = {.nome = "chuva", .fonte = SENSOR_ADC_INTERNO, .canal = ADC_SENSOR_CHUVA - ADC_PRIMEIRO_GPIO,
+                     .filtros = FILTROS_CHUVA, .num_filtros = 2},
+    [CANAL_AGUA] = {.nome = "agua", .fonte = SENSOR_ADC_INTERNO, .canal = ADC_SENSOR_AGUA - ADC_PRIMEIRO_GPIO,
+                    .filtros = FILTROS_AGUA, .num_filtros = 2},
+    [CANAL_TEMPERATURA] = {.nome = "temp_interna", .fonte = SENSOR_TEMPERATURA, .periodo_ms = 1000},
+};
+
+/* === Efeitos do LED RGB por Estado === */
+// Seguro: cor fixa; Alerta: respiração lenta; Enchente: pisca rápido
+static const efeito_t EFEITO_ESTADO[3] = {
+    [SEGURO] = {EFEITO_FIXO, 0, 0},
+    [ALERTA] = {EFEITO_RESPIRAR, 2000, 0},
+    [ENCHENTE] = {EFEITO_PISCAR, 250, 100},
+};
+static const efeito_t EFEITO_PARTIDA = {EFEITO_FIXO, 0, 0}; // Do reset até a primeira amostra
+
+/* === Telas do Display === */
+// Telas alternadas pelo botão A
+typedef enum
+{
+    TELA_VALORES,                  // Percentuais, status e barra (tela original)
+    TELA_TENDENCIA_1MIN,           // Tendência do último minuto (10 Hz)
+    TELA_TENDENCIA_1H,             // Tendência da última hora (1 Hz)
+    TELA_TENDENCIA_24H,            // Tendência das últimas 24 horas (1/min)
+    TELA_STATS,                    // Tempo ligado, heap e telemetria
+    TELA_CONFIG,                   // Limiares e geração da configuração ativa
+    TELA_TOTAL
+} tela_t;
 
 /* === Variáveis Globais === */
 volatile alert_state_t system_state = SEGURO; // Estado inicial do sistema (Seguro)
-QueueHandle_t xQueueSensorData;               // Fila para comunicação de dados dos sensores
+volatile tela_t tela_atual = TELA_VALORES;    // Tela exibida no display OLED
+volatile alarme_fase_t alarme_fase = ALARME_LIMPO; // Fase do alarme publicada para o buzzer e a matriz
+QueueHandle_t xQueueSensorData;               // Caixa de correio do display (amostra mais recente)
+QueueHandle_t xQueueMatriz;                   // Caixa de correio (1 item) com a última amostra para a matriz
+QueueHandle_t xQueueBuzzer;                   // Caixa de correio (1 item) com o último estado para o buzzer
+QueueHandle_t xQueueLed;                      // Caixa de correio (1 item) com o estado para o LED RGB
+QueueHandle_t xQueuePublicador;               // Eventos para o publicador MQTT (NULL se desligado)
+historico_t historico;                        // Histórico dos sensores (escrito só pela vSensorTask)
+np_t matriz;                                  // Cadeia WS2812B da placa (iniciada no main, usada pela vMatrixTask)
+npLED_t matriz_leds[ANIM_LEDS];               // Buffer GRB enviado por DMA
+bool matriz_ok;                               // Máquina PIO e canal DMA obtidos
+volatile bool display_reconfigurar = false;   // I2C destravada pelo supervisor: reenviar configuração e quadro
+
+/* === Eventos do Publicador === */
+// Entrega sem espera: com a fila cheia o evento se perde, nunca a amostragem ou o alarme
+static void publica_evento(tel_tipo_t tipo, uint32_t t_ms, uint16_t a, uint16_t b, uint16_t c, uint16_t d)
+{
+    if (xQueuePublicador == NULL)
+        return;
+    pub_evento_t e = {tipo, t_ms, {a, b, c, d}};
+    xQueueSend(xQueuePublicador, &e, 0);
+}
+
+/* === Classificação de Risco === */
+// Feita uma única vez por amostra, na vSensorTask (alerta_classificar), para todas as saídas concordarem.
+// Nomes dos estados para os logs de depuração
+static const char *const NOME_ESTADO[] = {"Seguro", "Alerta", "Enchente"};
+static const imagem_t *const IMAGEM_ESTADO[] = {&ROTULO_SEGURO, &ROTULO_ALERTA, &ROTULO_ENCHENTE};
+
+/* === Gerenciador de Alarme === */
+// A máquina (lib/alarme.c) roda inteira na tarefa de temporizadores do FreeRTOS:
+// amostras e reconhecimentos chegam por xTimerPendFunctionCall e os vencimentos
+// são callbacks de software timers, então não há disputa nem varredura.
+static alarme_t alarme;
+static TimerHandle_t temporizadores_alarme[ALARME_TEMPORIZADORES];
+
+static void alarme_parametros_cfg(alarme_param_t *p, const config_t *cfg)
+{
+    p->silencio_ms = (uint32_t)cfg->alarme_silencio_s * 1000;
+    p->limpeza_ms = (uint32_t)cfg->alarme_limpeza_s * 1000;
+    p->subida_pct = cfg->alarme_subida_pct;
+}
+
+static void alarme_temporizador(void *ctx, alarme_temp_t temp, uint32_t ms)
+{
+    if (ms == 0)
+        xTimerStop(temporizadores_alarme[temp], 0);
+    else
+        xTimerChangePeriod(temporizadores_alarme[temp], pdMS_TO_TICKS(ms), 0); // Também (re)inicia
+}
+
+static void alarme_transicao(void *ctx, alarme_fase_t de, alarme_fase_t para, alarme_causa_t causa)
+{
+    alarme_fase = para;
+    alert_state_t estado = system_state;     // Buzzer troca o padrão já, sem esperar a próxima amostra
+    xQueueOverwrite(xQueueBuzzer, &estado);
+    LOG("Alarme: %s -> %s (%s)\n", ALARME_NOME_FASE[de], ALARME_NOME_FASE[para], ALARME_NOME_CAUSA[causa]); // Log de depuração
+#if TELEMETRIA_ATIVA
+    telemetria_alarme(to_ms_since_boot(get_absolute_time()), de, para, causa);
+#endif
+    publica_evento(TEL_ALARME, to_ms_since_boot(get_absolute_time()), de, para, causa, 0);
+}
+
+static void alarme_venceu(TimerHandle_t t)
+{
+    alarme_expirou(&alarme, (alarme_temp_t)(uintptr_t)pvTimerGetTimerID(t));
+}
+
+// Eventos enviados à tarefa de temporizadores
+static void alarme_evento_amostra(void *nada, uint32_t risco_nivel)
+{
+    alarme_amostra(&alarme, (alert_state_t)(risco_nivel >> 8), (uint8_t)risco_nivel);
+}
+
+static void alarme_evento_reconhecer(void *nada, uint32_t nada2)
+{
+    alarme_reconhecer(&alarme);
+}
+
+static void alarme_evento_config(void *nada, uint32_t nada2)
+{
+    config_t cfg;
+    alarme_param_t p;
+    config_copiar(&cfg);
+    alarme_parametros_cfg(&p, &cfg);
+    alarme_parametros(&alarme, &p);
+}
+
+/* === Ações dos Botões === */
+// Chamadas pela vBotoesTask (lib/botoes.c) depois do debounce; a interrupção só marca as bordas
+static void acao_botao_a(gesto_t gesto)
+{
+    if (gesto == GESTO_CLIQUE)                // Próxima tela
+        tela_atual = (tela_atual + 1 == TELA_TOTAL) ? TELA_VALORES : (tela_t)(tela_atual + 1);
+    else if (gesto == GESTO_DUPLO)            // Tela anterior
+        tela_atual = (tela_atual == TELA_VALORES) ? (tela_t)(TELA_TOTAL - 1) : (tela_t)(tela_atual - 1);
+    else if (gesto == GESTO_LONGO)            // Volta à tela de valores
+        tela_atual = TELA_VALORES;
+}
+
+static void acao_botao_b(gesto_t gesto)
+{
+    if (gesto == GESTO_CLIQUE)                // Reconhece o alarme (silencia por alarme_silencio_s)
+        xTimerPendFunctionCall(alarme_evento_reconhecer, NULL, 0, 0);
+    else if (gesto == GESTO_LONGO)            // Só a pressão longa entra em BOOTSEL
+    {
+        LOG("Botão B mantido: entrando em modo BOOTSEL\n"); // Log de depuração
+        reset_usb_boot(0, 0);                 // Reinicia a placa em modo BOOTSEL para upload de firmware
+    }
+}
 
-/* === Manipulador de Interrupção do Botão B === */
-// Função chamada quando o botão B (BOOTSEL) é pressionado
-void gpio_irq_handler(uint gpio, uint32_t events)
+static const botao_desc_t BOTOES[] = {
+    {BOTAO_A, BOTAO_A_LONGO_MS, acao_botao_a},
+    {BOTAO_B, BOTAO_B_LONGO_MS, acao_botao_b},
+};
+
+/* === Partida === */
+// Saídas num estado conhecido logo no main(), antes das tarefas: o reset não
+// alcança a matriz nem o painel, que depois de um reinício no meio da chuva
+// ainda mostram o quadro antigo. O painel é resolvido pelo primeiro quadro
+// inteiro da vDisplayTask; o resto sai daqui em poucos microssegundos.
+static void saidas_seguras(const config_t *cfg)
 {
-    if (gpio == BOTAO_B && events & GPIO_IRQ_EDGE_FALL) // Verifica se é o botão B com borda de descida
+    gpio_init(BUZZER);                              // Calado até a vBuzzerTask assumir o PWM
+    gpio_set_dir(BUZZER, GPIO_OUT);
+    gpio_put(BUZZER, 0);
+
+    efeito_rgb_init(LED_RGB_RED, LED_RGB_GREEN, LED_RGB_BLUE, cfg->led_pwm_div); // PWM + alarme do tique
+    efeito_rgb_trocar(&EFEITO_PARTIDA, LED_COR_PARTIDA, 0);
+
+    matriz_ok = npInit(&matriz, MATRIZ_WS2812B, matriz_leds, ANIM_LEDS); // GPIO7, PIO + DMA
+    if (matriz_ok)
+    {
+        npClear(&matriz);
+        npWrite(&matriz);                           // Retorna logo; o DMA apaga a cadeia
+    }
+    else
     {
-        printf("Botão B pressionado: entrando em modo BOOTSEL\n"); // Log de depuração
-        reset_usb_boot(0, 0); // Reinicia a placa em modo BOOTSEL para upload de firmware
+        LOG("Matriz: nenhuma maquina PIO livre\n");
+        boot_marcar(BOOT_MATRIZ);                   // Sem matriz, a fase não tem o que esperar
     }
+    boot_marcar(BOOT_SEGURO);
 }
 
+// Marcas da partida pela telemetria e pelo log
+static void relata_boot(void)
+{
+    uint32_t fases_us[BOOT_FASES];
+    for (uint i = 0; i < BOOT_FASES; i++)
+    {
+        fases_us[i] = boot_fase_us((boot_fase_t)i);
+        LOG("Boot: %-11s %7lu us\n", BOOT_NOME_FASE[i], (unsigned long)fases_us[i]);
+    }
+#if TELEMETRIA_ATIVA
+    telemetria_boot(BOOT_ORCAMENTO_MS, fases_us, BOOT_FASES);
+#endif
+    uint32_t total_ms = boot_total_us() / 1000;
+    LOG("Boot: %lu ms ate as saidas (orcamento %u ms)%s\n", (unsigned long)total_ms, BOOT_ORCAMENTO_MS,
+        total_ms > BOOT_ORCAMENTO_MS ? ": ESTOURADO" : "");
+}
+
+#if TELEMETRIA_ATIVA
+// Temporizador periódico: pior ativação de cada tarefa medida pelo supervisor
+static void relata_tarefas(TimerHandle_t temporizador)
+{
+    sup_tarefa_info_t info;
+    for (int id = 0; supervisor_tarefa(id, &info); id++)
+        telemetria_tarefa(info.nome, info.exec_max_us, info.ativacoes);
+
+    sup_stats_t stats;                       // A própria verificação do supervisor
+    supervisor_stats(&stats);
+    telemetria_tarefa("Supe", stats.us_max, stats.verificacoes);
+}
+#endif
+
+#if XIP_PERFIL
+// Temporizador periódico: sonda de latência e ciclos/acertos do cache de cada estágio
+static void relata_xip(TimerHandle_t temporizador)
+{
+    perfil_xip_sonda(XIP_SONDAS);
+    for (uint i = 0; i < XIP_ESTAGIOS; i++)
+    {
+        xip_medida_t m;
+        perfil_xip_ler((xip_estagio_t)i, &m);
+        uint32_t medio = m.chamadas ? (uint32_t)(m.ciclos / m.chamadas) : 0;
+#if TELEMETRIA_ATIVA
+        telemetria_xip(i, QUENTE_NA_RAM, m.chamadas, medio, m.ciclos_max, m.acessos, m.acertos);
+#endif
+        LOG("XIP: %-9s %s %8lu x %6lu ciclos (max %lu), %lu/%lu acertos\n", XIP_NOME_ESTAGIO[i],
+            QUENTE_NA_RAM ? "ram" : "flash", (unsigned long)m.chamadas, (unsigned long)medio,
+            (unsigned long)m.ciclos_max, (unsigned long)m.acertos, (unsigned long)m.acessos);
+    }
+}
+#endif
+
 /* === Tarefa de Leitura dos Sensores === */
-// Tarefa responsável por ler os sensores de chuva e nível de água via ADC
+// Tarefa responsável por ler todos os canais registrados e publicar chuva e nível de água
 void vSensorTask(void *params)
 {
-    // Configura os pinos ADC
-    adc_gpio_init(ADC_SENSOR_AGUA);  // Inicializa GPIO27 como entrada ADC
-    adc_gpio_init(ADC_SENSOR_CHUVA); // Inicializa GPIO26 como entrada ADC
-    adc_init();                      // Inicializa o módulo ADC do RP2040
+    // Registra os canais (configura os pinos ADC e o sensor de temperatura)
+    sensores_t sensores;             // Registro de canais
+    sensores_init(&sensores);        // Inicializa o módulo ADC do RP2040
+    for (uint i = 0; i < CANAIS_TOTAL; i++)
+        sensores_registrar(&sensores, &CANAIS[i]);
+#if TELEMETRIA_ATIVA && TELEMETRIA_BRUTO_HZ > 0
+    telemetria_bruto_iniciar(TELEMETRIA_BRUTO_HZ); // ADC contínuo + DMA para streaming bruto
+#endif
 
-    sensor_data_t sensordata;        // Estrutura para armazenar leituras
+    sensores_amostra_t amostra;      // Todos os canais, um vetor por grandeza
+    memset(&amostra, 0, sizeof(amostra));
+    sensor_data_t sensordata;        // Estrutura publicada para as tarefas de saída
+    config_t cfg;                    // Cópia local da configuração
+    uint32_t cfg_geracao = 0;        // Geração da cópia local (0 força a primeira carga)
+    int sup = supervisor_registrar("Sensor", PRAZO_FOLGA_MS, NULL, NULL); // Sem recuperação: prazo vencido reinicia
+    uint32_t alarme_enviado = UINT32_MAX;   // Último risco/nível entregue ao gerenciador de alarme
+    uint32_t publicado_ms = 0;               // Última amostra entregue ao publicador
+    bool publicou = false;
+    bool boot_relatado = false;              // Relatório da partida já emitido
+    TickType_t ultimo = xTaskGetTickCount(); // Referência para período fixo
     while (true)
     {
-        // Lê sensor de nível de água (ADC0, GPIO26)
-        adc_select_input(0);         // Seleciona canal ADC0
-        sensordata.agua = adc_read(); // Lê valor bruto (0–4095)
+        supervisor_inicio(sup);
 
-        // Lê sensor de volume de chuva (ADC1, GPIO27)
-        adc_select_input(1);         // Seleciona canal ADC1
-        sensordata.chuva = adc_read(); // Lê valor bruto (0–4095)
+        // Recarrega se a configuração mudou; as divisões da calibração ficam só aqui
+        bool cfg_mudou = config_atualizar(&cfg, &cfg_geracao);
+        if (cfg_mudou)
+        {
+            sensores_calibrar(&sensores, CANAL_AGUA, cfg.cal_offset[0], cfg.cal_ganho_q12[0], cfg.cal_fundo_escala[0]);
+            sensores_calibrar(&sensores, CANAL_CHUVA, cfg.cal_offset[1], cfg.cal_ganho_q12[1], cfg.cal_fundo_escala[1]);
+            supervisor_prazo(sup, cfg.periodo_sensor_ms + PRAZO_FOLGA_MS);
+            filtro_biquad_passa_baixa(&biquad_agua, FILTRO_PADRAO_CORTE_HZ, 1000.0f / cfg.periodo_sensor_ms);
+            xTimerPendFunctionCall(alarme_evento_config, NULL, 0, 0);
+        }
 
-        // Calcula percentuais para depuração
-        uint8_t nivel_agua = (sensordata.agua * 100) / 4095;   // Converte para 0–100%
-        uint8_t volume_chuva = (sensordata.chuva * 100) / 4095; // Converte para 0–100%
+        // Lê os canais vencidos: filtros, calibração, percentual e unidade de engenharia
+        uint32_t agora_ms = to_ms_since_boot(get_absolute_time());
+        PERFIL_XIP_INICIO(perfil);
+        sensores_ler(&sensores, agora_ms, &amostra);
+        PERFIL_XIP_FIM(perfil, XIP_SENSORES);
+        sensordata.chuva = amostra.bruto[CANAL_CHUVA];
+        sensordata.agua = amostra.bruto[CANAL_AGUA];
+        sensordata.nivel_agua = amostra.pct[CANAL_AGUA];
+        sensordata.volume_chuva = amostra.pct[CANAL_CHUVA];
+        sensordata.agua_mm = amostra.eng[CANAL_AGUA];
+        sensordata.chuva_mmh_x10 = amostra.eng[CANAL_CHUVA];
 
         // Log de depuração com valores brutos e percentuais
-        printf("Sensor Chuva: %u (%d%%), Sensor Água: %u (%d%%)\n",
-               sensordata.chuva, volume_chuva, sensordata.agua, nivel_agua);
+        LOG("Sensor Chuva: %u (%d%%), Sensor Água: %u (%d%%)\n",
+               sensordata.chuva, sensordata.volume_chuva, sensordata.agua, sensordata.nivel_agua);
 
-        // Envia os dados brutos para a fila
-        xQueueSend(xQueueSensorData, &sensordata, 0); // Envia sem espera
-        vTaskDelay(pdMS_TO_TICKS(100));              // Executa a 10 Hz (100ms)
+        // Registra amostra e mudanças de estado na telemetria (não bloqueia)
+        alert_state_t estado = alerta_classificar(sensordata.nivel_agua, sensordata.volume_chuva, &cfg);
+        boot_marcar(BOOT_AMOSTRA);
+#if TELEMETRIA_ATIVA
+        telemetria_canais(agora_ms, amostra.atualizados, amostra.eng);
+        telemetria_amostra(agora_ms, sensordata.agua, sensordata.chuva, sensordata.agua_mm, sensordata.chuva_mmh_x10);
+        if (estado != system_state)
+            telemetria_estado(agora_ms, system_state, estado);
+#endif
+        // Só uma amostra por PUBLICADOR_AMOSTRA_MS vai para a fila (o lote não guarda mais que isso):
+        // a 10 Hz as amostras ocupariam a fila e as transições de estado e do alarme se perderiam
+        if (!publicou || agora_ms - publicado_ms >= PUBLICADOR_AMOSTRA_MS)
+        {
+            publica_evento(TEL_AMOSTRA, agora_ms, sensordata.agua, sensordata.chuva, sensordata.agua_mm,
+                           sensordata.chuva_mmh_x10);
+            publicado_ms = agora_ms;
+            publicou = true;
+        }
+        if (estado != system_state)
+            publica_evento(TEL_ESTADO, agora_ms, system_state, estado, 0, 0);
+        // O alarme só recebe mudanças de estado ou de nível (não bloqueia a amostragem)
+        uint32_t risco_nivel = ((uint32_t)estado << 8) | sensordata.nivel_agua;
+        if (risco_nivel != alarme_enviado &&
+            xTimerPendFunctionCall(alarme_evento_amostra, NULL, risco_nivel, 0) == pdPASS)
+            alarme_enviado = risco_nivel;
+
+        // O LED só acorda em mudanças de estado ou de configuração (cores, divisor)
+        if (estado != system_state || cfg_mudou)
+            xQueueOverwrite(xQueueLed, &estado);
+        system_state = estado;
+        sensordata.estado = estado;
+
+        // Alimenta o histórico (níveis de 1 Hz e 1/min são derivados incrementalmente)
+        historico_registrar(&historico, amostra.cal[CANAL_AGUA], amostra.cal[CANAL_CHUVA]);
+
+        // Cada saída tem sua fila: nenhuma consome a amostra de outra. As caixas de correio
+        // vêm antes do display, cujo quadro inteiro da partida ocupa a I2C por ~25 ms.
+        xQueueOverwrite(xQueueMatriz, &sensordata);   // Matriz sempre lê a mais recente
+        xQueueOverwrite(xQueueBuzzer, &estado);       // Buzzer toca o padrão da mais recente
+        xQueueOverwrite(xQueueSensorData, &sensordata); // Display mostra a mais recente
+        supervisor_fim(sup);
+        supervisor_batida(sup);
+
+        // Relatório da partida, uma vez, quando a última saída mostrar a primeira amostra
+        if (!boot_relatado && boot_concluido())
+        {
+            boot_relatado = true;
+            relata_boot();
+        }
+        vTaskDelayUntil(&ultimo, pdMS_TO_TICKS(cfg.periodo_sensor_ms)); // 10 Hz por padrão, sem deriva
     }
 }
 
+/* === Telas do Display OLED === */
+// Widgets retidos de cada tela (lib/compositor.h): um valor novo só marca o widget,
+// e só o que mudou em relação ao painel vai pela I2C
+
+// Tela de valores (percentuais, status e barra)
+enum { V_BORDA, V_BORDA_ENCHENTE, V_BORDA_CHUVA, V_AGUA, V_CHUVA, V_STATUS, V_BARRA, V_TOTAL };
+static widget_t widgets_valores[V_TOTAL] = {
+    [V_BORDA] = WIDGET_BORDA_EM(0, 0, 128, 64, true),             // Borda externa
+    [V_BORDA_ENCHENTE] = WIDGET_BORDA_EM(1, 1, 126, 62, false),   // Borda dupla na enchente
+    [V_BORDA_CHUVA] = WIDGET_BORDA_EM(10, 28, 105, 12, false),    // Destaque do status
+    [V_AGUA] = WIDGET_VALOR_EM(25, 4, 96, "Agua: ", "%"),
+    [V_CHUVA] = WIDGET_VALOR_EM(25, 15, 96, "Chuva: ", "%"),
+    [V_STATUS] = WIDGET_IMAGEM_EM(35, 30, 64, &ROTULO_SEGURO),
+    [V_BARRA] = WIDGET_BARRA_EM(15, 48, 100, 8, 100),             // Nível de água (0–100%)
+};
+
+// Telas de tendência, uma por nível do histórico
+static sparkline_t sparklines[HIST_NIVEIS][HIST_CANAIS];
+#define WIDGETS_TENDENCIA(nivel, rotulo_agua, rotulo_chuva) {                  \
+        WIDGET_ROTULO_EM(0, 0, 128, rotulo_agua),                             \
+        WIDGET_SPARKLINE_DE(&sparklines[nivel][HIST_AGUA], &historico),       \
+        WIDGET_ROTULO_EM(0, 32, 128, rotulo_chuva),                           \
+        WIDGET_SPARKLINE_DE(&sparklines[nivel][HIST_CHUVA], &historico)}
+enum { T_TOTAL = 4 };
+static widget_t widgets_tendencia[HIST_NIVEIS][T_TOTAL] = {
+    [HIST_10HZ] = WIDGETS_TENDENCIA(HIST_10HZ, "Agua  1 min", "Chuva 1 min"),
+    [HIST_1HZ] = WIDGETS_TENDENCIA(HIST_1HZ, "Agua  1 h", "Chuva 1 h"),
+    [HIST_1MIN] = WIDGETS_TENDENCIA(HIST_1MIN, "Agua  24 h", "Chuva 24 h"),
+};
+
+// Tela de estatísticas
+enum { S_TITULO, S_LIGADO, S_HEAP, S_PERDIDOS, S_QUADROS, S_SUPERVISOR, S_DESENHO, S_PILHA, S_TOTAL };
+static widget_t widgets_stats[S_TOTAL] = {                      // Linhas alinhadas às páginas
+    [S_TITULO] = WIDGET_ROTULO_EM(0, 0, 128, "Estatisticas"),
+    [S_LIGADO] = WIDGET_VALOR_EM(0, 8, 120, "Ligado: ", "s"),
+    [S_HEAP] = WIDGET_VALOR_EM(0, 16, 120, "Heap: ", ""),
+    [S_PERDIDOS] = WIDGET_VALOR_EM(0, 24, 120, "Perdidos: ", ""), // Registros da telemetria
+    [S_QUADROS] = WIDGET_VALOR_EM(0, 32, 120, "Quadros: ", ""),
+    [S_SUPERVISOR] = WIDGET_VALOR_EM(0, 40, 120, "Superv: ", " us"), // Pior verificação
+    [S_DESENHO] = WIDGET_VALOR_EM(0, 48, 120, "Desenho: ", " us"), // Pior redesenho do OLED
+    [S_PILHA] = WIDGET_VALOR_EM(0, 56, 120, "Pilha: ", ""),        // Palavras livres da vDisplayTask
+};
+
+// Tela da configuração ativa
+enum { C_TITULO, C_AGUA_ALERTA, C_AGUA_ENCHENTE, C_CHUVA_ALERTA, C_CHUVA_ENCHENTE, C_GERACAO, C_TOTAL };
+static widget_t widgets_config[C_TOTAL] = {
+    [C_TITULO] = WIDGET_ROTULO_EM(0, 0, 128, "Configuracao"),
+    [C_AGUA_ALERTA] = WIDGET_VALOR_EM(0, 12, 120, "Agua ale: ", "%"),
+    [C_AGUA_ENCHENTE] = WIDGET_VALOR_EM(0, 22, 120, "Agua enc: ", "%"),
+    [C_CHUVA_ALERTA] = WIDGET_VALOR_EM(0, 32, 120, "Chuva ale: ", "%"),
+    [C_CHUVA_ENCHENTE] = WIDGET_VALOR_EM(0, 42, 120, "Chuva enc: ", "%"),
+    [C_GERACAO] = WIDGET_VALOR_EM(0, 52, 120, "Geracao: ", ""),
+};
+
+// Páginas na ordem do botão A
+static const pagina_t PAGINAS[TELA_TOTAL] = {
+    [TELA_VALORES] = {widgets_valores, V_TOTAL},
+    [TELA_TENDENCIA_1MIN] = {widgets_tendencia[HIST_10HZ], T_TOTAL},
+    [TELA_TENDENCIA_1H] = {widgets_tendencia[HIST_1HZ], T_TOTAL},
+    [TELA_TENDENCIA_24H] = {widgets_tendencia[HIST_1MIN], T_TOTAL},
+    [TELA_STATS] = {widgets_stats, S_TOTAL},
+    [TELA_CONFIG] = {widgets_config, C_TOTAL},
+};
+
+// Atualiza os valores retidos de todas as telas; só a tela exibida é redesenhada
+static void atualiza_widgets(const sensor_data_t *sensordata, const config_t *cfg, uint32_t geracao)
+{
+    widget_valor(&widgets_valores[V_AGUA], sensordata->nivel_agua);
+    widget_valor(&widgets_valores[V_CHUVA], sensordata->volume_chuva);
+    widget_imagem(&widgets_valores[V_STATUS], IMAGEM_ESTADO[sensordata->estado]);
+    widget_valor(&widgets_valores[V_BARRA], sensordata->nivel_agua);
+    widget_visivel(&widgets_valores[V_BORDA_ENCHENTE], sensordata->estado == ENCHENTE);
+    widget_visivel(&widgets_valores[V_BORDA_CHUVA], sensordata->estado != SEGURO);
+
+    tel_stats_t tel;
+    telemetria_stats(&tel);
+    widget_valor(&widgets_stats[S_LIGADO], to_ms_since_boot(get_absolute_time()) / 1000);
+    widget_valor(&widgets_stats[S_HEAP], xPortGetFreeHeapSize());
+    widget_valor(&widgets_stats[S_PERDIDOS], tel.descartados);
+    widget_valor(&widgets_stats[S_QUADROS], tel.quadros);
+    sup_stats_t sup;
+    supervisor_stats(&sup);
+    widget_valor(&widgets_stats[S_SUPERVISOR], sup.us_max);
+
+    widget_valor(&widgets_config[C_AGUA_ALERTA], cfg->agua_alerta);
+    widget_valor(&widgets_config[C_AGUA_ENCHENTE], cfg->agua_enchente);
+    widget_valor(&widgets_config[C_CHUVA_ALERTA], cfg->chuva_alerta);
+    widget_valor(&widgets_config[C_CHUVA_ENCHENTE], cfg->chuva_enchente);
+    widget_valor(&widgets_config[C_GERACAO], geracao);
+}
+
 /* === Tarefa do Display OLED === */
+// Recuperação do display, chamada pela vSupervisorTask quando o prazo vence:
+// destrava a I2C e pede à tarefa que reconfigure o painel
+static void recupera_display(void *ctx)
+{
+    supervisor_destravar_i2c(I2C_PORT, I2C_SDA, I2C_SCL, I2C_FREQ);
+    display_reconfigurar = true;
+}
+
 // Tarefa responsável por exibir informações no display OLED SSD1306
 void vDisplayTask(void *params)
 {
     // Inicializa a comunicação I2C
-    i2c_init(I2C_PORT, 400 * 1000); // Configura I2C a 400 kHz
+    i2c_init(I2C_PORT, I2C_FREQ);   // Configura I2C a 400 kHz
     gpio_set_function(I2C_SDA, GPIO_FUNC_I2C); // Define GPIO14 como SDA
     gpio_set_function(I2C_SCL, GPIO_FUNC_I2C); // Define GPIO15 como SCL
     gpio_pull_up(I2C_SDA);                    // Ativa pull-up interno
     gpio_pull_up(I2C_SCL);                    // Ativa pull-up interno
 
-    // Inicializa o display OLED
-    ssd1306_t ssd;                            // Estrutura de controle do display
-    ssd1306_init(&ssd, 128, 64, false, ENDERECO_OLED, I2C_PORT); // Inicializa: 128x64, sem VCC externo
+    // Inicializa o display OLED: só a configuração, numa transação. O painel não é
+    // limpo à parte; o primeiro quadro com a amostra já vai inteiro (compositor_init).
+    static ssd1306_t ssd;                     // Estrutura de controle do display (buffer de 1 kB: fora da pilha)
+    ssd1306_init(&ssd, false, ENDERECO_OLED, I2C_PORT); // Inicializa: geometria de ssd1306.h, sem VCC externo
     ssd1306_config(&ssd);                     // Configura parâmetros do display
-    ssd1306_fill(&ssd, false);                // Limpa o buffer do display
-    ssd1306_send_data(&ssd);                  // Atualiza o display (limpo)
+
+    static compositor_t comp;                  // Widgets + sombra do que está no painel (1 kB: fora da pilha)
+    compositor_init(&comp, &ssd);
+    for (uint n = 0; n < HIST_NIVEIS; n++)
+    {
+        sparkline_init(&sparklines[n][HIST_AGUA], 0, 1, 128, 3, n, HIST_AGUA);   // Páginas 1–3
+        sparkline_init(&sparklines[n][HIST_CHUVA], 0, 5, 128, 3, n, HIST_CHUVA); // Páginas 5–7
+    }
 
     sensor_data_t sensordata;                  // Estrutura para receber dados
-    char buffer[32];                          // Buffer para formatar strings
-    const char *status;                       // Ponteiro para string de status
+    tela_t tela_anterior = TELA_TOTAL;         // Força a troca de página na primeira vez
+    config_t cfg;                              // Cópia local da configuração
+    uint32_t cfg_geracao = 0;
+    int sup = -1;                              // Supervisionada a partir do primeiro quadro entregue
+    uint32_t desenho_max_us = 0;               // Pior redesenho (estatísticas)
     while (true)
     {
-        // Recebe dados da fila (bloqueia até receber)
-        if (xQueueReceive(xQueueSensorData, &sensordata, portMAX_DELAY) == pdTRUE)
+        if (config_atualizar(&cfg, &cfg_geracao))
+            supervisor_prazo(sup, cfg.periodo_sensor_ms + cfg.periodo_display_ms + PRAZO_FOLGA_MS);
+
+        // Após falha ou recuperação da I2C o conteúdo do painel é incerto: reconfigura e reenvia tudo
+        if (display_reconfigurar)
         {
-            // Converte valores brutos para percentuais
-            uint8_t nivel_agua = (sensordata.agua * 100) / 4095;   // Nível de água (0–100%)
-            uint8_t volume_chuva = (sensordata.chuva * 100) / 4095; // Volume de chuva (0–100%)
+            display_reconfigurar = false;
+            ssd1306_config(&ssd);
+            compositor_invalidar(&comp);       // Próximo quadro vai inteiro
+        }
 
-            // Limpa o buffer do display
-            ssd1306_fill(&ssd, false);
+        // Amostra mais recente (bloqueia até chegar uma nova); as que chegaram durante
+        // o quadro e a espera abaixo foram sobrescritas, não enfileiradas
+        if (xQueueReceive(xQueueSensorData, &sensordata, portMAX_DELAY) == pdTRUE)
+        {
+            supervisor_inicio(sup);
+            atualiza_widgets(&sensordata, &cfg, cfg_geracao);
 
-            // Determina o estado do sistema e desenha elementos gráficos
-            if (nivel_agua >= 70 || volume_chuva >= 80) // Condição de enchente
+            tela_t tela = tela_atual;          // Copia a tela escolhida pelo botão A
+            if (tela != tela_anterior)
             {
-                status = "Enchente";                   // Define status como "Enchente"
-                ssd1306_rect(&ssd, 1, 1, 126, 62, true, false); // Borda externa
-                ssd1306_rect(&ssd, 28, 10, 105, 12, true, false); // Borda para "Chuva"
+                compositor_pagina(&comp, &PAGINAS[tela]);
+                tela_anterior = tela;
             }
-            else if (nivel_agua >= 50 || volume_chuva >= 50) // Condição de alerta
-            {
-                status = "Alerta";                     // Define status como "Alerta"
-                ssd1306_rect(&ssd, 28, 10, 105, 12, true, false); // Borda para "Chuva"
-            }
-            else // Condição segura
-            {
-                status = "Seguro";                     // Define status como "Seguro"
-            }
-
-            // Desenha borda externa do display
-            ssd1306_rect(&ssd, 0, 0, 128, 64, true, false);
-
-            // Exibe "Água: X%" no display
-            snprintf(buffer, sizeof(buffer), "Agua: %d%%", nivel_agua); // Formata string
-            ssd1306_draw_string(&ssd, buffer, 25, 4);                  // Desenha na posição (25,4)
-
-            // Exibe "Chuva: Y%" no display
-            snprintf(buffer, sizeof(buffer), "Chuva: %d%%", volume_chuva); // Formata string
-            ssd1306_draw_string(&ssd, buffer, 25, 15);                   // Desenha na posição (25,15)
-
-            // Exibe status do sistema
-            snprintf(buffer, sizeof(buffer), "%s", status); // Formata string
-            ssd1306_draw_string(&ssd, buffer, 35, 30);     // Desenha na posição (35,30)
-
-            // Desenha barra gráfica para nível de água
-            uint8_t barra_largura = nivel_agua; // Escala 0–100% para 0–100 pixels
-            ssd1306_rect(&ssd, 48, 15, barra_largura, 8, true, true); // Barra preenchida
-            ssd1306_rect(&ssd, 48, 15, 100, 8, true, false);          // Borda da barra
+            uint16_t falhas = ssd.falhas;
+            PERFIL_XIP_INICIO(perfil);
+            compositor_atualizar(&comp);       // Redesenha os sujos e envia só as diferenças
+            PERFIL_XIP_FIM(perfil, XIP_DISPLAY);
+            boot_marcar(BOOT_DISPLAY);
+            if (comp.desenho_us > desenho_max_us)
+                desenho_max_us = comp.desenho_us;
+            widget_valor(&widgets_stats[S_DESENHO], desenho_max_us); // Aparecem no próximo quadro
+            widget_valor(&widgets_stats[S_PILHA], uxTaskGetStackHighWaterMark(NULL));
+            supervisor_fim(sup);               // Antes do registro: o primeiro quadro não tem início
 
-            // Atualiza o display com o conteúdo do buffer
-            ssd1306_send_data(&ssd);
+            // Só conta como batida o quadro que chegou ao painel. Sem painel no boot a
+            // tarefa não é supervisionada, para um display ausente não reiniciar a placa.
+            if (ssd.falhas != falhas)
+                display_reconfigurar = true;
+            else if (sup < 0)
+                sup = supervisor_registrar("Display", cfg.periodo_sensor_ms + cfg.periodo_display_ms + PRAZO_FOLGA_MS,
+                                           recupera_display, NULL);
+            else
+                supervisor_batida(sup);
         }
-        vTaskDelay(pdMS_TO_TICKS(100)); // Atualiza a 10 Hz (100ms)
+        vTaskDelay(pdMS_TO_TICKS(cfg.periodo_display_ms)); // Atualiza a 10 Hz por padrão
     }
 }
 
 /* === Tarefa do LED RGB === */
-// Tarefa responsável por controlar as cores do LED RGB com base no estado do sistema
+// Tarefa responsável por escolher o efeito do LED RGB para o estado do sistema.
+// Os fades, a respiração e o pisca rodam na interrupção de tique (lib/efeito_rgb.c);
+// a tarefa só acorda quando a vSensorTask avisa mudança de estado ou de configuração.
 void vLedRgbTask(void *params)
 {
-    // Configura os pinos como PWM
-    gpio_set_function(LED_RGB_RED, GPIO_FUNC_PWM);   // GPIO13 para PWM
-    gpio_set_function(LED_RGB_GREEN, GPIO_FUNC_PWM); // GPIO11 para PWM
-    gpio_set_function(LED_RGB_BLUE, GPIO_FUNC_PWM);  // GPIO12 para PWM
-
-    // Obtém os slices PWM correspondentes aos pinos
-    uint slice_red = pwm_gpio_to_slice_num(LED_RGB_RED);     // Slice para vermelho
-    uint slice_green = pwm_gpio_to_slice_num(LED_RGB_GREEN); // Slice para verde
-    uint slice_blue = pwm_gpio_to_slice_num(LED_RGB_BLUE);   // Slice para azul
-
-    // Configura PWM: ~1 kHz, resolução de 8 bits
-    pwm_set_clkdiv(slice_red, 100.0f);   // Divisor de clock para ~4.88 kHz, ajustado
-    pwm_set_clkdiv(slice_green, 100.0f);
-    pwm_set_clkdiv(slice_blue, 100.0f);
-    pwm_set_wrap(slice_red, 255);        // Resolução de 0–255
-    pwm_set_wrap(slice_green, 255);
-    pwm_set_wrap(slice_blue, 255);
-
-    // Obtém os canais PWM (A ou B) para cada pino
-    uint chan_red = pwm_gpio_to_channel(LED_RGB_RED);     // Canal para vermelho
-    uint chan_green = pwm_gpio_to_channel(LED_RGB_GREEN); // Canal para verde
-    uint chan_blue = pwm_gpio_to_channel(LED_RGB_BLUE);   // Canal para azul
-
-    // Inicializa com duty cycle 0 (LED desligado)
-    pwm_set_chan_level(slice_red, chan_red, 0);
-    pwm_set_chan_level(slice_green, chan_green, 0);
-    pwm_set_chan_level(slice_blue, chan_blue, 0);
-
-    // Habilita os slices PWM
-    pwm_set_enabled(slice_red, true);
-    pwm_set_enabled(slice_green, true);
-    pwm_set_enabled(slice_blue, true);
-
-    sensor_data_t sensordata; // Estrutura para receber dados
+    config_t cfg;                                 // Cópia local da configuração
+    uint32_t cfg_geracao = 0;
+    config_atualizar(&cfg, &cfg_geracao);         // PWM já iniciado no aviso de partida (saidas_seguras)
+
+    alert_state_t estado;                         // A primeira amostra sempre chega (configuração carregada)
+    int sup = supervisor_registrar("LED", 0, NULL, NULL); // Só medição: sem mudança de estado não há batida
     while (true)
     {
-        // Recebe dados da fila (bloqueia até receber)
-        if (xQueueReceive(xQueueSensorData, &sensordata, portMAX_DELAY) == pdTRUE)
-        {
-            // Converte valores brutos para percentuais
-            uint8_t nivel_agua = (sensordata.agua * 100) / 4095;   // Nível de água
-            uint8_t volume_chuva = (sensordata.chuva * 100) / 4095; // Volume de chuva
+        // Bloqueia até a próxima mudança (sem período fixo)
+        if (xQueueReceive(xQueueLed, &estado, portMAX_DELAY) != pdTRUE)
+            continue;
+        supervisor_inicio(sup);
 
-            // Define a cor do LED RGB com base no estado
-            if (nivel_agua >= 70 || volume_chuva >= 80) // Condição de enchente
-            {
-                pwm_set_chan_level(slice_red, chan_red, 255);     // Vermelho: 100%
-                pwm_set_chan_level(slice_green, chan_green, 0); // Verde: 0%
-                pwm_set_chan_level(slice_blue, chan_blue, 0);   // Azul: 0%
-                printf("vLedRgbTask: Vermelho (Enchente)\n");   // Log de depuração
-            }
-            else if (nivel_agua >= 50 || volume_chuva >= 50) // Condição de alerta
-            {
-                pwm_set_chan_level(slice_red, chan_red, 255);     // Vermelho: 100%
-                pwm_set_chan_level(slice_green, chan_green, 255); // Verde: 100%
-                pwm_set_chan_level(slice_blue, chan_blue, 0);   // Azul: 0% (amarelo)
-                printf("vLedRgbTask: Amarelo (Alerta)\n");      // Log de depuração
-            }
-            else // Condição segura
-            {
-                pwm_set_chan_level(slice_red, chan_red, 0);     // Vermelho: 0%
-                pwm_set_chan_level(slice_green, chan_green, 255); // Verde: 100%
-                pwm_set_chan_level(slice_blue, chan_blue, 0);   // Azul: 0%
-                printf("vLedRgbTask: Verde (Seguro)\n");        // Log de depuração
-            }
-        }
-        vTaskDelay(pdMS_TO_TICKS(100)); // Atualiza a 10 Hz (100ms)
+        // Reaplica o divisor do PWM se a configuração mudou
+        if (config_atualizar(&cfg, &cfg_geracao))
+            efeito_rgb_divisor(cfg.led_pwm_div);
+
+        // Efeito do estado na cor 0xRRGGBB configurada, com crossfade a partir da cor atual
+        efeito_rgb_trocar(&EFEITO_ESTADO[estado], cfg.led_cor[estado], LED_FADE_MS);
+        boot_marcar(BOOT_LED);
+        supervisor_fim(sup);
+        LOG("vLedRgbTask: cor 0x%06lX (%s)\n", (unsigned long)cfg.led_cor[estado], NOME_ESTADO[estado]); // Log de depuração
     }
 }
 
@@ -277,97 +719,373 @@ void vBuzzerTask(void *params)
     uint slice = pwm_gpio_to_slice_num(BUZZER); // Obtém slice PWM
     uint chan = pwm_gpio_to_channel(BUZZER);   // Obtém canal PWM
 
-    // Configura PWM para 500 Hz com duty cycle de 50%
+    // Configura PWM com a frequência da configuração (500 Hz por padrão) e duty cycle de 50%
     uint clock = 125000000;             // Clock do RP2040 (125 MHz)
-    uint divider = 4;                   // Divisor de clock
-    uint top = clock / (divider * 500); // Calcula TOP para 500 Hz
-    pwm_set_clkdiv(slice, divider);     // Aplica divisor
-    pwm_set_wrap(slice, top);           // Define resolução
-    pwm_set_chan_level(slice, chan, top / 2); // Duty cycle 50%
     pwm_set_enabled(slice, false);       // Inicia com PWM desligado
 
-    sensor_data_t sensordata;            // Estrutura para receber dados
+    config_t cfg;                        // Cópia local da configuração
+    uint32_t cfg_geracao = 0;
+    alert_state_t estado;                // Último estado recebido
+    uint16_t on_ms = 0, off_ms = 0;      // Padrão em curso (on = 0: calado)
+    bool ligado = false;                 // Fase atual do padrão
+    TickType_t fim_fase = 0;             // Fim da fase atual (só com on > 0)
+    int sup = supervisor_registrar("Buzzer", PRAZO_FOLGA_MS, NULL, NULL);
     while (true)
     {
-        // Recebe dados da fila (bloqueia até receber)
-        if (xQueueReceive(xQueueSensorData, &sensordata, portMAX_DELAY) == pdTRUE)
+        // Recalcula TOP apenas quando a configuração muda
+        if (config_atualizar(&cfg, &cfg_geracao))
         {
-            // Converte valores brutos para percentuais
-            uint8_t nivel_agua = (sensordata.agua * 100) / 4095;   // Nível de água
-            uint8_t volume_chuva = (sensordata.chuva * 100) / 4095; // Volume de chuva
+            // Divisor 4, ou o menor que mantém o TOP nos 16 bits do wrap (abaixo de ~477 Hz)
+            uint divider = clock / (65536u * cfg.buzzer_hz) + 1;
+            if (divider < 4)
+                divider = 4;
+            pwm_set_clkdiv(slice, divider);               // Aplica divisor
+            uint top = clock / (divider * cfg.buzzer_hz); // TOP para a frequência configurada
+            pwm_set_wrap(slice, top);                     // Define resolução
+            pwm_set_chan_level(slice, chan, top / 2);     // Duty cycle 50%
+            supervisor_prazo(sup, cfg.periodo_sensor_ms + PRAZO_FOLGA_MS); // Uma batida por amostra
+        }
 
-            // Controla o buzzer com base no estado
-            if (nivel_agua >= 70 || volume_chuva >= 80) // Condição de enchente
-            {
-                // Beeps rápidos: 200ms ligado, 200ms desligado
-                pwm_set_enabled(slice, true);           // Liga o buzzer
-                printf("vBuzzerTask: Beep rápido (Enchente)\n"); // Log de depuração
-                vTaskDelay(pdMS_TO_TICKS(200));        // Espera 200ms
-                pwm_set_enabled(slice, false);          // Desliga o buzzer
-                vTaskDelay(pdMS_TO_TICKS(200));        // Espera 200ms
-            }
-            else if (nivel_agua >= 50 || volume_chuva >= 50) // Condição de alerta
-            {
-                // Beeps curtos: 500ms ligado, 500ms desligado
-                pwm_set_enabled(slice, true);           // Liga o buzzer
-                printf("vBuzzerTask: Beep curto (Alerta)\n"); // Log de depuração
-                vTaskDelay(pdMS_TO_TICKS(500));        // Espera 500ms
-                pwm_set_enabled(slice, false);          // Desliga o buzzer
-                vTaskDelay(pdMS_TO_TICKS(500));        // Espera 500ms
-            }
-            else // Condição segura
-            {
-                pwm_set_enabled(slice, false);          // Mantém buzzer desligado
-                printf("vBuzzerTask: Silêncio (Seguro)\n"); // Log de depuração
-                vTaskDelay(pdMS_TO_TICKS(100));        // Mantém sincronia a 10 Hz
-            }
+        // O padrão não bloqueia: espera a próxima amostra (ou mudança do alarme) só até o
+        // fim da fase atual, e uma mudança chega ao PWM sem esperar o padrão terminar
+        TickType_t espera = portMAX_DELAY;
+        if (on_ms > 0)
+        {
+            TickType_t agora = xTaskGetTickCount();
+            espera = (int32_t)(fim_fase - agora) > 0 ? fim_fase - agora : 0;
+        }
+        if (xQueueReceive(xQueueBuzzer, &estado, espera) != pdTRUE)
+        {
+            ligado = !ligado || off_ms == 0;             // Fim da fase: alterna (off = 0 toca contínuo)
+            pwm_set_enabled(slice, ligado);
+            fim_fase += pdMS_TO_TICKS(ligado ? on_ms : off_ms);
+            continue;
+        }
+
+        supervisor_inicio(sup);
+        // Padrão liga/desliga do estado (Seguro: silêncio; Alerta: 500/500; Enchente: 200/200),
+        // calado enquanto reconhecido e mais insistente se escalado
+        uint16_t novo_on = cfg.buzzer_on_ms[estado];
+        uint16_t novo_off = cfg.buzzer_off_ms[estado];
+        alarme_fase_t fase = alarme_fase;
+        if (alarme_silenciado(fase))
+            novo_on = 0;
+        else if (fase == ALARME_ESCALADO)
+        {
+            novo_on = cfg.buzzer_escalado_on_ms;
+            novo_off = cfg.buzzer_escalado_off_ms;
+        }
+
+        // Padrão novo começa já ligado; o mesmo padrão segue a fase em curso
+        if (novo_on != on_ms || novo_off != off_ms)
+        {
+            on_ms = novo_on;
+            off_ms = novo_off;
+            ligado = on_ms > 0;
+            pwm_set_enabled(slice, ligado);              // Liga o buzzer (ou cala)
+            fim_fase = xTaskGetTickCount() + pdMS_TO_TICKS(on_ms);
+            LOG("vBuzzerTask: %u/%u ms (%s)\n", on_ms, off_ms, NOME_ESTADO[estado]); // Log de depuração
         }
+        boot_marcar(BOOT_BUZZER);
+        supervisor_fim(sup);
+        supervisor_batida(sup);
     }
 }
 
 /* === Tarefa da Matriz WS2812B === */
-// Tarefa responsável por controlar as animações na matriz WS2812B 5x5
+// Recuperação da matriz, chamada pela vSupervisorTask: FIFO da PIO parado prende o npWait()
+static void recupera_matriz(void *ctx)
+{
+    npReiniciar((np_t *)ctx);
+}
+
+// Tarefa responsável por controlar as animações na matriz WS2812B 5x5.
+// Roda em um relógio de quadros fixo; novas amostras só trocam as linhas do tempo.
 void vMatrixTask(void *params)
 {
-    npInit(MATRIZ_WS2812B);                       // Inicializa a matriz (GPIO7, PIO)
-    srand(to_ms_since_boot(get_absolute_time())); // Inicializa semente para números aleatórios
     sensor_data_t sensordata;                     // Estrutura para receber dados
+    config_t cfg;                                 // Cópia local da configuração
+    uint32_t cfg_geracao = 0;
+    config_atualizar(&cfg, &cfg_geracao);
+
+    animador_t anim;                              // Motor de animação (camadas + crossfade)
+    animador_init(&anim, cfg.matriz_brilho);
+    uint8_t quadro[ANIM_LEDS][3];                 // Quadro composto na ordem da cadeia
+    int8_t faixa_atual = -1;                      // Faixa de nível exibida (-1 = nenhuma)
+    const anim_linha_t *sobreposicao = NULL;      // Linha do grupo de estado em exibição
+    bool sobreposicao_iniciada = false;
+    bool mostrou_amostra = false;                 // Primeiro quadro com amostra (marca da partida)
+
+    int sup = supervisor_registrar("Matriz", PRAZO_MATRIZ_MS, recupera_matriz, &matriz);
+    TickType_t ultimo = xTaskGetTickCount();
     while (true)
     {
-        // Recebe dados da fila (bloqueia até receber)
-        if (xQueueReceive(xQueueSensorData, &sensordata, portMAX_DELAY) == pdTRUE)
+        supervisor_inicio(sup);
+        if (config_atualizar(&cfg, &cfg_geracao)) // Brilho pode mudar em campo
+            anim.brilho = cfg.matriz_brilho;
+
+        // Consulta a última amostra sem bloquear o relógio de quadros
+        if (xQueueReceive(xQueueMatriz, &sensordata, 0) == pdTRUE)
+        {
+            uint8_t faixa = anim_faixa_nivel(sensordata.nivel_agua);
+            if (faixa != faixa_atual)
+            {
+                animador_trocar(&anim, GRUPO_NIVEL, &LINHA_NIVEL[faixa], MATRIZ_FADE_NIVEL_MS);
+                faixa_atual = faixa;
+            }
+
+            // Sobreposição do estado: some enquanto o alarme está reconhecido e vira o pulso se escalar
+            const anim_linha_t *linha = LINHA_ESTADO[sensordata.estado];
+            alarme_fase_t fase = alarme_fase;
+            if (alarme_silenciado(fase))
+                linha = NULL;
+            else if (fase == ALARME_ESCALADO)
+                linha = LINHA_ESTADO[ENCHENTE];
+            if (linha != sobreposicao || !sobreposicao_iniciada)
+            {
+                animador_trocar(&anim, GRUPO_ESTADO, linha, MATRIZ_FADE_ESTADO_MS);
+                sobreposicao = linha;
+                sobreposicao_iniciada = true;
+            }
+        }
+
+        // Compõe e envia o quadro. Acima da vSensorTask, a tarefa nunca espera o DMA:
+        // se o quadro anterior ainda estiver na linha, este é pulado (o animador avança igual)
+        PERFIL_XIP_INICIO(perfil);
+        animador_quadro(&anim, MATRIZ_QUADRO_MS, quadro);
+        if (!npOcupado(&matriz))
         {
-            // Converte valores brutos para percentuais (usado apenas para depuração)
-            uint8_t nivel_agua = (sensordata.agua * 100) / 4095;   // Nível de água
-            uint8_t volume_chuva = (sensordata.chuva * 100) / 4095; // Volume de chuva
+            for (uint i = 0; i < ANIM_LEDS; i++)
+                npSetLED(&matriz, i, quadro[i][0], quadro[i][1], quadro[i][2]);
+            npWrite(&matriz);                     // Retorna logo; o DMA alimenta a PIO
+        }
+        PERFIL_XIP_FIM(perfil, XIP_MATRIZ);
+        if (sobreposicao_iniciada && !mostrou_amostra)
+        {
+            boot_marcar(BOOT_MATRIZ);
+            mostrou_amostra = true;
+        }
+        supervisor_fim(sup);
+        supervisor_batida(sup);
+
+        vTaskDelayUntil(&ultimo, pdMS_TO_TICKS(MATRIZ_QUADRO_MS));
+    }
+}
 
-            // Executa animação de enchente com base no nível de água
-            anim_enchente(sensordata.agua); // Passa valor bruto para a função
+#if PUBLICADOR_ATIVO
+/* === Tarefa do Publicador MQTT === */
+// Rede e fila de lotes (lib/publicador.c) ficam só nesta tarefa, na menor
+// prioridade. Enquanto o Wi-Fi ou o broker estiverem fora, os lotes ficam na
+// RAM e saem em ritmo limitado quando a conexão volta.
+static publicador_t publicador;          // Fila de lotes (~8 kB): fora da pilha
+static mqtt_picow_t mqtt;
+static pub_transporte_t transporte;
+
+void vPublicadorTask(void *params)
+{
+    char estacao[2 * PICO_UNIQUE_BOARD_ID_SIZE_BYTES + 1];
+    pico_get_unique_board_id_string(estacao, sizeof(estacao));
+    if (!mqtt_picow_init(&mqtt, WIFI_SSID, WIFI_SENHA, MQTT_BROKER, MQTT_PORTA, estacao))
+    {
+        LOG("Publicador: CYW43 nao iniciou\n"); // Log de depuração
+        xQueuePublicador = NULL;                // Produtores param de enviar
+        vTaskDelete(NULL);
+    }
+    mqtt_picow_transporte(&mqtt, &transporte);
+    publicador_init(&publicador, &transporte, estacao, (uint16_t)get_rand_32());
+
+    int sup = supervisor_registrar("Publicador", PRAZO_PUBLICADOR_MS, NULL, NULL);
+    pub_evento_t e;
+    while (true)
+    {
+        // Espera o primeiro evento por até uma volta e esvazia o resto sem espera
+        TickType_t espera = pdMS_TO_TICKS(PUBLICADOR_SERVIR_MS);
+        while (xQueueReceive(xQueuePublicador, &e, espera) == pdTRUE)
+        {
+            if (espera)
+                supervisor_inicio(sup);        // Ativação começa no primeiro evento
+            espera = 0;
+            if (e.tipo == TEL_AMOSTRA)
+                publicador_amostra(&publicador, e.t_ms, e.v[0], e.v[1], e.v[2], e.v[3]);
+            else if (e.tipo == TEL_ESTADO)
+                publicador_estado(&publicador, e.t_ms, (uint8_t)e.v[0], (uint8_t)e.v[1]);
+            else
+                publicador_alarme(&publicador, e.t_ms, (uint8_t)e.v[0], (uint8_t)e.v[1], (uint8_t)e.v[2]);
         }
+        if (espera)
+            supervisor_inicio(sup);            // ...ou na volta da rede sem eventos
+        publicador_servir(&publicador, to_ms_since_boot(get_absolute_time()));
+        supervisor_fim(sup);
+        supervisor_batida(sup);
     }
 }
+#endif
+
+#if FILTROS_MEDIR
+/* === Bancada dos Filtros === */
+// Mesma bancada de sim/filtros.c, com o relógio de 1 us; antes do escalonador, sem preempção
+#define BANCADA_AMOSTRAS 20000                // ~0,1 % de resolução com 1 us
+
+static uint32_t relogio_us(void)
+{
+    return time_us_32();
+}
+
+static void medir_filtros(void)
+{
+    static filtro_mediana_t mediana;
+    static filtro_ema_q15_t ema;
+    static filtro_biquad_t biquad;
+    filtro_mediana_init(&mediana, FILTRO_PADRAO_MEDIANA);
+    filtro_ema_q15_init(&ema, FILTRO_PADRAO_ALFA);
+    filtro_biquad_passa_baixa(&biquad, FILTRO_PADRAO_CORTE_HZ, 10.0f);
+
+    const struct { const char *nome; sensor_filtro_fn fn; void *estado; } estagios[] = {
+        {"mediana", filtro_mediana, &mediana},
+        {"ema q15", filtro_ema_q15, &ema},
+        {"biquad q14", filtro_biquad, &biquad},
+    };
+    uint32_t mhz = clock_get_hz(clk_sys) / 1000000;
+
+    sleep_ms(2000);                          // Tempo para o terminal abrir a USB
+    for (uint i = 0; i < sizeof(estagios) / sizeof(estagios[0]); i++)
+    {
+        uint32_t us = filtros_bancada(estagios[i].fn, estagios[i].estado, BANCADA_AMOSTRAS, relogio_us);
+        printf("Filtro %-10s %lu ciclos/amostra\n", estagios[i].nome,
+               (unsigned long)((uint64_t)us * mhz / BANCADA_AMOSTRAS));
+    }
+}
+#endif
+
+/* === Tabela de Tarefas === */
+// Prioridades e períodos num só lugar, lidos também por tools/escalonabilidade.py,
+// que o CMake roda a cada compilação (análise de tempo de resposta). Prioridade
+// por prazo (deadline-monotonic; com prazo igual ao período é o rate-monotonic):
+// quanto mais curto o prazo, maior a prioridade, e a cadeia sensor→alerta fica
+// acima do display, cujo quadro inteiro prende a I2C por ~25 ms. Prazo 0 é
+// segundo plano, na prioridade 1. Fora da ordem por prazo ficam o supervisor,
+// no topo para ver qualquer tarefa presa, e o temporizador do FreeRTOS
+// (gerenciador de alarme), que o kernel cria na prioridade máxima.
+// Tarefas esporádicas usam como período o menor intervalo entre ativações, e
+// 'gatilho' é quem as acorda: a análise soma o atraso de liberação.
+#define CADEIA_PRAZO_MS 50         // Da amostra até LED, buzzer e matriz mostrarem o estado
+
+typedef enum
+{
+    TAREFA_TEMPORIZADOR,           // Criada pelo FreeRTOS (configTIMER_TASK_PRIORITY)
+    TAREFA_SUPERVISOR,
+    TAREFA_MATRIZ,
+    TAREFA_SENSOR,
+    TAREFA_LED,
+    TAREFA_BUZZER,
+    TAREFA_BOTOES,
+    TAREFA_DISPLAY,
+    TAREFA_CONFIG,
+    TAREFA_TELEMETRIA,
+    TAREFA_PUBLICADOR,
+    TAREFA_TOTAL,
+    TAREFA_NENHUMA = -1,
+} tarefa_id_t;
+
+typedef struct
+{
+    TaskFunction_t funcao;         // NULL: criada pelo kernel ou desligada na compilação
+    const char *nome;
+    configSTACK_DEPTH_TYPE pilha;  // Palavras
+    UBaseType_t prioridade;
+    uint16_t periodo_ms;           // Período, ou menor intervalo entre ativações
+    uint16_t prazo_ms;             // Da liberação ao fim da ativação (0 = segundo plano)
+    tarefa_id_t gatilho;           // Quem a acorda (TAREFA_NENHUMA: relógio próprio ou evento externo)
+} tarefa_t;
+
+// Colunas: função, nome, pilha, prioridade, período, prazo, gatilho
+static const tarefa_t TAREFAS[TAREFA_TOTAL] = {
+    // Gerenciador de alarme: amostras, botões e temporizadores
+    [TAREFA_TEMPORIZADOR] = {NULL, "Tmr Svc", configTIMER_TASK_STACK_DEPTH, configTIMER_TASK_PRIORITY,
+                             20, CADEIA_PRAZO_MS, TAREFA_NENHUMA},
+    [TAREFA_SUPERVISOR] = {vSupervisorTask, "Supervisor", 256, 7, SUP_PERIODO_MS, SUP_PERIODO_MS, TAREFA_NENHUMA},
+    [TAREFA_MATRIZ] = {vMatrixTask, "Matriz Task", 256, 6, MATRIZ_QUADRO_MS, MATRIZ_QUADRO_MS, TAREFA_NENHUMA},
+    [TAREFA_SENSOR] = {vSensorTask, "Sensor Task", 512, 5, 100, 20, TAREFA_NENHUMA},    // Período padrão (config_padrao.c)
+    [TAREFA_LED] = {vLedRgbTask, "LED RGB Task", 256, 4, 100, 30, TAREFA_SENSOR},        // Só em mudanças de estado
+    [TAREFA_BUZZER] = {vBuzzerTask, "Buzzer Task", 256, 4, CONFIG_BUZZER_FASE_MIN_MS, 30, TAREFA_SENSOR}, // Fim de fase, amostra ou alarme
+    [TAREFA_BOTOES] = {vBotoesTask, "Botoes Task", 256, 3, 20, 100, TAREFA_NENHUMA},     // Bordas a cada BOTAO_DEBOUNCE_US
+    [TAREFA_DISPLAY] = {vDisplayTask, "Display Task", 512, 3, 100, 100, TAREFA_SENSOR},  // Caixa de correio por amostra
+    [TAREFA_CONFIG] = {vConfigTask, "Config Task", 768, 1, 20, 0, TAREFA_NENHUMA},       // Comandos pela USB
+#if TELEMETRIA_ATIVA
+    [TAREFA_TELEMETRIA] = {vTelemetriaTask, "Telemetria Task", 512, 1, 10, 0, TAREFA_NENHUMA}, // Quadros pela USB
+#endif
+#if PUBLICADOR_ATIVO
+    [TAREFA_PUBLICADOR] = {vPublicadorTask, "Publicador Task", 512, 1, PUBLICADOR_SERVIR_MS, 0, TAREFA_NENHUMA},
+#endif
+};
 
 /* === Função Principal === */
 int main()
 {
-    // Configura o botão B (BOOTSEL)
-    gpio_init(BOTAO_B);                       // Inicializa GPIO6
-    gpio_set_dir(BOTAO_B, GPIO_IN);          // Configura como entrada
-    gpio_pull_up(BOTAO_B);                   // Ativa pull-up interno
-    // Habilita interrupção na borda de descida
-    gpio_set_irq_enabled_with_callback(BOTAO_B, GPIO_IRQ_EDGE_FALL, true, &gpio_irq_handler);
+    boot_marcar(BOOT_MAIN);                  // Reset até aqui: bootrom e runtime
+    supervisor_init();                       // Lê e apaga a causa do reinício anterior
+
+    // Botões A e B com pull-up e interrupção nas duas bordas (gestos na vBotoesTask)
+    botoes_init(BOTOES, sizeof(BOTOES) / sizeof(BOTOES[0]));
 
     stdio_init_all();                        // Inicializa comunicação serial (UART) para printf
-    // Cria fila para dados dos sensores (6 elementos, tamanho de sensor_data_t)
-    xQueueSensorData = xQueueCreate(6, sizeof(sensor_data_t));
+    historico_init(&historico);              // Zera os buffers do histórico
+    telemetria_init();                       // Prepara o anel de registros da telemetria
+    config_init();                           // Carrega a configuração da flash (ou padrão)
+    config_t cfg;
+    config_copiar(&cfg);
+    saidas_seguras(&cfg);                    // Buzzer calado, matriz apagada, LED no aviso de partida
+#if FILTROS_MEDIR
+    medir_filtros();                         // Ciclos por amostra de cada estágio
+#endif
+
+    // Informa por que a placa reiniciou (prazo vencido ou watchdog)
+    sup_reinicio_t reinicio;
+    supervisor_reinicio_anterior(&reinicio);
+    if (reinicio.causa != SUP_CAUSA_NENHUMA)
+    {
+        LOG("Reinicio: causa %d, tarefa %s, %lu ms sem batida, ligado %lu s\n", reinicio.causa, reinicio.tarefa,
+            (unsigned long)reinicio.atraso_ms, (unsigned long)reinicio.ligado_s);
+#if TELEMETRIA_ATIVA
+        telemetria_reinicio(reinicio.causa, reinicio.tarefa, reinicio.atraso_ms, reinicio.ligado_s);
+#endif
+    }
+
+    xQueueSensorData = xQueueCreate(1, sizeof(sensor_data_t)); // Caixa de correio do display
+    xQueueMatriz = xQueueCreate(1, sizeof(sensor_data_t)); // Caixa de correio da matriz
+    xQueueBuzzer = xQueueCreate(1, sizeof(alert_state_t)); // Caixa de correio do buzzer
+    xQueueLed = xQueueCreate(1, sizeof(alert_state_t));    // Caixa de correio do LED RGB
+#if PUBLICADOR_ATIVO
+    xQueuePublicador = xQueueCreate(PUBLICADOR_EVENTOS, sizeof(pub_evento_t)); // Amostras e transições para a rede
+#endif
+
+    // Gerenciador de alarme: temporizadores de uso único, armados pela própria máquina
+    alarme_param_t param;
+    alarme_parametros_cfg(&param, &cfg);
+    alarme_init(&alarme, &param, alarme_temporizador, alarme_transicao, NULL);
+    temporizadores_alarme[ALARME_TEMP_SILENCIO] =
+        xTimerCreate("Silencio", 1, pdFALSE, (void *)ALARME_TEMP_SILENCIO, alarme_venceu);
+    temporizadores_alarme[ALARME_TEMP_LIMPEZA] =
+        xTimerCreate("Limpeza", 1, pdFALSE, (void *)ALARME_TEMP_LIMPEZA, alarme_venceu);
 
-    // Cria tarefas do FreeRTOS
-    xTaskCreate(vSensorTask, "Sensor Task", 256, NULL, 1, NULL);   // Tarefa de sensores
-    xTaskCreate(vDisplayTask, "Display Task", 512, NULL, 2, NULL); // Tarefa do display
-    xTaskCreate(vLedRgbTask, "LED RGB Task", 256, NULL, 2, NULL);  // Tarefa do LED RGB
-    xTaskCreate(vBuzzerTask, "Buzzer Task", 256, NULL, 2, NULL);   // Tarefa do buzzer
-    xTaskCreate(vMatrixTask, "Matriz Task", 256, NULL, 2, NULL);   // Tarefa da matriz
+#if TELEMETRIA_ATIVA
+    xTimerStart(xTimerCreate("Tarefas", pdMS_TO_TICKS(TAREFAS_RELATORIO_MS), pdTRUE, NULL, relata_tarefas), 0);
+#endif
+#if XIP_PERFIL
+    perfil_xip_init();                       // Interrupção livre para a sonda de latência
+    xTimerStart(xTimerCreate("XIP", pdMS_TO_TICKS(XIP_PERFIL_MS), pdTRUE, NULL, relata_xip), 0);
+#endif
+
+    // Cria tarefas do FreeRTOS a partir da tabela
+    for (uint i = 0; i < TAREFA_TOTAL; i++)
+    {
+        const tarefa_t *t = &TAREFAS[i];
+        if (!t->funcao || (i == TAREFA_MATRIZ && !matriz_ok)) // Temporizador, desligadas ou matriz ausente
+            continue;
+        xTaskCreate(t->funcao, t->nome, t->pilha, NULL, t->prioridade, NULL);
+    }
 
+    boot_marcar(BOOT_ESCALONADOR);
     vTaskStartScheduler();                   // Inicia o escalonador do FreeRTOS
     panic_unsupported();                     // Caso o escalonador falhe
 }
\ No newline at end of file
@@ -0,0 +1,107 @@
+#include "alarme.h"
+
+const char *const ALARME_NOME_FASE[] = {"limpo", "ativo", "reconhecido", "escalado"};
+const char *const ALARME_NOME_CAUSA[] = {"risco", "reconhecer", "subida", "silencio", "limpeza"};
+
+void alarme_init(alarme_t *a, const alarme_param_t *param, alarme_temporizador_fn temporizador,
+                 alarme_transicao_fn transicao, void *ctx)
+{
+  a->fase = ALARME_LIMPO;
+  a->risco = a->risco_rec = SEGURO;
+  a->nivel = a->nivel_rec = 0;
+  a->limpando = false;
+  a->param = *param;
+  a->temporizador = temporizador;
+  a->transicao = transicao;
+  a->ctx = ctx;
+}
+
+void alarme_parametros(alarme_t *a, const alarme_param_t *param)
+{
+  a->param = *param;
+}
+
+static void muda(alarme_t *a, alarme_fase_t para, alarme_causa_t causa)
+{
+  alarme_fase_t de = a->fase;
+  a->fase = para;
+  if (a->transicao)
+    a->transicao(a->ctx, de, para, causa);
+}
+
+static void arma(alarme_t *a, alarme_temp_t temp, uint32_t ms)
+{
+  if (a->temporizador)
+    a->temporizador(a->ctx, temp, ms);
+}
+
+/* === Eventos === */
+
+void alarme_amostra(alarme_t *a, alert_state_t risco, uint8_t nivel_agua)
+{
+  a->risco = risco;
+  a->nivel = nivel_agua;
+
+  // Fim do risco só conta depois de 'limpeza_ms' em SEGURO, sem oscilar na borda do limiar
+  if (a->fase != ALARME_LIMPO)
+  {
+    if (risco == SEGURO && !a->limpando)
+    {
+      arma(a, ALARME_TEMP_LIMPEZA, a->param.limpeza_ms);
+      a->limpando = true;
+    }
+    else if (risco != SEGURO && a->limpando)
+    {
+      arma(a, ALARME_TEMP_LIMPEZA, 0);
+      a->limpando = false;
+    }
+  }
+
+  switch (a->fase)
+  {
+  case ALARME_LIMPO:
+    if (risco != SEGURO)
+      muda(a, ALARME_ATIVO, ALARME_CAUSA_RISCO);
+    break;
+
+  case ALARME_RECONHECIDO:
+    if (risco > a->risco_rec || (uint16_t)nivel_agua >= (uint16_t)a->nivel_rec + a->param.subida_pct)
+    {
+      arma(a, ALARME_TEMP_SILENCIO, 0);
+      muda(a, ALARME_ESCALADO, ALARME_CAUSA_SUBIDA);
+    }
+    break;
+
+  case ALARME_ATIVO:
+  case ALARME_ESCALADO:
+    break;
+  }
+}
+
+void alarme_reconhecer(alarme_t *a)
+{
+  if (a->fase != ALARME_ATIVO && a->fase != ALARME_ESCALADO)
+    return;
+
+  // A subida que escala é medida a partir do momento do reconhecimento
+  a->risco_rec = a->risco;
+  a->nivel_rec = a->nivel;
+  arma(a, ALARME_TEMP_SILENCIO, a->param.silencio_ms);
+  muda(a, ALARME_RECONHECIDO, ALARME_CAUSA_RECONHECER);
+}
+
+void alarme_expirou(alarme_t *a, alarme_temp_t temp)
+{
+  if (temp == ALARME_TEMP_SILENCIO && a->fase == ALARME_RECONHECIDO)
+  {
+    muda(a, ALARME_ATIVO, ALARME_CAUSA_SILENCIO);
+  }
+  else if (temp == ALARME_TEMP_LIMPEZA && a->limpando)
+  {
+    a->limpando = false;
+    if (a->fase == ALARME_RECONHECIDO)
+      arma(a, ALARME_TEMP_SILENCIO, 0);
+    if (a->fase != ALARME_LIMPO)
+      muda(a, ALARME_LIMPO, ALARME_CAUSA_LIMPEZA);
+  }
+}
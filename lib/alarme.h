@@ -0,0 +1,94 @@
+#ifndef ALARME_H
+#define ALARME_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "alerta.h"
+
+// Gerenciador de alarme acima da classificação (alerta.h). Decide se o
+// alarme sonoro/visual está ativo, silenciado ou escalado:
+//
+//   LIMPO ──risco──> ATIVO ──reconhecer──> RECONHECIDO ──fim do silêncio──> ATIVO
+//                                               │
+//                      subida do nível ou risco pior desde o reconhecimento
+//                                               v
+//                                           ESCALADO ──reconhecer──> RECONHECIDO
+//
+// De qualquer fase, SEGURO mantido por 'limpeza_ms' volta a LIMPO.
+//
+// Puro: não lê relógio nem cria temporizadores. Pede para armar ou cancelar
+// temporizadores pelo callback e recebe o vencimento em alarme_expirou();
+// no firmware são software timers do FreeRTOS, no host (sim/alarme.c) um
+// relógio simulado que reproduz traços gravados.
+
+typedef enum
+{
+  ALARME_LIMPO,       // sem risco; nada a sinalizar
+  ALARME_ATIVO,       // risco presente, sinalizando o padrão do estado
+  ALARME_RECONHECIDO, // silenciado pelo operador por 'silencio_ms'
+  ALARME_ESCALADO,    // ainda subindo após o reconhecimento: padrão mais forte
+} alarme_fase_t;
+
+typedef enum
+{
+  ALARME_CAUSA_RISCO,      // classificação saiu de SEGURO
+  ALARME_CAUSA_RECONHECER, // operador reconheceu
+  ALARME_CAUSA_SUBIDA,     // nível ou estado piorou depois do reconhecimento
+  ALARME_CAUSA_SILENCIO,   // fim do tempo de silêncio
+  ALARME_CAUSA_LIMPEZA,    // SEGURO mantido por 'limpeza_ms'
+} alarme_causa_t;
+
+typedef enum
+{
+  ALARME_TEMP_SILENCIO, // duração do reconhecimento
+  ALARME_TEMP_LIMPEZA,  // confirmação do fim do risco
+  ALARME_TEMPORIZADORES
+} alarme_temp_t;
+
+typedef struct
+{
+  uint32_t silencio_ms;
+  uint32_t limpeza_ms;
+  uint8_t subida_pct; // pontos percentuais de nível acima do reconhecido que escalam
+} alarme_param_t;
+
+// Arma 'temp' para vencer em 'ms' (reinicia se já armado); ms = 0 cancela
+typedef void (*alarme_temporizador_fn)(void *ctx, alarme_temp_t temp, uint32_t ms);
+// Toda transição passa por aqui (registro e publicação da fase)
+typedef void (*alarme_transicao_fn)(void *ctx, alarme_fase_t de, alarme_fase_t para, alarme_causa_t causa);
+
+typedef struct
+{
+  alarme_fase_t fase;
+  alert_state_t risco;       // última classificação recebida
+  uint8_t nivel;             // último nível de água (%) recebido
+  alert_state_t risco_rec;   // risco no reconhecimento
+  uint8_t nivel_rec;         // nível de água (%) no reconhecimento
+  bool limpando;             // temporizador de limpeza armado
+  alarme_param_t param;
+  alarme_temporizador_fn temporizador;
+  alarme_transicao_fn transicao;
+  void *ctx;
+} alarme_t;
+
+void alarme_init(alarme_t *a, const alarme_param_t *param, alarme_temporizador_fn temporizador,
+                 alarme_transicao_fn transicao, void *ctx);
+
+// Novos parâmetros valem para os próximos temporizadores armados
+void alarme_parametros(alarme_t *a, const alarme_param_t *param);
+
+// Eventos
+void alarme_amostra(alarme_t *a, alert_state_t risco, uint8_t nivel_agua);
+void alarme_reconhecer(alarme_t *a);
+void alarme_expirou(alarme_t *a, alarme_temp_t temp);
+
+// Se a saída sonora deve ficar calada na fase atual
+static inline bool alarme_silenciado(alarme_fase_t fase)
+{
+  return fase == ALARME_RECONHECIDO;
+}
+
+extern const char *const ALARME_NOME_FASE[];
+extern const char *const ALARME_NOME_CAUSA[];
+
+#endif
@@ -0,0 +1,27 @@
+#ifndef ALERTA_H
+#define ALERTA_H
+
+#include <stdint.h>
+#include "config.h"
+
+// Estados de risco e classificação a partir dos percentuais calibrados.
+// Sem dependências do hardware: usada pela vSensorTask e pelo simulador da frota (sim/).
+
+typedef enum
+{
+  SEGURO,  // Condição segura (baixo risco)
+  ALERTA,  // Condição de alerta (risco moderado)
+  ENCHENTE // Condição de enchente (alto risco)
+} alert_state_t;
+
+// Determina o estado a partir dos percentuais e dos limiares da configuração
+static inline alert_state_t alerta_classificar(uint8_t nivel_agua, uint8_t volume_chuva, const config_t *cfg)
+{
+  if (nivel_agua >= cfg->agua_enchente || volume_chuva >= cfg->chuva_enchente)
+    return ENCHENTE;
+  if (nivel_agua >= cfg->agua_alerta || volume_chuva >= cfg->chuva_alerta)
+    return ALERTA;
+  return SEGURO;
+}
+
+#endif
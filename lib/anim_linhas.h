@@ -0,0 +1,176 @@
+#ifndef ANIM_LINHAS_H
+#define ANIM_LINHAS_H
+
+#include "animador.h"
+
+// Linhas do tempo do motor de animação (lib/animador.h). Os quadros usam
+// intensidade máxima; o brilho da configuração é aplicado pelo motor.
+
+// Quadros de nível de água: N linhas azuis de baixo para cima
+static const anim_quadro_t NIVEL_1 = {
+    {{0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}},
+    {{0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}},
+    {{0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}},
+    {{0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}},
+    {{0, 0, 255}, {0, 0, 255}, {0, 0, 255}, {0, 0, 255}, {0, 0, 255}}
+};
+
+static const anim_quadro_t NIVEL_2 = {
+    {{0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}},
+    {{0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}},
+    {{0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}},
+    {{0, 0, 255}, {0, 0, 255}, {0, 0, 255}, {0, 0, 255}, {0, 0, 255}},
+    {{0, 0, 255}, {0, 0, 255}, {0, 0, 255}, {0, 0, 255}, {0, 0, 255}}
+};
+
+static const anim_quadro_t NIVEL_3 = {
+    {{0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}},
+    {{0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}},
+    {{0, 0, 255}, {0, 0, 255}, {0, 0, 255}, {0, 0, 255}, {0, 0, 255}},
+    {{0, 0, 255}, {0, 0, 255}, {0, 0, 255}, {0, 0, 255}, {0, 0, 255}},
+    {{0, 0, 255}, {0, 0, 255}, {0, 0, 255}, {0, 0, 255}, {0, 0, 255}}
+};
+
+static const anim_quadro_t NIVEL_4 = {
+    {{0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}},
+    {{0, 0, 255}, {0, 0, 255}, {0, 0, 255}, {0, 0, 255}, {0, 0, 255}},
+    {{0, 0, 255}, {0, 0, 255}, {0, 0, 255}, {0, 0, 255}, {0, 0, 255}},
+    {{0, 0, 255}, {0, 0, 255}, {0, 0, 255}, {0, 0, 255}, {0, 0, 255}},
+    {{0, 0, 255}, {0, 0, 255}, {0, 0, 255}, {0, 0, 255}, {0, 0, 255}}
+};
+
+static const anim_quadro_t NIVEL_5 = {
+    {{0, 0, 255}, {0, 0, 255}, {0, 0, 255}, {0, 0, 255}, {0, 0, 255}},
+    {{0, 0, 255}, {0, 0, 255}, {0, 0, 255}, {0, 0, 255}, {0, 0, 255}},
+    {{0, 0, 255}, {0, 0, 255}, {0, 0, 255}, {0, 0, 255}, {0, 0, 255}},
+    {{0, 0, 255}, {0, 0, 255}, {0, 0, 255}, {0, 0, 255}, {0, 0, 255}},
+    {{0, 0, 255}, {0, 0, 255}, {0, 0, 255}, {0, 0, 255}, {0, 0, 255}}
+};
+
+// Gotas de chuva: posições sorteadas uma vez, no lugar de rand() a cada quadro
+static const anim_quadro_t GOTAS_0 = {
+    {{0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {48, 48, 160}},
+    {{0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}},
+    {{0, 0, 0}, {48, 48, 160}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}},
+    {{48, 48, 160}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}},
+    {{0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}}
+};
+
+static const anim_quadro_t GOTAS_1 = {
+    {{0, 0, 0}, {0, 0, 0}, {48, 48, 160}, {0, 0, 0}, {0, 0, 0}},
+    {{0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}},
+    {{0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}},
+    {{0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}},
+    {{48, 48, 160}, {48, 48, 160}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}}
+};
+
+static const anim_quadro_t GOTAS_2 = {
+    {{48, 48, 160}, {48, 48, 160}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}},
+    {{0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}},
+    {{0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}},
+    {{0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {48, 48, 160}, {0, 0, 0}},
+    {{0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}}
+};
+
+static const anim_quadro_t GOTAS_3 = {
+    {{0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {48, 48, 160}},
+    {{0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}},
+    {{0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}},
+    {{48, 48, 160}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}},
+    {{48, 48, 160}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}}
+};
+
+static const anim_quadro_t GOTAS_4 = {
+    {{0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {48, 48, 160}},
+    {{0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {48, 48, 160}},
+    {{0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}},
+    {{0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}},
+    {{0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {48, 48, 160}, {0, 0, 0}}
+};
+
+static const anim_quadro_t GOTAS_5 = {
+    {{0, 0, 0}, {48, 48, 160}, {0, 0, 0}, {0, 0, 0}, {48, 48, 160}},
+    {{0, 0, 0}, {0, 0, 0}, {48, 48, 160}, {0, 0, 0}, {0, 0, 0}},
+    {{0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}},
+    {{0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}},
+    {{0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}}
+};
+
+static const anim_quadro_t GOTAS_6 = {
+    {{0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}},
+    {{0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}},
+    {{0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}},
+    {{0, 0, 0}, {48, 48, 160}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}},
+    {{48, 48, 160}, {0, 0, 0}, {48, 48, 160}, {0, 0, 0}, {0, 0, 0}}
+};
+
+static const anim_quadro_t GOTAS_7 = {
+    {{0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {48, 48, 160}},
+    {{0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}},
+    {{48, 48, 160}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}},
+    {{0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}},
+    {{0, 0, 0}, {48, 48, 160}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}}
+};
+
+static const anim_quadro_t CANTOS_VERMELHOS = {
+    {{255, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {255, 0, 0}},
+    {{0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}},
+    {{0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}},
+    {{0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}},
+    {{255, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {255, 0, 0}}
+};
+
+static const anim_quadro_t APAGADO = {
+    {{0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}},
+    {{0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}},
+    {{0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}},
+    {{0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}},
+    {{0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}}
+};
+
+// Nível de água: um quadro estático por faixa; a troca entre faixas faz o crossfade
+#define NIVEL_CHAVE(q) static const anim_chave_t CHAVE_##q[] = {{&q, 1000, false}}
+NIVEL_CHAVE(APAGADO);
+NIVEL_CHAVE(NIVEL_1);
+NIVEL_CHAVE(NIVEL_2);
+NIVEL_CHAVE(NIVEL_3);
+NIVEL_CHAVE(NIVEL_4);
+NIVEL_CHAVE(NIVEL_5);
+
+static const anim_linha_t LINHA_NIVEL[6] = {
+    {CHAVE_APAGADO, 1, true},
+    {CHAVE_NIVEL_1, 1, true},
+    {CHAVE_NIVEL_2, 1, true},
+    {CHAVE_NIVEL_3, 1, true},
+    {CHAVE_NIVEL_4, 1, true},
+    {CHAVE_NIVEL_5, 1, true},
+};
+
+// ALERTA: gotas caindo a 4 Hz, com mistura curta entre quadros
+static const anim_chave_t CHAVES_CHUVA[] = {
+    {&GOTAS_0, 250, true}, {&GOTAS_1, 250, true}, {&GOTAS_2, 250, true}, {&GOTAS_3, 250, true},
+    {&GOTAS_4, 250, true}, {&GOTAS_5, 250, true}, {&GOTAS_6, 250, true}, {&GOTAS_7, 250, true},
+};
+static const anim_linha_t LINHA_CHUVA = {CHAVES_CHUVA, 8, true};
+
+// ENCHENTE: cantos vermelhos pulsando (sobe e desce por interpolação)
+static const anim_chave_t CHAVES_PULSO[] = {
+    {&CANTOS_VERMELHOS, 400, true},
+    {&APAGADO, 400, true},
+};
+static const anim_linha_t LINHA_PULSO = {CHAVES_PULSO, 2, true};
+
+// Sobreposição por estado (SEGURO, ALERTA, ENCHENTE); NULL = nenhuma
+static const anim_linha_t *const LINHA_ESTADO[3] = {NULL, &LINHA_CHUVA, &LINHA_PULSO};
+
+// Faixa de nível (0–5 linhas acesas) a partir do percentual de água
+static inline uint8_t anim_faixa_nivel(uint8_t percent_agua) {
+    if (percent_agua >= 98) return 5;
+    if (percent_agua >= 80) return 4;
+    if (percent_agua >= 60) return 3;
+    if (percent_agua >= 40) return 2;
+    if (percent_agua >= 20) return 1;
+    return 0; // 0–19%: nenhuma linha
+}
+
+#endif
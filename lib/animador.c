@@ -0,0 +1,149 @@
+#include "animador.h"
+#include <string.h>
+#include "perfil_xip.h"
+
+// Mesmo resultado de getIndex(x, y), calculado uma vez: linhas pares da esquerda
+// para a direita, ímpares da direita para a esquerda, LED 0 no canto inferior direito.
+const uint8_t anim_mapa_serpentina[ANIM_ALTURA][ANIM_LARGURA] = {
+  {24, 23, 22, 21, 20},
+  {15, 16, 17, 18, 19},
+  {14, 13, 12, 11, 10},
+  {5, 6, 7, 8, 9},
+  {4, 3, 2, 1, 0},
+};
+
+void animador_init(animador_t *a, uint8_t brilho)
+{
+  memset(a, 0, sizeof(*a));
+  a->brilho = brilho;
+}
+
+static void inicia_fade(anim_camada_t *c, uint8_t ini, uint8_t fim, uint16_t fade_ms)
+{
+  c->alfa_ini = ini;
+  c->alfa_fim = fim;
+  c->fade_ms = fade_ms;
+  c->fade_t_ms = 0;
+}
+
+// Alfa atual da camada (0–255) conforme o andamento do fade
+static uint8_t alfa_atual(const anim_camada_t *c)
+{
+  if (c->fade_t_ms >= c->fade_ms)
+    return c->alfa_fim;
+  int32_t delta = (int32_t)c->alfa_fim - c->alfa_ini;
+  return (uint8_t)(c->alfa_ini + delta * c->fade_t_ms / c->fade_ms);
+}
+
+void animador_trocar(animador_t *a, uint8_t grupo, const anim_linha_t *linha, uint16_t fade_ms)
+{
+  anim_camada_t *par = &a->camada[grupo * 2];
+
+  // A camada "ativa" do grupo é a que está aparecendo ou já visível
+  anim_camada_t *ativa = NULL, *livre = &par[0];
+  for (int i = 0; i < 2; i++)
+  {
+    if (par[i].linha != NULL && par[i].alfa_fim > 0)
+    {
+      ativa = &par[i];
+      livre = &par[1 - i];
+    }
+  }
+
+  if (ativa != NULL && ativa->linha == linha)
+    return;
+
+  if (ativa != NULL)
+    inicia_fade(ativa, alfa_atual(ativa), 0, fade_ms);
+
+  if (linha != NULL)
+  {
+    livre->linha = linha;
+    livre->chave = 0;
+    livre->t_ms = 0;
+    inicia_fade(livre, 0, 255, fade_ms);
+  }
+}
+
+// Avança a linha do tempo de uma camada; libera a camada quando termina de desvanecer
+static void QUENTE(avanca)(anim_camada_t *c, uint16_t dt_ms)
+{
+  if (c->fade_t_ms < c->fade_ms)
+    c->fade_t_ms = (c->fade_ms - c->fade_t_ms > dt_ms) ? c->fade_t_ms + dt_ms : c->fade_ms;
+  if (c->fade_t_ms >= c->fade_ms && c->alfa_fim == 0)
+  {
+    c->linha = NULL;
+    return;
+  }
+
+  const anim_linha_t *l = c->linha;
+  c->t_ms += dt_ms;
+  while (c->t_ms >= l->chaves[c->chave].duracao_ms)
+  {
+    if (c->chave + 1 < l->total)
+    {
+      c->t_ms -= l->chaves[c->chave].duracao_ms;
+      c->chave++;
+    }
+    else if (l->repete)
+    {
+      c->t_ms -= l->chaves[c->chave].duracao_ms;
+      c->chave = 0;
+    }
+    else
+    {
+      c->t_ms = l->chaves[c->chave].duracao_ms; // segura o último quadro
+      break;
+    }
+  }
+}
+
+void QUENTE(animador_quadro)(animador_t *a, uint16_t dt_ms, uint8_t saida[ANIM_LEDS][3])
+{
+  uint16_t soma[ANIM_LEDS][3];
+  memset(soma, 0, sizeof(soma));
+
+  for (int i = 0; i < ANIM_CAMADAS; i++)
+  {
+    anim_camada_t *c = &a->camada[i];
+    if (c->linha == NULL)
+      continue;
+    avanca(c, dt_ms);
+    if (c->linha == NULL)
+      continue;
+
+    const anim_linha_t *l = c->linha;
+    const anim_chave_t *k = &l->chaves[c->chave];
+    const uint8_t *q0 = &(*k->quadro)[0][0][0];
+
+    // Mistura com o próximo quadro: fração em 1/256 (uma divisão por camada, não por pixel)
+    const uint8_t *q1 = q0;
+    uint16_t f = 0;
+    if (k->mistura && k->duracao_ms > 0)
+    {
+      uint8_t prox = (c->chave + 1 < l->total) ? c->chave + 1 : (l->repete ? 0 : c->chave);
+      q1 = &(*l->chaves[prox].quadro)[0][0][0];
+      f = (uint16_t)(((uint32_t)c->t_ms << 8) / k->duracao_ms);
+    }
+
+    // Alfa da camada combinado com o brilho global
+    uint16_t ganho = (uint16_t)((alfa_atual(c) * (a->brilho + 1u)) >> 8);
+
+    const uint8_t *mapa = &anim_mapa_serpentina[0][0];
+    for (int p = 0; p < ANIM_LEDS; p++)
+    {
+      uint8_t led = mapa[p];
+      for (int ch = 0; ch < 3; ch++)
+      {
+        int32_t v0 = q0[p * 3 + ch];
+        int32_t v = v0 + (((q1[p * 3 + ch] - v0) * (int32_t)f) >> 8);
+        soma[led][ch] += (uint16_t)(((uint32_t)v * (ganho + 1u)) >> 8);
+      }
+    }
+  }
+
+  // Composição aditiva com saturação
+  for (int led = 0; led < ANIM_LEDS; led++)
+    for (int ch = 0; ch < 3; ch++)
+      saida[led][ch] = soma[led][ch] > 255 ? 255 : (uint8_t)soma[led][ch];
+}
@@ -0,0 +1,67 @@
+#ifndef ANIMADOR_H
+#define ANIMADOR_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Motor de animação da matriz 5x5: toca linhas do tempo constantes (quadros-chave
+// com duração e mistura opcional para o próximo), em várias camadas somadas, com
+// crossfade entre linhas do tempo. Nada bloqueia: a tarefa chama animador_quadro()
+// a cada tique do relógio de quadros.
+
+#define ANIM_LARGURA 5
+#define ANIM_ALTURA 5
+#define ANIM_LEDS (ANIM_LARGURA * ANIM_ALTURA)
+#define ANIM_GRUPOS 2                  // animações independentes simultâneas
+#define ANIM_CAMADAS (ANIM_GRUPOS * 2) // cada grupo tem duas camadas para o crossfade
+
+// Quadro em coordenadas da matriz: [linha][coluna][R, G, B], linha 0 no topo
+typedef uint8_t anim_quadro_t[ANIM_ALTURA][ANIM_LARGURA][3];
+
+typedef struct
+{
+  const anim_quadro_t *quadro;
+  uint16_t duracao_ms; // > 0
+  bool mistura; // true: interpola até o próximo quadro durante a duração
+} anim_chave_t;
+
+typedef struct
+{
+  const anim_chave_t *chaves;
+  uint8_t total;
+  bool repete; // false: mantém o último quadro ao terminar
+} anim_linha_t;
+
+typedef struct
+{
+  const anim_linha_t *linha; // NULL = camada livre
+  uint8_t chave;
+  uint16_t t_ms;             // tempo dentro da chave atual
+  uint8_t alfa_ini, alfa_fim;
+  uint16_t fade_ms, fade_t_ms;
+} anim_camada_t;
+
+typedef struct
+{
+  anim_camada_t camada[ANIM_CAMADAS];
+  uint8_t brilho; // escala global 0–255
+} animador_t;
+
+// Índice do LED na cadeia para cada posição [linha][coluna] (fiação em serpentina)
+extern const uint8_t anim_mapa_serpentina[ANIM_ALTURA][ANIM_LARGURA];
+
+void animador_init(animador_t *a, uint8_t brilho);
+
+/**
+ * Troca a linha do tempo de um grupo com crossfade de fade_ms: a camada atual
+ * desvanece enquanto a nova aparece. linha = NULL apenas apaga o grupo.
+ * Trocar para a linha que já está tocando não faz nada.
+ */
+void animador_trocar(animador_t *a, uint8_t grupo, const anim_linha_t *linha, uint16_t fade_ms);
+
+/**
+ * Avança todas as camadas dt_ms e compõe o quadro na ordem da cadeia de LEDs.
+ */
+void animador_quadro(animador_t *a, uint16_t dt_ms, uint8_t saida[ANIM_LEDS][3]);
+
+#endif
@@ -0,0 +1,38 @@
+#include "boot.h"
+#include "hardware/timer.h"
+
+const char *const BOOT_NOME_FASE[] = {"main", "seguro", "escalonador", "amostra", "led", "buzzer", "matriz", "display"};
+
+// Cada fase tem um só dono e uma escrita de 32 bits: nenhuma trava
+static volatile uint32_t marcas[BOOT_FASES]; // 0 = não marcada
+
+void boot_marcar(boot_fase_t fase)
+{
+  if (marcas[fase] == 0)
+  {
+    uint32_t t = time_us_32();
+    marcas[fase] = t ? t : 1;
+  }
+}
+
+bool boot_concluido(void)
+{
+  for (int i = 0; i < BOOT_FASES; i++)
+    if (marcas[i] == 0)
+      return false;
+  return true;
+}
+
+uint32_t boot_fase_us(boot_fase_t fase)
+{
+  return marcas[fase];
+}
+
+uint32_t boot_total_us(void)
+{
+  uint32_t maior = 0;
+  for (int i = 0; i < BOOT_FASES; i++)
+    if (marcas[i] > maior)
+      maior = marcas[i];
+  return maior;
+}
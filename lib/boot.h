@@ -0,0 +1,42 @@
+#ifndef BOOT_H
+#define BOOT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Marcas de tempo da partida, em us desde o reset. O timer do RP2040 conta
+// a partir do reset, então a primeira marca já inclui o bootrom, a cópia do
+// segundo estágio e a inicialização do runtime. Cada fase é marcada uma vez
+// por quem a conclui (main ou a tarefa da saída); o relatório sai quando a
+// última saída mostrar a primeira amostra classificada.
+
+#define BOOT_ORCAMENTO_MS 300 // reset até todas as saídas refletirem a primeira amostra
+
+typedef enum
+{
+  BOOT_MAIN,        // entrada do main()
+  BOOT_SEGURO,      // buzzer calado, matriz apagada e LED no aviso de partida
+  BOOT_ESCALONADOR, // logo antes de vTaskStartScheduler
+  BOOT_AMOSTRA,     // primeira amostra lida e classificada
+  BOOT_LED,         // LED com o efeito do estado classificado
+  BOOT_BUZZER,      // buzzer com o padrão do estado
+  BOOT_MATRIZ,      // primeiro quadro da matriz com a amostra
+  BOOT_DISPLAY,     // primeiro quadro inteiro no OLED
+  BOOT_FASES
+} boot_fase_t;
+
+// Só a primeira marca de cada fase conta
+void boot_marcar(boot_fase_t fase);
+
+// Todas as fases marcadas
+bool boot_concluido(void);
+
+// Marca da fase em us desde o reset (0 = ainda não marcada)
+uint32_t boot_fase_us(boot_fase_t fase);
+
+// Maior marca: reset até a última saída atualizada
+uint32_t boot_total_us(void);
+
+extern const char *const BOOT_NOME_FASE[];
+
+#endif
@@ -0,0 +1,208 @@
+#include "botoes.h"
+#include "pico/stdlib.h"
+#include "hardware/gpio.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "perfil_xip.h"
+
+#define ANEL_BORDAS 32 // potência de 2
+
+typedef struct
+{
+  uint32_t t_us;
+  uint8_t botao;
+  bool pressionado;
+} borda_t;
+
+// Anel de produtor único (IRQ) e consumidor único (vBotoesTask)
+static borda_t anel[ANEL_BORDAS];
+static volatile uint32_t escritas, lidas;
+static volatile uint32_t descartadas;
+
+static const botao_desc_t *botoes;
+static uint8_t total;
+static TaskHandle_t tarefa;
+
+/* === Decodificador === */
+
+void botao_decod_init(botao_decod_t *b, uint16_t longo_ms)
+{
+  b->bruto = b->estavel = false;
+  b->clique_pendente = b->longo_emitido = false;
+  b->longo_us = (uint32_t)longo_ms * 1000;
+  b->t_borda = b->t_pressao = b->t_soltura = 0;
+}
+
+void botao_decod_borda(botao_decod_t *b, bool pressionado, uint32_t t_us)
+{
+  b->bruto = pressionado;
+  b->t_borda = t_us;
+}
+
+gesto_t botao_decod_avancar(botao_decod_t *b, uint32_t agora)
+{
+  // Debounce: a última borda vale se nada mudou por BOTAO_DEBOUNCE_US
+  if (b->bruto != b->estavel && agora - b->t_borda >= BOTAO_DEBOUNCE_US)
+  {
+    b->estavel = b->bruto;
+    if (b->estavel)
+    {
+      b->t_pressao = b->t_borda;
+      b->longo_emitido = false;
+    }
+    else if (!b->longo_emitido)
+    {
+      if (b->clique_pendente)
+      {
+        b->clique_pendente = false;
+        return GESTO_DUPLO;
+      }
+      b->clique_pendente = true;
+      b->t_soltura = b->t_borda;
+    }
+  }
+
+  if (b->estavel && b->longo_us && !b->longo_emitido && agora - b->t_pressao >= b->longo_us)
+  {
+    b->longo_emitido = true;
+    b->clique_pendente = false; // pressão longa depois de um clique descarta o clique
+    return GESTO_LONGO;
+  }
+
+  if (b->clique_pendente && !b->estavel && agora - b->t_soltura >= BOTAO_DUPLO_US)
+  {
+    b->clique_pendente = false;
+    return GESTO_CLIQUE;
+  }
+  return GESTO_NENHUM;
+}
+
+static uint32_t falta(uint32_t inicio, uint32_t duracao, uint32_t agora)
+{
+  uint32_t passado = agora - inicio;
+  return passado >= duracao ? 0 : duracao - passado;
+}
+
+uint32_t botao_decod_espera_us(const botao_decod_t *b, uint32_t agora)
+{
+  uint32_t espera = UINT32_MAX, t;
+
+  if (b->bruto != b->estavel && (t = falta(b->t_borda, BOTAO_DEBOUNCE_US, agora)) < espera)
+    espera = t;
+  if (b->estavel && b->longo_us && !b->longo_emitido && (t = falta(b->t_pressao, b->longo_us, agora)) < espera)
+    espera = t;
+  if (b->clique_pendente && !b->estavel && (t = falta(b->t_soltura, BOTAO_DUPLO_US, agora)) < espera)
+    espera = t;
+  return espera;
+}
+
+/* === Interrupção === */
+
+static void QUENTE(empilha)(uint8_t botao, bool pressionado, uint32_t t_us)
+{
+  uint32_t e = escritas;
+  if (e - lidas >= ANEL_BORDAS)
+  {
+    // Anel cheio (ressalto longo com a tarefa atrasada): o nível final não
+    // pode se perder, então ele substitui a borda mais recente do mesmo botão
+    descartadas++;
+    borda_t *ultima = &anel[(e - 1) & (ANEL_BORDAS - 1)];
+    if (ultima->botao == botao)
+      *ultima = (borda_t){t_us, botao, pressionado};
+    return;
+  }
+  anel[e & (ANEL_BORDAS - 1)] = (borda_t){t_us, botao, pressionado};
+  escritas = e + 1;
+}
+
+// Só marca o tempo: quem interpreta é a vBotoesTask
+static void QUENTE(botoes_irq)(uint gpio, uint32_t eventos)
+{
+  PERFIL_XIP_INICIO(m);
+  uint32_t t = time_us_32();
+  for (uint8_t i = 0; i < total; i++)
+  {
+    if (botoes[i].gpio != gpio)
+      continue;
+
+    bool pressionado = !gpio_get(gpio);
+    // As duas bordas desde o último atendimento: registra também a intermediária
+    if ((eventos & GPIO_IRQ_EDGE_FALL) && (eventos & GPIO_IRQ_EDGE_RISE))
+      empilha(i, !pressionado, t);
+    empilha(i, pressionado, t);
+
+    if (tarefa)
+    {
+      BaseType_t acordou = pdFALSE;
+      vTaskNotifyGiveFromISR(tarefa, &acordou);
+      portYIELD_FROM_ISR(acordou);
+    }
+    break;
+  }
+  PERFIL_XIP_FIM(m, XIP_ISR_GPIO);
+}
+
+void botoes_init(const botao_desc_t *tabela, uint8_t n)
+{
+  botoes = tabela;
+  total = n > BOTOES_MAX ? BOTOES_MAX : n;
+
+  for (uint8_t i = 0; i < total; i++)
+  {
+    gpio_init(botoes[i].gpio);
+    gpio_set_dir(botoes[i].gpio, GPIO_IN);
+    gpio_pull_up(botoes[i].gpio);
+    gpio_set_irq_enabled_with_callback(botoes[i].gpio, GPIO_IRQ_EDGE_FALL | GPIO_IRQ_EDGE_RISE, true, &botoes_irq);
+  }
+}
+
+uint32_t botoes_descartadas(void)
+{
+  return descartadas;
+}
+
+/* === Tarefa === */
+
+static void executa(uint8_t i, gesto_t gesto)
+{
+  if (botoes[i].acao)
+    botoes[i].acao(gesto);
+}
+
+void vBotoesTask(void *params)
+{
+  botao_decod_t decod[BOTOES_MAX];
+  for (uint8_t i = 0; i < total; i++)
+    botao_decod_init(&decod[i], botoes[i].longo_ms);
+  tarefa = xTaskGetCurrentTaskHandle();
+
+  while (true)
+  {
+    // Bordas na ordem em que chegaram; os prazos anteriores a cada borda vencem antes dela
+    while (lidas != escritas)
+    {
+      borda_t b = anel[lidas & (ANEL_BORDAS - 1)];
+      lidas++;
+      gesto_t g;
+      while ((g = botao_decod_avancar(&decod[b.botao], b.t_us)) != GESTO_NENHUM)
+        executa(b.botao, g);
+      botao_decod_borda(&decod[b.botao], b.pressionado, b.t_us);
+    }
+
+    // Prazos vencidos até agora e o próximo a esperar
+    uint32_t agora = time_us_32();
+    uint32_t espera = UINT32_MAX;
+    for (uint8_t i = 0; i < total; i++)
+    {
+      gesto_t g;
+      while ((g = botao_decod_avancar(&decod[i], agora)) != GESTO_NENHUM)
+        executa(i, g);
+      uint32_t t = botao_decod_espera_us(&decod[i], agora);
+      if (t < espera)
+        espera = t;
+    }
+
+    TickType_t ticks = espera == UINT32_MAX ? portMAX_DELAY : pdMS_TO_TICKS(espera / 1000 + 1);
+    ulTaskNotifyTake(pdTRUE, ticks);
+  }
+}
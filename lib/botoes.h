@@ -0,0 +1,76 @@
+#ifndef BOTOES_H
+#define BOTOES_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Entrada dos botões. A interrupção de GPIO só marca o tempo de cada borda
+// em um anel e acorda a vBotoesTask; a tarefa, abaixo da cadeia dos sensores, aplica
+// o debounce e decodifica os gestos (clique, duplo clique, pressão longa),
+// chamando a ação de cada botão no contexto dela. Nada disso passa pelo
+// caminho dos sensores.
+
+#define BOTOES_MAX 4
+#define BOTAO_DEBOUNCE_US 20000 // nível precisa ficar estável por 20 ms
+#define BOTAO_DUPLO_US 300000   // segundo toque até 300 ms depois de soltar
+
+typedef enum
+{
+  GESTO_NENHUM,
+  GESTO_CLIQUE, // solto antes da pressão longa e sem segundo toque
+  GESTO_DUPLO,  // dois cliques seguidos
+  GESTO_LONGO,  // mantido por 'longo_ms' (emitido ainda pressionado)
+} gesto_t;
+
+typedef void (*botao_acao_fn)(gesto_t gesto);
+
+typedef struct
+{
+  uint8_t gpio;         // entrada com pull-up; pressionado = nível baixo
+  uint16_t longo_ms;    // duração da pressão longa (0 = sem pressão longa)
+  botao_acao_fn acao;   // chamada pela vBotoesTask
+} botao_desc_t;
+
+// Decodificador de um botão (puro: tempos em us, sem acesso ao hardware)
+typedef struct
+{
+  bool bruto;           // nível da última borda (true = pressionado)
+  bool estavel;         // nível após o debounce
+  bool clique_pendente; // clique esperando um possível segundo toque
+  bool longo_emitido;   // pressão atual já virou GESTO_LONGO
+  uint32_t longo_us;
+  uint32_t t_borda;     // última borda
+  uint32_t t_pressao;   // início da pressão estável
+  uint32_t t_soltura;   // fim do clique pendente
+} botao_decod_t;
+
+void botao_decod_init(botao_decod_t *b, uint16_t longo_ms);
+
+// Registra uma borda. Chamar botao_decod_avancar(b, t_us) antes, para os
+// gestos anteriores à borda saírem na ordem certa.
+void botao_decod_borda(botao_decod_t *b, bool pressionado, uint32_t t_us);
+
+/**
+ * Avança o relógio do decodificador até 'agora_us' e devolve um gesto
+ * concluído (ou GESTO_NENHUM). Chamar até devolver GESTO_NENHUM.
+ */
+gesto_t botao_decod_avancar(botao_decod_t *b, uint32_t agora_us);
+
+// Tempo até o próximo prazo do decodificador (UINT32_MAX se ocioso)
+uint32_t botao_decod_espera_us(const botao_decod_t *b, uint32_t agora_us);
+
+/**
+ * Configura as entradas e a interrupção de borda (subida e descida) para os
+ * botões da tabela, que deve continuar válida. Chamar antes do escalonador.
+ */
+void botoes_init(const botao_desc_t *botoes, uint8_t total);
+
+/**
+ * Tarefa que esvazia o anel de bordas e executa as ações dos gestos.
+ */
+void vBotoesTask(void *params);
+
+// Bordas perdidas com o anel cheio
+uint32_t botoes_descartadas(void);
+
+#endif
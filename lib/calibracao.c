@@ -0,0 +1,9 @@
+#include "calibracao.h"
+
+void calib_preparar(calib_canal_t *c, uint16_t offset, uint16_t ganho_q12, uint16_t fundo_escala)
+{
+  c->offset = offset;
+  c->ganho_q12 = ganho_q12;
+  // Arredondado; 4095 * mult_eng cabe em 32 bits para fundo de escala até CALIB_FUNDO_MAX
+  c->mult_eng = (((uint32_t)fundo_escala << CALIB_ENG_SHIFT) + CALIB_ADC_MAX / 2) / CALIB_ADC_MAX;
+}
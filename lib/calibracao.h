@@ -0,0 +1,60 @@
+#ifndef CALIBRACAO_H
+#define CALIBRACAO_H
+
+#include <stdint.h>
+
+// Estágio único de conversão dos sensores, feito uma vez por amostra na vSensorTask.
+// O Cortex-M0+ não tem instrução de divisão: tudo aqui é multiplicação e deslocamento.
+// As únicas divisões acontecem em calib_preparar(), quando a configuração muda.
+
+#define CALIB_ADC_MAX 4095
+#define CALIB_GANHO_UNITARIO 4096 // ganho em Q12 (4096 = 1,0)
+
+// floor(x * 100 / 4095) == (x * CALIB_PCT_MULT) >> CALIB_PCT_SHIFT para todo x em 0..4095
+#define CALIB_PCT_MULT 51213u
+#define CALIB_PCT_SHIFT 21
+
+#define CALIB_ENG_SHIFT 16
+#define CALIB_FUNDO_MAX 60000
+
+typedef struct
+{
+  uint16_t offset;    // contagens subtraídas da leitura bruta
+  uint16_t ganho_q12; // ganho aplicado após o offset
+  uint32_t mult_eng;  // fundo_escala / 4095 em Q16
+} calib_canal_t;
+
+typedef struct
+{
+  uint16_t cal; // leitura calibrada (0–4095)
+  uint8_t pct;  // 0–100 %
+  uint16_t eng; // unidade de engenharia em ponto fixo (ver config_t)
+} calib_saida_t;
+
+/**
+ * Pré-calcula o recíproco da unidade de engenharia: 'fundo_escala' é o valor
+ * da unidade quando a leitura calibrada é 4095.
+ */
+void calib_preparar(calib_canal_t *c, uint16_t offset, uint16_t ganho_q12, uint16_t fundo_escala);
+
+// Percentual inteiro sem divisão (mesmo resultado de (x * 100) / 4095)
+static inline uint8_t calib_percentual(uint16_t x)
+{
+  return (uint8_t)((x * CALIB_PCT_MULT) >> CALIB_PCT_SHIFT);
+}
+
+static inline void calib_converter(const calib_canal_t *c, uint16_t bruto, calib_saida_t *s)
+{
+  int32_t v = (int32_t)bruto - c->offset;
+  if (v < 0)
+    v = 0;
+  v = (v * c->ganho_q12) >> 12;
+  if (v > CALIB_ADC_MAX)
+    v = CALIB_ADC_MAX;
+
+  s->cal = (uint16_t)v;
+  s->pct = calib_percentual(s->cal);
+  s->eng = (uint16_t)(((uint32_t)v * c->mult_eng + (1u << (CALIB_ENG_SHIFT - 1))) >> CALIB_ENG_SHIFT);
+}
+
+#endif
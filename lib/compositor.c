@@ -0,0 +1,255 @@
+#include "compositor.h"
+#include <string.h>
+
+#define COMPOSITOR_LACUNA 16 // colunas iguais que justificam abrir outra janela
+
+/* === Valores retidos === */
+
+void widget_texto(widget_t *w, const char *texto)
+{
+  if (w->texto != texto)
+  {
+    w->texto = texto;
+    w->sujo = true;
+  }
+}
+
+void widget_imagem(widget_t *w, const imagem_t *imagem)
+{
+  if (w->imagem != imagem)
+  {
+    w->imagem = imagem;
+    w->sujo = true;
+  }
+}
+
+void widget_valor(widget_t *w, int32_t valor)
+{
+  if (w->valor != valor)
+  {
+    w->valor = valor;
+    w->sujo = true;
+  }
+}
+
+void widget_visivel(widget_t *w, bool visivel)
+{
+  if (w->visivel != visivel)
+  {
+    w->visivel = visivel;
+    w->sujo = true;
+  }
+}
+
+/* === Rasterização === */
+
+static void limpa_caixa(ssd1306_t *ssd, const widget_t *w)
+{
+  ssd1306_rect(ssd, w->y, w->x, w->largura, w->altura, false, true);
+}
+
+// Texto em uma linha a partir de x, recortado na borda do painel; devolve o x seguinte
+static uint8_t desenha_texto(ssd1306_t *ssd, const char *s, uint8_t x, uint8_t y)
+{
+  for (; s && *s && x < WIDTH; s++, x += 8)
+    ssd1306_draw_glyph(ssd, SSD1306_GLIFO(*s), x, y);
+  return x;
+}
+
+// Número decimal direto em glifos, sem formatação: os dígitos saem do menos
+// significativo e são desenhados na ordem certa
+static uint8_t desenha_numero(ssd1306_t *ssd, int32_t v, uint8_t x, uint8_t y)
+{
+  uint8_t glifos[11]; // sinal + 10 dígitos
+  uint8_t n = 0;
+  uint32_t u = v < 0 ? 0u - (uint32_t)v : (uint32_t)v;
+
+  do
+  {
+    // u / 10 por multiplicação: 0xCCCCCCCD = ceil(2^35 / 10), exato para todo uint32
+    uint32_t q = (uint32_t)(((uint64_t)u * 0xCCCCCCCDu) >> 35);
+    glifos[n++] = (uint8_t)(SSD1306_GLIFO('0') + (u - q * 10));
+    u = q;
+  } while (u);
+  if (v < 0)
+    glifos[n++] = SSD1306_GLIFO('-');
+
+  while (n && x < WIDTH)
+  {
+    ssd1306_draw_glyph(ssd, glifos[--n], x, y);
+    x += 8;
+  }
+  return x;
+}
+
+static void desenha(ssd1306_t *ssd, const widget_t *w)
+{
+  switch (w->tipo)
+  {
+  case WIDGET_ROTULO:
+    limpa_caixa(ssd, w);
+    if (w->visivel)
+      desenha_texto(ssd, w->texto, w->x, w->y);
+    break;
+
+  case WIDGET_VALOR:
+    limpa_caixa(ssd, w);
+    if (w->visivel)
+    {
+      uint8_t x = desenha_texto(ssd, w->texto, w->x, w->y);
+      x = desenha_numero(ssd, w->valor, x, w->y);
+      desenha_texto(ssd, w->sufixo, x, w->y);
+    }
+    break;
+
+  case WIDGET_IMAGEM:
+    limpa_caixa(ssd, w);
+    if (w->visivel && w->imagem)
+      ssd1306_blit(ssd, w->imagem->colunas, w->imagem->largura, w->x, w->y);
+    break;
+
+  case WIDGET_BARRA:
+    limpa_caixa(ssd, w);
+    if (w->visivel)
+    {
+      int32_t v = w->valor < 0 ? 0 : w->valor > w->max ? w->max : w->valor;
+      uint8_t preenchido = (uint8_t)(((uint32_t)v * w->escala) >> 16);
+      if (preenchido > 0)
+        ssd1306_rect(ssd, w->y, w->x, preenchido, w->altura, true, true);
+      ssd1306_rect(ssd, w->y, w->x, w->largura, w->altura, true, false);
+    }
+    break;
+
+  case WIDGET_BORDA:
+    ssd1306_rect(ssd, w->y, w->x, w->largura, w->altura, w->visivel, false);
+    break;
+
+  case WIDGET_SPARKLINE:
+    break; // desenhado pelo próprio sparkline (ver compositor_atualizar)
+  }
+}
+
+/* === Envio por diferença === */
+
+// Envia um trecho de uma página e atualiza a sombra
+static uint16_t envia_trecho(compositor_t *c, uint8_t p, uint8_t x0, uint8_t x1)
+{
+  ssd1306_t *ssd = c->ssd;
+  ssd1306_send_region(ssd, x0, x1, p, p);
+  for (uint x = x0; x <= x1; x++)
+  {
+    size_t i = SSD1306_INDICE(x, p);
+    c->sombra[i] = ssd->ram_buffer[i];
+  }
+  return x1 - x0 + 1;
+}
+
+static uint16_t envia_diferencas(compositor_t *c)
+{
+  ssd1306_t *ssd = c->ssd;
+  uint16_t enviados = 0;
+
+  // Conteúdo do painel desconhecido: um quadro inteiro numa transação sai mais barato que trechos
+  if (c->painel_incerto)
+  {
+    ssd1306_send_data(ssd);
+    memcpy(c->sombra, ssd->ram_buffer, SSD1306_BUFSIZE);
+    c->painel_incerto = false;
+    return WIDTH * SSD1306_PAGES;
+  }
+
+  // Por página, trechos de colunas diferentes; lacunas curtas vão junto, pois
+  // reenviar alguns bytes custa menos que os comandos de uma nova janela
+  for (uint8_t p = 0; p < SSD1306_PAGES; p++)
+  {
+    int x0 = -1, x1 = -1;
+    for (uint8_t x = 0; x < WIDTH; x++)
+    {
+      size_t i = SSD1306_INDICE(x, p);
+      if (ssd->ram_buffer[i] == c->sombra[i])
+        continue;
+      if (x0 >= 0 && x - x1 > COMPOSITOR_LACUNA)
+      {
+        enviados += envia_trecho(c, p, (uint8_t)x0, (uint8_t)x1);
+        x0 = -1;
+      }
+      if (x0 < 0)
+        x0 = x;
+      x1 = x;
+    }
+    if (x0 >= 0)
+      enviados += envia_trecho(c, p, (uint8_t)x0, (uint8_t)x1);
+  }
+  return enviados;
+}
+
+/* === Compositor === */
+
+void compositor_init(compositor_t *c, ssd1306_t *ssd)
+{
+  c->ssd = ssd;
+  memset(c->sombra, 0, sizeof(c->sombra));
+  c->pagina = NULL;
+  c->desenho_us = 0;
+  c->painel_incerto = true;
+}
+
+void compositor_pagina(compositor_t *c, const pagina_t *pagina)
+{
+  ssd1306_fill(c->ssd, false);
+  c->pagina = pagina;
+
+  for (uint8_t i = 0; i < pagina->total; i++)
+  {
+    widget_t *w = &pagina->widgets[i];
+    w->sujo = true;
+    if (w->tipo == WIDGET_SPARKLINE)
+      sparkline_redesenhar(w->spark, c->ssd, w->hist);
+  }
+}
+
+void compositor_invalidar(compositor_t *c)
+{
+  c->painel_incerto = true;
+  if (c->pagina)
+    compositor_pagina(c, c->pagina);
+}
+
+uint16_t compositor_atualizar(compositor_t *c)
+{
+  const pagina_t *pg = c->pagina;
+  if (pg == NULL)
+    return 0;
+
+  // Widgets sujos; as bordas são refeitas no fim caso algo tenha apagado um trecho delas
+  uint32_t inicio = time_us_32();
+  bool desenhou = false;
+  for (uint8_t i = 0; i < pg->total; i++)
+  {
+    widget_t *w = &pg->widgets[i];
+    if (w->tipo == WIDGET_SPARKLINE)
+    {
+      desenhou |= sparkline_atualizar(w->spark, c->ssd, w->hist);
+      w->sujo = false;
+    }
+    else if (w->sujo && w->tipo != WIDGET_BORDA)
+    {
+      desenha(c->ssd, w);
+      w->sujo = false;
+      desenhou = true;
+    }
+  }
+  for (uint8_t i = 0; i < pg->total; i++)
+  {
+    widget_t *w = &pg->widgets[i];
+    if (w->tipo == WIDGET_BORDA && (w->sujo || (desenhou && w->visivel)))
+    {
+      desenha(c->ssd, w);
+      w->sujo = false;
+    }
+  }
+
+  c->desenho_us = time_us_32() - inicio;
+
+  return envia_diferencas(c);
+}
@@ -0,0 +1,109 @@
+#ifndef COMPOSITOR_H
+#define COMPOSITOR_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "ssd1306.h"
+#include "historico.h"
+#include "tendencia.h"
+
+// Camada de widgets retidos para o OLED. Cada widget guarda seus valores e sua
+// caixa delimitadora; mudar um valor só marca o widget como sujo, e apenas os
+// sujos são redesenhados no ram_buffer. Na hora de enviar, o buffer é comparado
+// com a sombra do que já está no painel e só os trechos diferentes de cada
+// página vão pela I2C, inclusive na troca de página. Bordas são refeitas por
+// último e não devem cruzar a caixa de outros widgets.
+
+typedef enum
+{
+  WIDGET_ROTULO,    // texto fixo ou trocado por ponteiro
+  WIDGET_VALOR,     // prefixo + número + sufixo
+  WIDGET_IMAGEM,    // colunas pré-rasterizadas (tools/rasterizar_rotulos.py)
+  WIDGET_BARRA,     // barra horizontal com contorno, 0..max
+  WIDGET_BORDA,     // contorno; 'visivel' liga e desliga
+  WIDGET_SPARKLINE, // gráfico de tendência (lib/tendencia.h)
+} widget_tipo_t;
+
+// Imagem de 8 pixels de altura em colunas, no layout do ram_buffer
+typedef struct
+{
+  const uint8_t *colunas;
+  uint8_t largura;
+} imagem_t;
+
+typedef struct
+{
+  widget_tipo_t tipo;
+  uint8_t x, y, largura, altura; // caixa em pixels (SPARKLINE: sem uso, vale a área do sparkline_t)
+  bool visivel;
+  bool sujo;
+  const char *texto;  // ROTULO: texto; VALOR: prefixo
+  const char *sufixo; // VALOR
+  const imagem_t *imagem; // IMAGEM
+  int32_t valor;      // VALOR e BARRA
+  int32_t max;        // BARRA
+  uint32_t escala;    // BARRA: largura/max em Q16, arredondada para cima (WIDGET_BARRA_EM)
+  sparkline_t *spark; // SPARKLINE
+  const historico_t *hist;
+} widget_t;
+
+// Inicializadores para tabelas constantes de widgets
+#define WIDGET_ROTULO_EM(x, y, larg, txt) {WIDGET_ROTULO, x, y, larg, 8, true, true, txt, NULL, NULL, 0, 0, 0, NULL, NULL}
+#define WIDGET_VALOR_EM(x, y, larg, pre, suf) {WIDGET_VALOR, x, y, larg, 8, true, true, pre, suf, NULL, 0, 0, 0, NULL, NULL}
+#define WIDGET_IMAGEM_EM(x, y, larg, img) {WIDGET_IMAGEM, x, y, larg, 8, true, true, NULL, NULL, img, 0, 0, 0, NULL, NULL}
+// BARRA: a escala é calculada na compilação. Com maximo < 65536 a barra cheia
+// ocupa a largura toda e nenhum valor erra por mais de uma coluna; com
+// maximo < 256 o resultado é igual ao de valor * largura / maximo.
+#define WIDGET_BARRA_EM(x, y, larg, alt, maximo)                                         \
+  {WIDGET_BARRA, x, y, larg, alt, true, true, NULL, NULL, NULL, 0, maximo,               \
+   (maximo) > 0 ? (((uint32_t)(larg) << 16) + (maximo) - 1) / (uint32_t)(maximo) : 0, NULL, NULL}
+#define WIDGET_BORDA_EM(x, y, larg, alt, vis) {WIDGET_BORDA, x, y, larg, alt, vis, true, NULL, NULL, NULL, 0, 0, 0, NULL, NULL}
+#define WIDGET_SPARKLINE_DE(s, h) {WIDGET_SPARKLINE, 0, 0, 0, 0, true, true, NULL, NULL, NULL, 0, 0, 0, s, h}
+
+typedef struct
+{
+  widget_t *widgets;
+  uint8_t total;
+} pagina_t;
+
+typedef struct
+{
+  ssd1306_t *ssd;
+  uint8_t sombra[SSD1306_BUFSIZE]; // conteúdo já enviado ao painel (mesmo layout do ram_buffer)
+  const pagina_t *pagina;
+  uint32_t desenho_us;   // redesenho dos sujos na última atualização (sem o envio)
+  bool painel_incerto;   // sombra não corresponde ao painel: o próximo envio é o quadro inteiro
+} compositor_t;
+
+// Alteram o valor retido e marcam o widget como sujo só se ele mudou
+void widget_texto(widget_t *w, const char *texto);
+void widget_imagem(widget_t *w, const imagem_t *imagem);
+void widget_valor(widget_t *w, int32_t valor);
+void widget_visivel(widget_t *w, bool visivel);
+
+/**
+ * Prepara a sombra. O conteúdo do painel é considerado desconhecido (pode ter
+ * ficado o quadro de antes do reinício): a primeira atualização envia o quadro
+ * inteiro, sem precisar de um quadro limpo antes.
+ */
+void compositor_init(compositor_t *c, ssd1306_t *ssd);
+
+/**
+ * Troca a página exibida: limpa o ram_buffer e marca todos os widgets da nova
+ * página como sujos. O que não mudar em relação ao painel não é reenviado.
+ */
+void compositor_pagina(compositor_t *c, const pagina_t *pagina);
+
+/**
+ * O conteúdo do painel ficou incerto (reconfiguração após falha na I2C):
+ * redesenha a página atual e envia o quadro inteiro na próxima atualização.
+ */
+void compositor_invalidar(compositor_t *c);
+
+/**
+ * Redesenha os widgets sujos da página atual e envia as diferenças. Retorna
+ * quantos bytes de imagem foram enviados.
+ */
+uint16_t compositor_atualizar(compositor_t *c);
+
+#endif
@@ -0,0 +1,286 @@
+#include "config.h"
+#include <stddef.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "pico/stdlib.h"
+#include "pico/flash.h"
+#include "hardware/flash.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "telemetria.h"
+#include "calibracao.h"
+
+#define CONFIG_FLASH_OFFSET (PICO_FLASH_SIZE_BYTES - FLASH_SECTOR_SIZE) // último setor
+#define CONFIG_LINHA_MAX 64
+#define CONFIG_PERIODO_MS 20 // varredura da entrada USB
+
+static config_t ativa;            // lida pelas tarefas via config_copiar
+static volatile uint32_t geracao; // incrementada a cada config_aplicar
+static config_t pendente;         // editada pelos comandos "set"
+
+static uint16_t config_crc(const config_t *cfg)
+{
+  return telemetria_crc16((const uint8_t *)cfg, offsetof(config_t, crc));
+}
+
+/* === Publicação atômica === */
+
+void config_init(void)
+{
+  const config_t *flash = (const config_t *)(XIP_BASE + CONFIG_FLASH_OFFSET);
+
+  if (config_valida(flash) && flash->crc == config_crc(flash))
+    ativa = *flash;
+  else
+    config_padrao(&ativa);
+
+  pendente = ativa;
+  geracao = 1;
+}
+
+uint32_t config_geracao(void)
+{
+  return geracao;
+}
+
+void config_copiar(config_t *destino)
+{
+  taskENTER_CRITICAL();
+  *destino = ativa;
+  taskEXIT_CRITICAL();
+}
+
+bool config_atualizar(config_t *local, uint32_t *visto)
+{
+  if (*visto == geracao)
+    return false;
+
+  taskENTER_CRITICAL();
+  *local = ativa;
+  *visto = geracao;
+  taskEXIT_CRITICAL();
+  return true;
+}
+
+bool config_aplicar(const config_t *nova)
+{
+  if (!config_valida(nova))
+    return false;
+
+  taskENTER_CRITICAL();
+  ativa = *nova;
+  ativa.crc = config_crc(&ativa);
+  geracao++;
+  taskEXIT_CRITICAL();
+  return true;
+}
+
+/* === Flash === */
+
+static void grava_setor(void *pagina)
+{
+  flash_range_erase(CONFIG_FLASH_OFFSET, FLASH_SECTOR_SIZE);
+  flash_range_program(CONFIG_FLASH_OFFSET, (const uint8_t *)pagina, FLASH_PAGE_SIZE);
+}
+
+bool config_salvar(void)
+{
+  static uint8_t pagina[FLASH_PAGE_SIZE];
+
+  memset(pagina, 0xFF, sizeof(pagina));
+  config_copiar((config_t *)pagina);
+
+  // flash_safe_execute pausa o escalonador e as interrupções enquanto o XIP está desligado
+  return flash_safe_execute(grava_setor, pagina, UINT32_MAX) == PICO_OK;
+}
+
+/* === Interpretador de comandos === */
+
+typedef enum
+{
+  CHAVE_U8,
+  CHAVE_U16,
+  CHAVE_COR
+} chave_tipo_t;
+
+typedef struct
+{
+  const char *nome;
+  uint8_t offset;
+  chave_tipo_t tipo;
+  uint16_t max; // limite superior (CHAVE_COR ignora)
+} chave_t;
+
+#define CHAVE(nome, campo, tipo, max) {nome, offsetof(config_t, campo), tipo, max}
+
+static const chave_t chaves[] = {
+  CHAVE("agua_enchente", agua_enchente, CHAVE_U8, 100),
+  CHAVE("chuva_enchente", chuva_enchente, CHAVE_U8, 100),
+  CHAVE("agua_alerta", agua_alerta, CHAVE_U8, 100),
+  CHAVE("chuva_alerta", chuva_alerta, CHAVE_U8, 100),
+  CHAVE("periodo_sensor_ms", periodo_sensor_ms, CHAVE_U16, 10000),
+  CHAVE("periodo_display_ms", periodo_display_ms, CHAVE_U16, 10000),
+  CHAVE("buzzer_hz", buzzer_hz, CHAVE_U16, 10000),
+  CHAVE("buzzer_alerta_on_ms", buzzer_on_ms[1], CHAVE_U16, 10000),
+  CHAVE("buzzer_alerta_off_ms", buzzer_off_ms[1], CHAVE_U16, 10000),
+  CHAVE("buzzer_enchente_on_ms", buzzer_on_ms[2], CHAVE_U16, 10000),
+  CHAVE("buzzer_enchente_off_ms", buzzer_off_ms[2], CHAVE_U16, 10000),
+  CHAVE("led_pwm_div", led_pwm_div, CHAVE_U8, 255),
+  CHAVE("matriz_brilho", matriz_brilho, CHAVE_U8, 255),
+  CHAVE("led_seguro", led_cor[0], CHAVE_COR, 0),
+  CHAVE("led_alerta", led_cor[1], CHAVE_COR, 0),
+  CHAVE("led_enchente", led_cor[2], CHAVE_COR, 0),
+  CHAVE("agua_offset", cal_offset[0], CHAVE_U16, CALIB_ADC_MAX),
+  CHAVE("agua_ganho_q12", cal_ganho_q12[0], CHAVE_U16, 65535),
+  CHAVE("agua_fundo_mm", cal_fundo_escala[0], CHAVE_U16, CALIB_FUNDO_MAX),
+  CHAVE("chuva_offset", cal_offset[1], CHAVE_U16, CALIB_ADC_MAX),
+  CHAVE("chuva_ganho_q12", cal_ganho_q12[1], CHAVE_U16, 65535),
+  CHAVE("chuva_fundo_mmh_x10", cal_fundo_escala[1], CHAVE_U16, CALIB_FUNDO_MAX),
+  CHAVE("alarme_silencio_s", alarme_silencio_s, CHAVE_U16, 36000),
+  CHAVE("alarme_limpeza_s", alarme_limpeza_s, CHAVE_U16, 3600),
+  CHAVE("alarme_subida_pct", alarme_subida_pct, CHAVE_U8, 100),
+  CHAVE("buzzer_escalado_on_ms", buzzer_escalado_on_ms, CHAVE_U16, 10000),
+  CHAVE("buzzer_escalado_off_ms", buzzer_escalado_off_ms, CHAVE_U16, 10000),
+};
+
+// Respostas viajam como registros de texto quando a USB está no modo binário
+static void responde(const char *fmt, ...)
+{
+  char linha[96];
+  va_list args;
+  va_start(args, fmt);
+  int n = vsnprintf(linha, sizeof(linha), fmt, args);
+  va_end(args);
+  if (n < 0)
+    return;
+  if (n >= (int)sizeof(linha))
+    n = sizeof(linha) - 1;
+
+#if TELEMETRIA_ATIVA
+  telemetria_registrar(TEL_TEXTO, linha, (uint8_t)n);
+#else
+  printf("%s\n", linha);
+#endif
+}
+
+static void mostra_chave(const chave_t *k, const config_t *cfg)
+{
+  const uint8_t *base = (const uint8_t *)cfg + k->offset;
+  switch (k->tipo)
+  {
+  case CHAVE_U8:
+    responde("%s=%u", k->nome, *base);
+    break;
+  case CHAVE_U16:
+    responde("%s=%u", k->nome, *(const uint16_t *)base);
+    break;
+  case CHAVE_COR:
+    responde("%s=0x%06lX", k->nome, (unsigned long)*(const uint32_t *)base);
+    break;
+  }
+}
+
+static bool altera_chave(const char *nome, const char *valor)
+{
+  for (size_t i = 0; i < sizeof(chaves) / sizeof(chaves[0]); i++)
+  {
+    const chave_t *k = &chaves[i];
+    if (strcmp(k->nome, nome) != 0)
+      continue;
+
+    char *fim;
+    unsigned long v = strtoul(valor, &fim, 0);
+    if (*fim != '\0' || (k->tipo != CHAVE_COR && v > k->max) || (k->tipo == CHAVE_COR && v > 0xFFFFFF))
+      return false;
+
+    uint8_t *base = (uint8_t *)&pendente + k->offset;
+    if (k->tipo == CHAVE_U8)
+      *base = (uint8_t)v;
+    else if (k->tipo == CHAVE_U16)
+      *(uint16_t *)base = (uint16_t)v;
+    else
+      *(uint32_t *)base = (uint32_t)v;
+    return true;
+  }
+  return false;
+}
+
+static void executa(char *linha)
+{
+  char *resto;
+  char *cmd = strtok_r(linha, " \t", &resto);
+  if (cmd == NULL)
+    return;
+
+  if (strcmp(cmd, "get") == 0)
+  {
+    for (size_t i = 0; i < sizeof(chaves) / sizeof(chaves[0]); i++)
+      mostra_chave(&chaves[i], &pendente);
+    responde("geracao=%lu", (unsigned long)geracao);
+  }
+  else if (strcmp(cmd, "set") == 0)
+  {
+    char *nome = strtok_r(NULL, " \t", &resto);
+    char *valor = strtok_r(NULL, " \t", &resto);
+    if (nome && valor && altera_chave(nome, valor))
+      responde("ok %s", nome);
+    else
+      responde("erro: set <chave> <valor>");
+  }
+  else if (strcmp(cmd, "aplicar") == 0 || strcmp(cmd, "salvar") == 0)
+  {
+    if (!config_aplicar(&pendente))
+    {
+      responde("erro: configuracao invalida");
+      return;
+    }
+    if (cmd[0] == 's' && !config_salvar())
+    {
+      responde("erro: falha ao gravar flash");
+      return;
+    }
+    responde("ok geracao=%lu", (unsigned long)geracao);
+  }
+  else if (strcmp(cmd, "padrao") == 0)
+  {
+    config_padrao(&pendente);
+    responde("ok padrao (use aplicar/salvar)");
+  }
+  else if (strcmp(cmd, "descartar") == 0)
+  {
+    config_copiar(&pendente);
+    responde("ok");
+  }
+  else
+  {
+    responde("erro: comando desconhecido '%s'", cmd);
+  }
+}
+
+void vConfigTask(void *params)
+{
+  char linha[CONFIG_LINHA_MAX];
+  size_t n = 0;
+
+  while (true)
+  {
+    int c;
+    while ((c = getchar_timeout_us(0)) != PICO_ERROR_TIMEOUT)
+    {
+      if (c == '\r' || c == '\n')
+      {
+        linha[n] = '\0';
+        if (n > 0)
+          executa(linha);
+        n = 0;
+      }
+      else if (n < sizeof(linha) - 1)
+      {
+        linha[n++] = (char)c;
+      }
+    }
+    vTaskDelay(pdMS_TO_TICKS(CONFIG_PERIODO_MS));
+  }
+}
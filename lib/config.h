@@ -0,0 +1,107 @@
+#ifndef CONFIG_H
+#define CONFIG_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Configuração de campo: limiares, períodos, padrões do buzzer/LED e brilho da matriz.
+// Guardada no último setor da flash com versão e CRC; carregada no boot e
+// alterável pela USB (ver vConfigTask). Estados indexados como alert_state_t:
+// 0 = SEGURO, 1 = ALERTA, 2 = ENCHENTE.
+
+#define CONFIG_MAGIC 0x47464347u // "GCFG"
+#define CONFIG_VERSAO 3
+#define CONFIG_ESTADOS 3
+#define CONFIG_BUZZER_FASE_MIN_MS 50 // menor fase liga/desliga: menor intervalo entre ativações da vBuzzerTask
+
+typedef struct
+{
+  uint32_t magic;
+  uint16_t versao;
+  uint16_t tamanho; // sizeof(config_t) quando gravada
+
+  // Limiares de classificação (%)
+  uint8_t agua_enchente, chuva_enchente;
+  uint8_t agua_alerta, chuva_alerta;
+
+  // Períodos das tarefas (ms)
+  uint16_t periodo_sensor_ms;
+  uint16_t periodo_display_ms;
+  uint16_t reservado_led; // era periodo_led_ms: a vLedRgbTask só acorda em mudanças (mantido pelo layout)
+
+  // Buzzer: frequência e padrão liga/desliga por estado (on = 0 mantém desligado)
+  uint16_t buzzer_hz;
+  uint16_t buzzer_on_ms[CONFIG_ESTADOS];
+  uint16_t buzzer_off_ms[CONFIG_ESTADOS];
+
+  // LED RGB: divisor do PWM (frequência = clk_sys / (div * 256)) e cor 0xRRGGBB por estado
+  uint8_t led_pwm_div;
+  uint8_t matriz_brilho; // nível 0–255 usado pelas animações
+  uint16_t reservado;
+  uint32_t led_cor[CONFIG_ESTADOS];
+
+  // Calibração por sensor: [0] = água, [1] = chuva (ver lib/calibracao.h)
+  uint16_t cal_offset[2];       // contagens do ADC
+  uint16_t cal_ganho_q12[2];    // 4096 = 1,0
+  uint16_t cal_fundo_escala[2]; // água em mm; chuva em 0,1 mm/h
+
+  // Gerenciador de alarme (ver lib/alarme.h) e padrão do buzzer escalado
+  uint16_t alarme_silencio_s;  // duração do reconhecimento pelo botão B
+  uint16_t alarme_limpeza_s;   // tempo em SEGURO para encerrar o alarme
+  uint16_t buzzer_escalado_on_ms;
+  uint16_t buzzer_escalado_off_ms;
+  uint8_t alarme_subida_pct;   // subida do nível após o reconhecimento que escala
+  uint8_t reservado2;
+
+  uint16_t crc; // CRC-16/CCITT-FALSE de todos os campos anteriores
+  uint16_t fim;
+} config_t;
+
+/**
+ * Carrega a configuração da flash; se ausente, de outra versão ou com CRC
+ * inválido, usa os valores padrão. Chamada uma vez em main().
+ */
+void config_init(void);
+
+/**
+ * Contador que muda a cada configuração aplicada. As tarefas guardam o último
+ * valor visto e recarregam a cópia local quando ele muda.
+ */
+uint32_t config_geracao(void);
+
+/**
+ * Copia a configuração ativa de forma atômica (todas as chaves da mesma versão).
+ */
+void config_copiar(config_t *destino);
+
+/**
+ * Se a geração mudou desde *geracao, atualiza a cópia local e retorna true.
+ */
+bool config_atualizar(config_t *local, uint32_t *geracao);
+
+/**
+ * Valida e publica uma nova configuração para todas as tarefas de uma vez.
+ */
+bool config_aplicar(const config_t *nova);
+
+// Funções puras (lib/config_padrao.c), usadas também pelo simulador da frota
+void config_padrao(config_t *cfg);
+bool config_valida(const config_t *cfg);
+
+/**
+ * Grava a configuração ativa na flash.
+ */
+bool config_salvar(void);
+
+/**
+ * Tarefa do interpretador de comandos de configuração pela USB:
+ *   get                      lista as chaves da configuração pendente
+ *   set <chave> <valor>      altera a configuração pendente
+ *   aplicar                  publica a pendente para as tarefas (atômico)
+ *   salvar                   aplica e grava na flash
+ *   padrao                   carrega os valores padrão na pendente
+ *   descartar                volta a pendente para a ativa
+ */
+void vConfigTask(void *params);
+
+#endif
@@ -0,0 +1,81 @@
+#include "config.h"
+#include <string.h>
+#include "calibracao.h"
+
+/* === Valores padrão e validação === */
+
+void config_padrao(config_t *cfg)
+{
+  memset(cfg, 0, sizeof(*cfg));
+  cfg->magic = CONFIG_MAGIC;
+  cfg->versao = CONFIG_VERSAO;
+  cfg->tamanho = sizeof(config_t);
+
+  cfg->agua_enchente = 70;
+  cfg->chuva_enchente = 80;
+  cfg->agua_alerta = 50;
+  cfg->chuva_alerta = 50;
+
+  cfg->periodo_sensor_ms = 100;
+  cfg->periodo_display_ms = 100;
+
+  cfg->buzzer_hz = 500;
+  cfg->buzzer_on_ms[0] = 0; // Seguro: silêncio
+  cfg->buzzer_off_ms[0] = 100;
+  cfg->buzzer_on_ms[1] = 500; // Alerta: beeps curtos
+  cfg->buzzer_off_ms[1] = 500;
+  cfg->buzzer_on_ms[2] = 200; // Enchente: beeps rápidos
+  cfg->buzzer_off_ms[2] = 200;
+
+  cfg->led_pwm_div = 100;
+  cfg->matriz_brilho = 100;
+  cfg->led_cor[0] = 0x00FF00; // Verde
+  cfg->led_cor[1] = 0xFFFF00; // Amarelo
+  cfg->led_cor[2] = 0xFF0000; // Vermelho
+
+  for (int i = 0; i < 2; i++)
+  {
+    cfg->cal_offset[i] = 0;
+    cfg->cal_ganho_q12[i] = CALIB_GANHO_UNITARIO;
+  }
+  cfg->cal_fundo_escala[0] = 2000; // régua de 2 m
+  cfg->cal_fundo_escala[1] = 1000; // 100,0 mm/h
+
+  cfg->alarme_silencio_s = 600; // 10 min
+  cfg->alarme_limpeza_s = 30;
+  cfg->alarme_subida_pct = 10;
+  cfg->buzzer_escalado_on_ms = 300; // Escalado: quase contínuo
+  cfg->buzzer_escalado_off_ms = 50;
+}
+
+// Padrão tocando (on > 0) com fases de pelo menos CONFIG_BUZZER_FASE_MIN_MS (off = 0: contínuo)
+static bool fases_validas(uint16_t on_ms, uint16_t off_ms)
+{
+  return on_ms == 0 || (on_ms >= CONFIG_BUZZER_FASE_MIN_MS && (off_ms == 0 || off_ms >= CONFIG_BUZZER_FASE_MIN_MS));
+}
+
+bool config_valida(const config_t *cfg)
+{
+  if (cfg->magic != CONFIG_MAGIC || cfg->versao != CONFIG_VERSAO || cfg->tamanho != sizeof(config_t))
+    return false;
+  if (cfg->agua_enchente > 100 || cfg->chuva_enchente > 100 ||
+      cfg->agua_alerta > cfg->agua_enchente || cfg->chuva_alerta > cfg->chuva_enchente)
+    return false;
+  if (cfg->periodo_sensor_ms < 10 || cfg->periodo_display_ms < 10)
+    return false;
+  if (cfg->buzzer_hz < 50 || cfg->buzzer_hz > 10000 || cfg->led_pwm_div == 0)
+    return false;
+  for (int i = 0; i < CONFIG_ESTADOS; i++)
+    if (!fases_validas(cfg->buzzer_on_ms[i], cfg->buzzer_off_ms[i]))
+      return false;
+  if (!fases_validas(cfg->buzzer_escalado_on_ms, cfg->buzzer_escalado_off_ms))
+    return false;
+  // Com zero o temporizador do silêncio ou da limpeza nunca seria armado
+  if (cfg->alarme_silencio_s == 0 || cfg->alarme_limpeza_s == 0 || cfg->alarme_subida_pct == 0 ||
+      cfg->alarme_subida_pct > 100)
+    return false;
+  for (int i = 0; i < 2; i++)
+    if (cfg->cal_ganho_q12[i] == 0 || cfg->cal_fundo_escala[i] > CALIB_FUNDO_MAX)
+      return false;
+  return true;
+}
@@ -0,0 +1,188 @@
+#include "efeito_rgb.h"
+#include "hardware/gpio.h"
+#include "hardware/pwm.h"
+#include "hardware/irq.h"
+#include "hardware/timer.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "perfil_xip.h"
+
+#define RGB_WRAP 1023         // 10 bits de resolução
+#define RGB_TIQUE_US 1024     // passo dos efeitos, fixo (não depende de led_pwm_div)
+#define RGB_MARGEM_US 8       // alvo mais perto que isso pode já ter passado ao ser escrito
+#define RGB_Q16 (1u << 16)
+#define RGB_ALFA_CHEIO (256u << 16) // alfa do crossfade em Q16 (256 = só o novo efeito)
+#define RGB_FASE_VOLTA (512u << 16) // respiração: 0–255 subindo, 256–511 descendo
+
+// Correção de gama 2,2: brilho linear de 8 bits -> nível de 10 bits
+static const uint16_t QUENTE(gama)[256] = { // lida a cada tique da interrupção
+     0,    0,    0,    0,    0,    0,    0,    0,    1,    1,    1,    1,    1,    1,    2,    2,
+     2,    3,    3,    3,    4,    4,    5,    5,    6,    6,    7,    7,    8,    9,    9,   10,
+    11,   11,   12,   13,   14,   15,   16,   16,   17,   18,   19,   20,   21,   23,   24,   25,
+    26,   27,   28,   30,   31,   32,   34,   35,   36,   38,   39,   41,   42,   44,   46,   47,
+    49,   51,   52,   54,   56,   58,   60,   61,   63,   65,   67,   69,   71,   73,   76,   78,
+    80,   82,   84,   87,   89,   91,   94,   96,   98,  101,  103,  106,  109,  111,  114,  117,
+   119,  122,  125,  128,  130,  133,  136,  139,  142,  145,  148,  151,  155,  158,  161,  164,
+   167,  171,  174,  177,  181,  184,  188,  191,  195,  198,  202,  206,  209,  213,  217,  221,
+   225,  228,  232,  236,  240,  244,  248,  252,  257,  261,  265,  269,  274,  278,  282,  287,
+   291,  295,  300,  304,  309,  314,  318,  323,  328,  333,  337,  342,  347,  352,  357,  362,
+   367,  372,  377,  382,  387,  393,  398,  403,  408,  414,  419,  425,  430,  436,  441,  447,
+   452,  458,  464,  470,  475,  481,  487,  493,  499,  505,  511,  517,  523,  529,  535,  542,
+   548,  554,  561,  567,  573,  580,  586,  593,  599,  606,  613,  619,  626,  633,  640,  647,
+   653,  660,  667,  674,  681,  689,  696,  703,  710,  717,  725,  732,  739,  747,  754,  762,
+   769,  777,  784,  792,  800,  807,  815,  823,  831,  839,  847,  855,  863,  871,  879,  887,
+   895,  903,  912,  920,  928,  937,  945,  954,  962,  971,  979,  988,  997, 1005, 1014, 1023,
+};
+
+typedef struct
+{
+  efeito_t efeito;
+  uint8_t cor[3];
+  uint32_t passo_fase; // respiração: avanço por tique em Q16
+  uint32_t passo_alfa; // crossfade: avanço por tique em Q16
+} pedido_t;
+
+static uint slice[3], canal[3];
+static int alarme_hw = -1; // alarme do timer reservado para o tique dos efeitos
+static uint32_t alvo_us;   // próximo disparo
+
+// Escrito pela tarefa em seção crítica, consumido pela interrupção
+static pedido_t pendente;
+static volatile bool tem_pendente;
+
+// Estado da interrupção
+static pedido_t atual;
+static uint32_t fase;       // respiração (Q16) ou tiques dentro do período do pisca
+static uint32_t alfa;       // progresso do crossfade
+static uint8_t saida[3];    // cor linear exibida (antes da gama)
+static uint8_t de[3];       // cor linear no início do crossfade
+static uint32_t ultimo_tique;
+
+static uint8_t QUENTE(brilho_efeito)(uint32_t dt)
+{
+  switch (atual.efeito.tipo)
+  {
+  case EFEITO_RESPIRAR:
+  {
+    fase = (fase + atual.passo_fase * dt) % RGB_FASE_VOLTA;
+    uint32_t f = fase >> 16;
+    return (uint8_t)(f < 256 ? f : 511 - f);
+  }
+  case EFEITO_PISCAR:
+    fase += dt;
+    if (fase >= atual.efeito.periodo_ms)
+      fase = 0;
+    return fase < atual.efeito.aceso_ms ? 255 : 0;
+  default:
+    return 255;
+  }
+}
+
+// Um passo de 'dt' tiques: troca de efeito pendente, crossfade e os três níveis
+static void QUENTE(avanca)(uint32_t dt)
+{
+  if (tem_pendente)
+  {
+    atual = pendente;
+    tem_pendente = false;
+    for (int c = 0; c < 3; c++)
+      de[c] = saida[c];
+    fase = 0;
+    alfa = 0;
+  }
+
+  uint8_t brilho = brilho_efeito(dt);
+  if (alfa < RGB_ALFA_CHEIO)
+  {
+    alfa += atual.passo_alfa * dt;
+    if (alfa > RGB_ALFA_CHEIO)
+      alfa = RGB_ALFA_CHEIO;
+  }
+
+  uint32_t a = alfa >> 16; // 0–256
+  for (int c = 0; c < 3; c++)
+  {
+    uint32_t alvo = (atual.cor[c] * (brilho + 1u)) >> 8;
+    saida[c] = (uint8_t)((de[c] * (256 - a) + alvo * a) >> 8);
+    pwm_set_chan_level(slice[c], canal[c], gama[saida[c]]);
+  }
+}
+
+// A cada 1,024 ms, por um alarme do timer reservado: inteira na SRAM, sem o
+// pool de alarmes do SDK (que está na flash)
+static void __isr QUENTE(tique_rgb)(void)
+{
+  PERFIL_XIP_INICIO(m);
+  timer_hw->intr = 1u << alarme_hw; // limpa o disparo
+
+  // Período fixo a partir do alvo anterior; se as interrupções ficaram
+  // bloqueadas além de um tique, recomeça a partir de agora
+  uint32_t agora = time_us_32();
+  alvo_us += RGB_TIQUE_US;
+  if ((int32_t)(alvo_us - agora) < RGB_MARGEM_US)
+    alvo_us = agora + RGB_TIQUE_US;
+  timer_hw->alarm[alarme_hw] = alvo_us;
+
+  uint32_t tique = agora >> 10;
+  uint32_t dt = tique - ultimo_tique;
+  if (dt > 0)
+  {
+    ultimo_tique = tique;
+    avanca(dt > 64 ? 64 : dt); // limita o avanço após longos trechos com interrupções bloqueadas
+  }
+  PERFIL_XIP_FIM(m, XIP_ISR_PWM);
+}
+
+void efeito_rgb_divisor(uint8_t clkdiv)
+{
+  // 4x a resolução antiga com o divisor 4x menor: mesma frequência de PWM.
+  // Só a portadora muda; o tique dos efeitos vem do timer.
+  for (int c = 0; c < 3; c++)
+    pwm_set_clkdiv(slice[c], clkdiv < 4 ? 1.f : clkdiv / 4.f);
+}
+
+void efeito_rgb_init(uint pino_r, uint pino_g, uint pino_b, uint8_t clkdiv)
+{
+  const uint pinos[3] = {pino_r, pino_g, pino_b};
+  for (int c = 0; c < 3; c++)
+  {
+    gpio_set_function(pinos[c], GPIO_FUNC_PWM);
+    slice[c] = pwm_gpio_to_slice_num(pinos[c]);
+    canal[c] = pwm_gpio_to_channel(pinos[c]);
+    pwm_set_wrap(slice[c], RGB_WRAP);
+    pwm_set_chan_level(slice[c], canal[c], 0); // LED desligado
+  }
+  efeito_rgb_divisor(clkdiv);
+
+  atual.efeito.tipo = EFEITO_FIXO;
+  atual.passo_alfa = RGB_ALFA_CHEIO;
+  ultimo_tique = time_us_32() >> 10;
+
+  for (int c = 0; c < 3; c++)
+    pwm_set_enabled(slice[c], true);
+
+  // O passo dos efeitos vem de um alarme do timer, não do wrap do PWM: com
+  // led_pwm_div 1–3 o wrap chegaria a cada 8,2 us
+  alarme_hw = hardware_alarm_claim_unused(true);
+  irq_set_exclusive_handler(TIMER_IRQ_0 + alarme_hw, tique_rgb);
+  hw_set_bits(&timer_hw->inte, 1u << alarme_hw);
+  irq_set_enabled(TIMER_IRQ_0 + alarme_hw, true);
+  alvo_us = time_us_32() + RGB_TIQUE_US;
+  timer_hw->alarm[alarme_hw] = alvo_us;
+}
+
+void efeito_rgb_trocar(const efeito_t *efeito, uint32_t cor, uint16_t fade_ms)
+{
+  pedido_t p;
+  p.efeito = *efeito;
+  p.cor[0] = (cor >> 16) & 0xFF;
+  p.cor[1] = (cor >> 8) & 0xFF;
+  p.cor[2] = cor & 0xFF;
+  p.passo_fase = efeito->periodo_ms ? RGB_FASE_VOLTA / efeito->periodo_ms : 0;
+  p.passo_alfa = fade_ms ? RGB_ALFA_CHEIO / fade_ms : RGB_ALFA_CHEIO;
+
+  taskENTER_CRITICAL(); // bloqueia o tique enquanto o pedido é copiado
+  pendente = p;
+  tem_pendente = true;
+  taskEXIT_CRITICAL();
+}
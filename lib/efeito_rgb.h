@@ -0,0 +1,43 @@
+#ifndef EFEITO_RGB_H
+#define EFEITO_RGB_H
+
+#include <stdint.h>
+#include "pico/stdlib.h"
+
+// Efeitos do LED RGB calculados numa interrupção de tique fixo (um alarme do
+// timer, a cada 1,024 ms): cor fixa, respiração e pisca, com correção de gama
+// e crossfade entre efeitos. A tarefa só chama efeito_rgb_trocar() quando o
+// estado muda; entre uma troca e outra nenhuma tarefa participa. O período da
+// interrupção não depende do divisor do PWM.
+
+typedef enum
+{
+  EFEITO_FIXO,     // cor constante
+  EFEITO_RESPIRAR, // sobe e desce de 0 a 100% em periodo_ms
+  EFEITO_PISCAR,   // acesa por aceso_ms a cada periodo_ms
+} efeito_tipo_t;
+
+typedef struct
+{
+  efeito_tipo_t tipo;
+  uint16_t periodo_ms;
+  uint16_t aceso_ms; // só EFEITO_PISCAR
+} efeito_t;
+
+/**
+ * Configura os três pinos como PWM (10 bits) e reserva um alarme do timer
+ * para o tique dos efeitos. 'clkdiv' é o divisor da configuração
+ * (led_pwm_div); a frequência do PWM é a mesma da resolução antiga de 8 bits.
+ */
+void efeito_rgb_init(uint pino_r, uint pino_g, uint pino_b, uint8_t clkdiv);
+
+// Troca só a frequência da portadora do PWM
+void efeito_rgb_divisor(uint8_t clkdiv);
+
+/**
+ * Passa a tocar 'efeito' na cor 0xRRGGBB, com crossfade de fade_ms a partir
+ * da cor exibida no momento. Divisões só aqui, fora da interrupção.
+ */
+void efeito_rgb_trocar(const efeito_t *efeito, uint32_t cor, uint16_t fade_ms);
+
+#endif
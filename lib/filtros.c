@@ -0,0 +1,186 @@
+#include "filtros.h"
+#include <math.h>
+
+#define Q15_UM 32767
+#define BIQUAD_FRAC 14
+
+static inline int16_t para_q15(uint16_t x)
+{
+  return (int16_t)((x > 4095 ? 4095 : x) << 3);
+}
+
+static inline uint16_t de_q15(int32_t y)
+{
+  if (y < 0)
+    return 0;
+  y = (y + 4) >> 3;
+  return y > 4095 ? 4095 : (uint16_t)y;
+}
+
+/* === Mediana móvel === */
+
+void filtro_mediana_init(filtro_mediana_t *f, uint8_t n)
+{
+  if (n > FILTRO_MEDIANA_MAX)
+    n = FILTRO_MEDIANA_MAX;
+  f->n = n ? n | 1 : 1; // ímpar: a mediana é uma amostra da janela
+  f->pos = 0;
+  f->iniciado = false;
+}
+
+uint16_t filtro_mediana(void *estado, uint16_t x)
+{
+  filtro_mediana_t *f = estado;
+  int16_t novo = para_q15(x);
+
+  if (!f->iniciado)
+  {
+    if (!(f->n & 1) || f->n > FILTRO_MEDIANA_MAX)
+      filtro_mediana_init(f, f->n);
+    for (uint8_t i = 0; i < f->n; i++)
+      f->anel[i] = f->ordenado[i] = novo;
+    f->iniciado = true;
+    return de_q15(novo);
+  }
+
+  // Troca a amostra mais antiga pela nova no lugar dela e reordena só em
+  // volta desse ponto: a janela já estava ordenada
+  int16_t velho = f->anel[f->pos];
+  f->anel[f->pos] = novo;
+  if (++f->pos == f->n)
+    f->pos = 0;
+
+  uint8_t i = 0;
+  while (f->ordenado[i] != velho)
+    i++;
+  while (i > 0 && f->ordenado[i - 1] > novo)
+  {
+    f->ordenado[i] = f->ordenado[i - 1];
+    i--;
+  }
+  while (i + 1 < f->n && f->ordenado[i + 1] < novo)
+  {
+    f->ordenado[i] = f->ordenado[i + 1];
+    i++;
+  }
+  f->ordenado[i] = novo;
+  return de_q15(f->ordenado[f->n >> 1]);
+}
+
+/* === Média exponencial === */
+
+void filtro_ema_q15_init(filtro_ema_q15_t *f, float alfa)
+{
+  int32_t a = (int32_t)(alfa * 32767.0f + 0.5f);
+  f->alfa = (int16_t)(a < 1 ? 1 : a > Q15_UM ? Q15_UM : a);
+  f->iniciado = false;
+}
+
+uint16_t filtro_ema_q15(void *estado, uint16_t x)
+{
+  filtro_ema_q15_t *f = estado;
+  int32_t alvo = para_q15(x);
+
+  if (!f->iniciado)
+  {
+    f->y = alvo << 15;
+    f->iniciado = true;
+  }
+  else
+  {
+    // (x - y) em Q15 cabe em 16 bits; vezes alfa Q15 cabe em 31
+    f->y += (alvo - (f->y >> 15)) * f->alfa;
+  }
+  return de_q15((f->y + (1 << 14)) >> 15);
+}
+
+/* === Biquad === */
+
+static int16_t q14(float c)
+{
+  return (int16_t)lroundf(c * (1 << BIQUAD_FRAC));
+}
+
+void filtro_biquad_passa_baixa(filtro_biquad_t *f, float fc_hz, float fs_hz)
+{
+  // Transformação bilinear (RBJ); o corte fica abaixo de Nyquist
+  if (fc_hz > 0.45f * fs_hz)
+    fc_hz = 0.45f * fs_hz;
+  float w0 = 2.0f * 3.14159265f * fc_hz / fs_hz;
+  float c = cosf(w0);
+  float alfa = sinf(w0) / (2.0f * 0.70710678f);
+  float a0 = 1.0f + alfa;
+
+  f->a1 = q14(-2.0f * c / a0);
+  f->a2 = q14((1.0f - alfa) / a0);
+  f->b0 = f->b2 = q14((1.0f - c) / 2.0f / a0);
+  // Ajusta b1 para que b0 + b1 + b2 = 1 + a1 + a2 nos inteiros: sem erro de
+  // regime, o nível parado sai igual ao medido
+  f->b1 = (int16_t)((1 << BIQUAD_FRAC) + f->a1 + f->a2 - 2 * f->b0);
+}
+
+uint16_t filtro_biquad(void *estado, uint16_t x)
+{
+  filtro_biquad_t *f = estado;
+  int16_t x0 = para_q15(x);
+
+  if (!f->iniciado)
+  {
+    // Regime permanente na primeira amostra
+    f->x1 = f->x2 = f->y1 = f->y2 = x0;
+    f->erro = 0;
+    f->iniciado = true;
+    return de_q15(x0);
+  }
+
+  // Com entrada 0..32760 e ganho DC 1 a soma fica em ~1,5e9 mesmo com polos
+  // perto de z = 1, dentro de 32 bits
+  int32_t acc = f->erro;
+  acc += (int32_t)f->b0 * x0 + (int32_t)f->b1 * f->x1 + (int32_t)f->b2 * f->x2;
+  acc -= (int32_t)f->a1 * f->y1 + (int32_t)f->a2 * f->y2;
+  f->erro = acc & ((1 << BIQUAD_FRAC) - 1);
+
+  int32_t y = acc >> BIQUAD_FRAC;
+  if (y < 0)
+    y = 0;
+  else if (y > Q15_UM)
+    y = Q15_UM;
+
+  f->x2 = f->x1;
+  f->x1 = x0;
+  f->y2 = f->y1;
+  f->y1 = (int16_t)y;
+  return de_q15(y);
+}
+
+/* === Bancada === */
+
+uint16_t filtros_sinal_teste(uint32_t i)
+{
+  // Triângulo de 0 a 4095 em 8192 amostras, ruído de ±16 e um pico a cada 97
+  uint32_t fase = i & 8191;
+  int32_t v = fase < 4096 ? (int32_t)fase : (int32_t)(8191 - fase);
+  uint32_t h = i * 2654435761u;
+  v += (int32_t)((h >> 27) & 31) - 16;
+  if (i % 97 == 0)
+    v = (h >> 16) & 1 ? 4095 : 0;
+  return v < 0 ? 0 : v > 4095 ? 4095 : (uint16_t)v;
+}
+
+#define BANCADA_BLOCO 128
+
+uint32_t filtros_bancada(sensor_filtro_fn fn, void *estado, uint32_t n, filtros_relogio_fn relogio)
+{
+  // O sinal é gerado antes, fora da medição
+  uint16_t bloco[BANCADA_BLOCO];
+  for (uint32_t i = 0; i < BANCADA_BLOCO; i++)
+    bloco[i] = filtros_sinal_teste(i);
+
+  volatile uint16_t sumidouro = 0; // impede que as chamadas sejam descartadas
+  uint32_t inicio = relogio();
+  for (uint32_t i = 0; i < n; i++)
+    sumidouro = fn(estado, bloco[i & (BANCADA_BLOCO - 1)]);
+  uint32_t gasto = relogio() - inicio;
+  (void)sumidouro;
+  return gasto;
+}
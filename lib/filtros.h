@@ -0,0 +1,84 @@
+#ifndef FILTROS_H
+#define FILTROS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "sensores.h"
+
+// Banco de filtros em ponto fixo Q15 para a cadeia de cada canal (sensor_desc_t).
+// Todos têm a assinatura de sensor_filtro_fn: recebem e devolvem a leitura
+// 0–4095, trabalham internamente em Q15 (x << 3), têm estado pré-alocado e
+// custo fixo por amostra. O estado começa na primeira amostra recebida, sem
+// transitório de partida a partir de zero.
+
+#define FILTRO_MEDIANA_MAX 9
+
+// Cadeia dos canais analógicos (vSensorTask e sim/frota.c): mediana contra
+// picos e depois suavização
+#define FILTRO_PADRAO_MEDIANA 5     // amostras (atraso de 2 períodos)
+#define FILTRO_PADRAO_ALFA 0.25f    // EMA da chuva
+#define FILTRO_PADRAO_CORTE_HZ 1.0f // biquad do nível de água
+
+// Mediana móvel de N (ímpar, até FILTRO_MEDIANA_MAX): descarta picos isolados
+// de até N/2 amostras. Janela ordenada mantida por inserção, O(N) com N fixo.
+typedef struct
+{
+  uint8_t n;
+  uint8_t pos;   // próxima posição do anel
+  bool iniciado;
+  int16_t anel[FILTRO_MEDIANA_MAX];     // amostras na ordem de chegada
+  int16_t ordenado[FILTRO_MEDIANA_MAX]; // a mesma janela em ordem crescente
+} filtro_mediana_t;
+
+#define FILTRO_MEDIANA(janela) {.n = (janela)}
+
+// Média exponencial com coeficiente Q15: y += alfa * (x - y). O acumulador
+// guarda 15 bits de fração, então o filtro não para a 1 LSB do alvo.
+typedef struct
+{
+  int16_t alfa; // Q15 (0 < alfa <= 32767)
+  bool iniciado;
+  int32_t y;    // Q30
+} filtro_ema_q15_t;
+
+#define FILTRO_EMA_Q15(a) {.alfa = (int16_t)((a) * 32767.0f)} // 0 < a <= 1
+
+// Biquad (forma direta I) com coeficientes Q14 e realimentação do erro de
+// truncamento, para não criar ciclos-limite com corte baixo.
+typedef struct
+{
+  int16_t b0, b1, b2, a1, a2; // Q14; a0 = 1
+  bool iniciado;
+  int16_t x1, x2, y1, y2;     // Q15
+  int32_t erro;               // resto do último deslocamento
+} filtro_biquad_t;
+
+void filtro_mediana_init(filtro_mediana_t *f, uint8_t n);
+void filtro_ema_q15_init(filtro_ema_q15_t *f, float alfa);
+
+/**
+ * Passa-baixas Butterworth de 2ª ordem (Q = 0,707) com corte 'fc_hz' para
+ * amostras a 'fs_hz'. Ganho DC exatamente 1 após a quantização. Pode ser
+ * chamada de novo quando o período de amostragem muda; o estado é mantido.
+ */
+void filtro_biquad_passa_baixa(filtro_biquad_t *f, float fc_hz, float fs_hz);
+
+uint16_t filtro_mediana(void *estado, uint16_t x);
+uint16_t filtro_ema_q15(void *estado, uint16_t x);
+uint16_t filtro_biquad(void *estado, uint16_t x);
+
+/* === Bancada === */
+
+// Relógio crescente da bancada: ciclos ou us no alvo, ns no host
+typedef uint32_t (*filtros_relogio_fn)(void);
+
+/**
+ * Passa 'n' amostras de um sinal de teste (rampa lenta com ruído e picos)
+ * pelo estágio e devolve o tempo gasto nas chamadas, na unidade de 'relogio'.
+ */
+uint32_t filtros_bancada(sensor_filtro_fn fn, void *estado, uint32_t n, filtros_relogio_fn relogio);
+
+// Amostra 'i' do sinal de teste da bancada (0–4095)
+uint16_t filtros_sinal_teste(uint32_t i);
+
+#endif
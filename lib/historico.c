@@ -0,0 +1,107 @@
+#include "historico.h"
+#include <string.h>
+#ifndef HISTORICO_HOST
+#include "FreeRTOS.h"
+#include "task.h"
+#define HIST_ENTRA() taskENTER_CRITICAL()
+#define HIST_SAI() taskEXIT_CRITICAL()
+#else
+#define HIST_ENTRA()
+#define HIST_SAI()
+#endif
+
+static void anel_init(hist_anel_t *a, uint16_t (*dados)[HIST_CANAIS], uint16_t tamanho, uint8_t fator)
+{
+  a->dados = dados;
+  a->tamanho = tamanho;
+  a->cabeca = 0;
+  a->total = 0;
+  a->contagem = 0;
+  a->fator = fator;
+  for (int c = 0; c < HIST_CANAIS; c++)
+    a->soma[c] = 0;
+}
+
+void historico_init(historico_t *h)
+{
+  memset(h, 0, sizeof(*h));
+  anel_init(&h->nivel[HIST_10HZ], h->buf_10hz, HIST_TAM_10HZ, HIST_FATOR_1HZ);
+  anel_init(&h->nivel[HIST_1HZ], h->buf_1hz, HIST_TAM_1HZ, HIST_FATOR_1MIN);
+  anel_init(&h->nivel[HIST_1MIN], h->buf_1min, HIST_TAM_1MIN, 0);
+}
+
+// Grava uma amostra em um nível e, se o bloco fechou, propaga a média para cima.
+static void anel_gravar(historico_t *h, const uint16_t amostra[HIST_CANAIS])
+{
+  uint16_t valores[HIST_CANAIS];
+  memcpy(valores, amostra, sizeof(valores));
+
+  // Iterativo (e não recursivo) para manter a pilha da tarefa produtora pequena
+  for (int n = HIST_10HZ; n < HIST_NIVEIS; n++)
+  {
+    hist_anel_t *a = &h->nivel[n];
+
+    HIST_ENTRA();
+    for (int c = 0; c < HIST_CANAIS; c++)
+      a->dados[a->cabeca][c] = valores[c];
+    if (++a->cabeca == a->tamanho)
+      a->cabeca = 0;
+    a->total++;
+    HIST_SAI();
+
+    if (a->fator == 0)
+      return;
+
+    // Acumula para o nível seguinte; só divide quando o bloco completa
+    for (int c = 0; c < HIST_CANAIS; c++)
+      a->soma[c] += valores[c];
+    if (++a->contagem < a->fator)
+      return;
+
+    for (int c = 0; c < HIST_CANAIS; c++)
+    {
+      valores[c] = (uint16_t)((a->soma[c] + a->fator / 2) / a->fator);
+      a->soma[c] = 0;
+    }
+    a->contagem = 0;
+  }
+}
+
+void historico_registrar(historico_t *h, uint16_t agua, uint16_t chuva)
+{
+  const uint16_t amostra[HIST_CANAIS] = {agua, chuva};
+  anel_gravar(h, amostra);
+}
+
+uint32_t historico_total(const historico_t *h, hist_nivel_t nivel)
+{
+  return h->nivel[nivel].total;
+}
+
+size_t historico_copiar(const historico_t *h, hist_nivel_t nivel, hist_canal_t canal,
+                        uint16_t *dst, size_t n, uint32_t *total)
+{
+  const hist_anel_t *a = &h->nivel[nivel];
+
+  HIST_ENTRA();
+  size_t disponiveis = a->total < a->tamanho ? a->total : a->tamanho;
+  if (n > disponiveis)
+    n = disponiveis;
+
+  // Posição da mais antiga das n amostras pedidas
+  int32_t pos = (int32_t)a->cabeca - (int32_t)n;
+  if (pos < 0)
+    pos += a->tamanho;
+
+  for (size_t i = 0; i < n; i++)
+  {
+    dst[i] = a->dados[pos][canal];
+    if (++pos == a->tamanho)
+      pos = 0;
+  }
+  if (total)
+    *total = a->total;
+  HIST_SAI();
+
+  return n;
+}
@@ -0,0 +1,74 @@
+#ifndef HISTORICO_H
+#define HISTORICO_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Histórico em cascata: cada nível é alimentado pela média do nível anterior.
+//   HIST_10HZ : amostras brutas a 10 Hz durante 1 minuto
+//   HIST_1HZ  : médias de 10 amostras (1 Hz) durante 1 hora
+//   HIST_1MIN : médias de 60 amostras (1/min) durante 24 horas
+#define HIST_TAM_10HZ 600
+#define HIST_TAM_1HZ 3600
+#define HIST_TAM_1MIN 1440
+
+#define HIST_FATOR_1HZ 10  // amostras de 10 Hz por amostra de 1 Hz
+#define HIST_FATOR_1MIN 60 // amostras de 1 Hz por amostra de 1/min
+
+typedef enum
+{
+  HIST_AGUA,
+  HIST_CHUVA,
+  HIST_CANAIS
+} hist_canal_t;
+
+typedef enum
+{
+  HIST_10HZ,
+  HIST_1HZ,
+  HIST_1MIN,
+  HIST_NIVEIS
+} hist_nivel_t;
+
+// Buffer circular de um nível, com acumulador incremental para o nível seguinte.
+typedef struct
+{
+  uint16_t (*dados)[HIST_CANAIS]; // amostras intercaladas por canal
+  uint16_t tamanho;               // capacidade em amostras
+  uint16_t cabeca;                // próxima posição de escrita
+  uint32_t total;                 // amostras já gravadas (monotônico)
+  uint32_t soma[HIST_CANAIS];     // soma parcial para o próximo nível
+  uint8_t contagem;               // amostras na soma parcial
+  uint8_t fator;                  // amostras por saída do nível seguinte (0 = último nível)
+} hist_anel_t;
+
+typedef struct
+{
+  hist_anel_t nivel[HIST_NIVEIS];
+  uint16_t buf_10hz[HIST_TAM_10HZ][HIST_CANAIS];
+  uint16_t buf_1hz[HIST_TAM_1HZ][HIST_CANAIS];
+  uint16_t buf_1min[HIST_TAM_1MIN][HIST_CANAIS];
+} historico_t;
+
+void historico_init(historico_t *h);
+
+/**
+ * Registra uma amostra de 10 Hz. Os níveis superiores são atualizados apenas
+ * quando o nível inferior completa um bloco, sem varrer os buffers.
+ */
+void historico_registrar(historico_t *h, uint16_t agua, uint16_t chuva);
+
+/**
+ * Total de amostras já gravadas em um nível (usado para detectar novas amostras).
+ */
+uint32_t historico_total(const historico_t *h, hist_nivel_t nivel);
+
+/**
+ * Copia as n amostras mais recentes de um canal para dst (da mais antiga para a
+ * mais recente). Retorna quantas foram copiadas e, em *total, o total do nível
+ * no instante da cópia.
+ */
+size_t historico_copiar(const historico_t *h, hist_nivel_t nivel, hist_canal_t canal,
+                        uint16_t *dst, size_t n, uint32_t *total);
+
+#endif
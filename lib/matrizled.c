@@ -1,129 +1,148 @@
-#include "ws2818b.pio.h"
-#include <math.h> // Inclua a biblioteca para usar round()
-#include "pico/stdlib.h"
+#include "matrizled.h"
+#include "hardware/dma.h"
+#include "ws2818b.pio.h" // Biblioteca gerada pelo arquivo .pio durante compilação.
+#include "animador.h"    // Mapa da serpentina da matriz
+#include "perfil_xip.h"  // QUENTE: laços por LED na SRAM
 
 // funcionamento da mztriz de led---------------------------------------------------------------------------------------------
-//  Biblioteca gerada pelo arquivo .pio durante compilação.
 
-// Definição do número de LEDs e pino.
-#define LED_COUNT 25
-#define LED_PIN 7
+#define NP_FREQ_HZ 800000.f
+#define NP_US_POR_LED 30 // 24 bits a 1,25 us
+#define NP_RESET_US 100  // linha em nível baixo para travar o quadro (datasheet: > 50 us)
 
-// Definição de pixel GRB
-struct pixel_t
+// Offset do programa em cada bloco PIO (-1 = ainda não carregado)
+static int offset_programa[2] = {-1, -1};
+
+static bool reserva_sm(PIO pio, np_t *np)
 {
-  uint8_t G, R, B; // Três valores de 8-bits compõem um pixel.
-};
-typedef struct pixel_t pixel_t;
-typedef pixel_t npLED_t; // Mudança de nome de "struct pixel_t" para "npLED_t" por clareza.
-// Declaração do buffer de pixels que formam a matriz.
-npLED_t leds[LED_COUNT];
+  uint idx = pio_get_index(pio);
+  if (offset_programa[idx] < 0)
+  {
+    if (!pio_can_add_program(pio, &ws2818b_program))
+      return false;
+    offset_programa[idx] = pio_add_program(pio, &ws2818b_program);
+  }
+
+  int sm = pio_claim_unused_sm(pio, false);
+  if (sm < 0)
+    return false;
 
-// Variáveis para uso da máquina PIO.
-PIO np_pio;
-uint sm;
+  np->pio = pio;
+  np->sm = (uint)sm;
+  return true;
+}
 
 /**
- * Inicializa a máquina PIO para controle da matriz de LEDs.
+ * Inicializa a máquina PIO e o canal DMA da cadeia.
  */
-void npInit(uint pin)
+bool npInit(np_t *np, uint pin, npLED_t *leds, uint total)
 {
+  // Toma posse de uma máquina PIO, no pio0 ou no pio1.
+  if (!reserva_sm(pio0, np) && !reserva_sm(pio1, np))
+    return false;
 
-  // Cria programa PIO.
-  uint offset = pio_add_program(pio0, &ws2818b_program);
-  np_pio = pio0;
-
-  // Toma posse de uma máquina PIO.
-  sm = pio_claim_unused_sm(np_pio, false);
-  if (sm < 0)
-  {
-    np_pio = pio1;
-    sm = pio_claim_unused_sm(np_pio, true); // Se nenhuma máquina estiver livre, panic!
-  }
+  np->pin = pin;
+  np->total = total;
+  np->leds = leds;
+  np->livre_us = 0;
 
   // Inicia programa na máquina PIO obtida.
-  ws2818b_program_init(np_pio, sm, offset, LED_PIN, 800000.f);
+  ws2818b_program_init(np->pio, np->sm, offset_programa[pio_get_index(np->pio)], pin, NP_FREQ_HZ);
+
+  // Transferências de 8 bits direto do buffer GRB: o byte é replicado nas quatro
+  // faixas do barramento e a PIO (deslocamento à direita, autopull de 8 bits)
+  // consome o byte menos significativo, como fazia pio_sm_put_blocking(valor).
+  np->dma = dma_claim_unused_channel(true);
+  dma_channel_config c = dma_channel_get_default_config(np->dma);
+  channel_config_set_transfer_data_size(&c, DMA_SIZE_8);
+  channel_config_set_read_increment(&c, true);
+  channel_config_set_write_increment(&c, false);
+  channel_config_set_dreq(&c, pio_get_dreq(np->pio, np->sm, true));
+  dma_channel_configure(np->dma, &c, &np->pio->txf[np->sm], leds, total * sizeof(npLED_t), false);
 
   // Limpa buffer de pixels.
-  for (uint i = 0; i < LED_COUNT; ++i)
-  {
-    leds[i].R = 0;
-    leds[i].G = 0;
-    leds[i].B = 0;
-  }
+  npClear(np);
+  return true;
 }
 
 /**
  * Atribui uma cor RGB a um LED.
  */
-void npSetLED(const uint index, const uint8_t r, const uint8_t g, const uint8_t b)
+void QUENTE(npSetLED)(np_t *np, uint index, uint8_t r, uint8_t g, uint8_t b)
 {
-  leds[index].R = r;
-  leds[index].G = g;
-  leds[index].B = b;
+  np->leds[index].R = r;
+  np->leds[index].G = g;
+  np->leds[index].B = b;
 }
 
 /**
  * Limpa o buffer de pixels.
  */
-void npClear()
+void npClear(np_t *np)
+{
+  for (uint i = 0; i < np->total; ++i)
+    npSetLED(np, i, 0, 0, 0);
+}
+
+bool QUENTE(npOcupado)(const np_t *np)
+{
+  return dma_channel_is_busy(np->dma) || time_us_64() < np->livre_us;
+}
+
+void QUENTE(npWait)(np_t *np)
+{
+  dma_channel_wait_for_finish_blocking(np->dma);
+  while (time_us_64() < np->livre_us)
+    tight_loop_contents();
+}
+
+void npReiniciar(np_t *np)
 {
-  for (uint i = 0; i < LED_COUNT; ++i)
-    npSetLED(i, 0, 0, 0);
+  // Solta quem espera o DMA e recomeça o programa do início, com FIFO vazio
+  dma_channel_abort(np->dma);
+  pio_sm_set_enabled(np->pio, np->sm, false);
+  pio_sm_clear_fifos(np->pio, np->sm);
+  pio_sm_restart(np->pio, np->sm);
+  pio_sm_exec(np->pio, np->sm, pio_encode_jmp(offset_programa[pio_get_index(np->pio)]));
+  pio_sm_set_enabled(np->pio, np->sm, true);
+  np->livre_us = time_us_64() + NP_RESET_US;
 }
 
 /**
  * Escreve os dados do buffer nos LEDs.
  */
-void npWrite()
+void QUENTE(npWrite)(np_t *np)
 {
-  // Escreve cada dado de 8-bits dos pixels em sequência no buffer da máquina PIO.
-  for (uint i = 0; i < LED_COUNT; ++i)
-  {
-    pio_sm_put_blocking(np_pio, sm, (int)round(leds[i].G)); // Arredondamento para inteiro
-    pio_sm_put_blocking(np_pio, sm, (int)round(leds[i].R)); // Arredondamento para inteiro
-    pio_sm_put_blocking(np_pio, sm, (int)round(leds[i].B)); // Arredondamento para inteiro
-  }
-  sleep_us(100); // Espera 100us, sinal de RESET do datasheet.
+  npWait(np);
+  np->livre_us = time_us_64() + np->total * NP_US_POR_LED + NP_RESET_US;
+  dma_channel_set_read_addr(np->dma, np->leds, false);
+  dma_channel_set_trans_count(np->dma, np->total * sizeof(npLED_t), true);
 }
 
 // Modificado do github: https://github.com/BitDogLab/BitDogLab-C/tree/main/neopixel_pio
 // Função para converter a posição do matriz para uma posição do vetor.
-int getIndex(int x, int y)
+// A serpentina (linhas pares da esquerda para a direita, ímpares da direita para a
+// esquerda) fica pré-calculada em anim_mapa_serpentina, sem divisão por pixel.
+int QUENTE(getIndex)(int x, int y)
 {
-  // Se a linha for par (0, 2, 4), percorremos da esquerda para a direita.
-  // Se a linha for ímpar (1, 3), percorremos da direita para a esquerda.
-  if (y % 2 == 0)
-  {
-    return 24 - (y * 5 + x); // Linha par (esquerda para direita).
-  }
-  else
-  {
-    return 24 - (y * 5 + (4 - x)); // Linha ímpar (direita para esquerda).
-  }
+  return anim_mapa_serpentina[y][x];
 }
 
-
-
-void desenhaSprite(int matriz[5][5][3], float intensidade)
+void desenhaSprite(np_t *np, int matriz[5][5][3], float intensidade)
 {
   for (int linha = 0; linha < 5; linha++)
   {
     for (int coluna = 0; coluna < 5; coluna++)
     {
       int posicao = getIndex(linha, coluna);
-      
+
       // Converta o resultado da multiplicação explicitamente para int
-      int r = (int)(matriz[coluna][linha][0]*intensidade);
-      int g = (int)(matriz[coluna][linha][1] *intensidade);
-      int b = (int)(matriz[coluna][linha][2] *intensidade);
+      int r = (int)(matriz[coluna][linha][0] * intensidade);
+      int g = (int)(matriz[coluna][linha][1] * intensidade);
+      int b = (int)(matriz[coluna][linha][2] * intensidade);
 
-        
       // Configure o LED
-      npSetLED(posicao, r, g, b);
-
-      // Exiba os valores para depuração
-    
+      npSetLED(np, posicao, r, g, b);
     }
   }
-}
\ No newline at end of file
+}
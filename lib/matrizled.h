@@ -0,0 +1,77 @@
+#ifndef MATRIZLED_H
+#define MATRIZLED_H
+
+#include "pico/stdlib.h"
+#include "hardware/pio.h"
+
+// Driver de cadeias WS2812B por instância: cada cadeia tem sua máquina PIO,
+// seu pino, seu buffer e seu canal DMA, com atualização independente. Vale
+// tanto para a matriz 5x5 da placa quanto para painéis externos maiores.
+
+// Definição de pixel GRB (ordem enviada na linha)
+struct pixel_t
+{
+  uint8_t G, R, B; // Três valores de 8-bits compõem um pixel.
+};
+typedef struct pixel_t pixel_t;
+typedef pixel_t npLED_t; // Mudança de nome de "struct pixel_t" para "npLED_t" por clareza.
+
+typedef struct
+{
+  PIO pio;
+  uint sm;
+  uint pin;
+  uint total;        // LEDs na cadeia
+  npLED_t *leds;     // buffer do chamador com 'total' pixels
+  int dma;           // canal que copia o buffer para o FIFO da PIO
+  uint64_t livre_us; // fim previsto do quadro em curso, incluindo o reset
+} np_t;
+
+/**
+ * Reserva uma máquina PIO (pio0, senão pio1) e um canal DMA para a cadeia no
+ * pino 'pin'. O programa PIO é carregado uma vez por bloco. Retorna false se
+ * não houver máquina livre. Chamar antes do escalonador ou de uma única tarefa.
+ */
+bool npInit(np_t *np, uint pin, npLED_t *leds, uint total);
+
+/**
+ * Atribui uma cor RGB a um LED.
+ */
+void npSetLED(np_t *np, uint index, uint8_t r, uint8_t g, uint8_t b);
+
+/**
+ * Limpa o buffer de pixels.
+ */
+void npClear(np_t *np);
+
+/**
+ * Inicia o envio do buffer por DMA e retorna sem esperar. Se o quadro anterior
+ * ainda estiver na linha, espera ele e o reset terminarem antes.
+ */
+void npWrite(np_t *np);
+
+/**
+ * true enquanto o quadro em curso (ou o reset depois dele) não terminou:
+ * npWrite() esperaria e o buffer ainda não pode ser alterado. Não espera.
+ */
+bool npOcupado(const np_t *np);
+
+/**
+ * Espera o quadro em curso (e o reset) terminar; depois disso o buffer pode
+ * ser alterado sem corromper o envio.
+ */
+void npWait(np_t *np);
+
+/**
+ * Recuperação de uma cadeia travada: aborta o DMA e reinicia a máquina PIO
+ * (FIFO vazio, programa do início). O quadro em curso é perdido; quem estava
+ * em npWait() segue em frente.
+ */
+void npReiniciar(np_t *np);
+
+// Função para converter a posição do matriz para uma posição do vetor (matriz 5x5).
+int getIndex(int x, int y);
+
+void desenhaSprite(np_t *np, int matriz[5][5][3], float intensidade);
+
+#endif
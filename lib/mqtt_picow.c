@@ -0,0 +1,155 @@
+#include "mqtt_picow.h"
+#include <string.h>
+#include "pico/cyw43_arch.h"
+#include "lwip/apps/mqtt.h"
+#include "lwip/ip_addr.h"
+
+/* === Conexão === */
+
+// Espera exponencial entre tentativas; volta ao mínimo quando o broker aceita
+static void agenda(mqtt_picow_t *m, uint32_t agora_ms)
+{
+  m->proxima_ms = agora_ms + m->espera_ms;
+  m->espera_ms = m->espera_ms * 2 > MQTT_PICOW_ESPERA_MAX_MS ? MQTT_PICOW_ESPERA_MAX_MS : m->espera_ms * 2;
+}
+
+// Contexto da lwIP
+static void conexao_cb(mqtt_client_t *cliente, void *arg, mqtt_connection_status_t status)
+{
+  mqtt_picow_t *m = arg;
+  m->conectando = false;
+  if (status == MQTT_CONNECT_ACCEPTED)
+  {
+    m->espera_ms = MQTT_PICOW_ESPERA_MIN_MS;
+    m->conexoes++;
+    return;
+  }
+  // A lwIP descarta as publicações pendentes ao fechar, sem chamar o callback delas
+  for (int i = 0; i < MQTT_PICOW_VOO; i++)
+    if (m->voo[i].estado == VOO_ENVIADO)
+      m->voo[i].estado = VOO_LIVRE;
+}
+
+static void servir(void *ctx, uint32_t agora_ms)
+{
+  mqtt_picow_t *m = ctx;
+  bool vez = (int32_t)(agora_ms - m->proxima_ms) >= 0;
+
+  int link = cyw43_tcpip_link_status(&cyw43_state, CYW43_ITF_STA);
+  if (link != CYW43_LINK_UP)
+  {
+    // Associando ou esperando o DHCP: só tenta de novo se falhou ou caiu
+    if (vez && link != CYW43_LINK_JOIN && link != CYW43_LINK_NOIP)
+    {
+      cyw43_arch_wifi_connect_async(m->ssid, m->senha, CYW43_AUTH_WPA2_AES_PSK);
+      m->associacoes++;
+      agenda(m, agora_ms);
+    }
+    return;
+  }
+
+  cyw43_arch_lwip_begin();
+  bool conectado = mqtt_client_is_connected(m->cliente);
+  if (!conectado && !m->conectando && vez)
+  {
+    ip_addr_t ip;
+    struct mqtt_connect_client_info_t info = {
+        .client_id = m->cliente_id,
+        .keep_alive = MQTT_PICOW_KEEPALIVE_S,
+    };
+    if (ipaddr_aton(m->broker, &ip))
+      m->conectando = mqtt_client_connect(m->cliente, &ip, m->porta, conexao_cb, m, &info) == ERR_OK;
+    agenda(m, agora_ms);
+  }
+  cyw43_arch_lwip_end();
+}
+
+static bool conectado(void *ctx)
+{
+  mqtt_picow_t *m = ctx;
+  cyw43_arch_lwip_begin();
+  bool c = mqtt_client_is_connected(m->cliente);
+  cyw43_arch_lwip_end();
+  return c;
+}
+
+/* === Publicação === */
+
+// Contexto da lwIP
+static void publicado_cb(void *arg, err_t err)
+{
+  mqtt_voo_t *v = arg;
+  // Erro (tempo esgotado na lwIP): o publicador reenvia pelo próprio prazo
+  v->estado = err == ERR_OK ? VOO_CONFIRMADO : VOO_LIVRE;
+}
+
+static bool publicar(void *ctx, const char *topico, const uint8_t *dados, uint16_t n, uint16_t id, bool dup)
+{
+  mqtt_picow_t *m = ctx;
+  (void)dup; // a lwIP não expõe a flag DUP
+
+  mqtt_voo_t *v = NULL;
+  for (int i = 0; i < MQTT_PICOW_VOO && !v; i++)
+    if (m->voo[i].estado == VOO_LIVRE)
+      v = &m->voo[i];
+  if (!v)
+    return false;
+
+  cyw43_arch_lwip_begin();
+  v->id = id;
+  v->estado = VOO_ENVIADO;
+  err_t err = mqtt_publish(m->cliente, topico, dados, n, 1, 0, publicado_cb, v); // ERR_MEM: buffer de saída cheio
+  if (err != ERR_OK)
+    v->estado = VOO_LIVRE;
+  cyw43_arch_lwip_end();
+  return err == ERR_OK;
+}
+
+static uint16_t confirmacao(void *ctx)
+{
+  mqtt_picow_t *m = ctx;
+  uint16_t id = 0;
+  cyw43_arch_lwip_begin();
+  for (int i = 0; i < MQTT_PICOW_VOO && !id; i++)
+  {
+    if (m->voo[i].estado == VOO_CONFIRMADO)
+    {
+      id = m->voo[i].id;
+      m->voo[i].estado = VOO_LIVRE;
+    }
+  }
+  cyw43_arch_lwip_end();
+  return id;
+}
+
+/* === Inicialização === */
+
+bool mqtt_picow_init(mqtt_picow_t *m, const char *ssid, const char *senha, const char *broker, uint16_t porta,
+                     const char *cliente_id)
+{
+  memset(m, 0, sizeof(*m));
+  m->ssid = ssid;
+  m->senha = senha;
+  m->broker = broker;
+  m->porta = porta;
+  strncpy(m->cliente_id, cliente_id, sizeof(m->cliente_id) - 1);
+  m->espera_ms = MQTT_PICOW_ESPERA_MIN_MS;
+
+  if (cyw43_arch_init())
+    return false;
+  cyw43_arch_enable_sta_mode();
+
+  cyw43_arch_lwip_begin();
+  m->cliente = mqtt_client_new();
+  cyw43_arch_lwip_end();
+  return m->cliente != NULL;
+}
+
+void mqtt_picow_transporte(mqtt_picow_t *m, pub_transporte_t *t)
+{
+  t->servir = servir;
+  t->conectado = conectado;
+  t->publicar = publicar;
+  t->confirmacao = confirmacao;
+  t->ctx = m;
+}
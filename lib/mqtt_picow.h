@@ -0,0 +1,62 @@
+#ifndef MQTT_PICOW_H
+#define MQTT_PICOW_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "publicador.h"
+
+// Transporte do publicador (publicador.h) no Pico W: Wi-Fi do CYW43 e o
+// cliente MQTT da lwIP, no modo threadsafe_background (a pilha roda na
+// interrupção de baixa prioridade do CYW43, não numa tarefa). Nada aqui
+// bloqueia: associação e conexão são assíncronas, com nova tentativa em
+// espera exponencial, e a publicação só copia o lote para o buffer de saída
+// da lwIP (MQTT_OUTPUT_RINGBUF_SIZE em lwipopts.h).
+//
+// Limitações do cliente da lwIP: o broker é um IP (sem DNS) e a lwIP escolhe
+// o id do pacote e não marca DUP nos reenvios; quem consome descarta
+// repetidos pelo par (sessao, lote) do cabeçalho do lote.
+
+#define MQTT_PICOW_VOO 4               // publicações aguardando PUBACK (MQTT_REQ_MAX_IN_FLIGHT)
+#define MQTT_PICOW_ESPERA_MIN_MS 1000  // primeira nova tentativa de Wi-Fi ou broker
+#define MQTT_PICOW_ESPERA_MAX_MS 60000
+#define MQTT_PICOW_KEEPALIVE_S 60
+
+typedef enum
+{
+  VOO_LIVRE,
+  VOO_ENVIADO,    // entregue à lwIP, esperando PUBACK
+  VOO_CONFIRMADO, // PUBACK recebido, falta a tarefa ler
+} mqtt_voo_estado_t;
+
+// Argumento do callback da lwIP: liga o PUBACK ao id do publicador
+typedef struct
+{
+  volatile mqtt_voo_estado_t estado; // escrito também no contexto da lwIP
+  uint16_t id;
+} mqtt_voo_t;
+
+typedef struct
+{
+  const char *ssid, *senha, *broker;
+  uint16_t porta;
+  char cliente_id[24];
+  struct mqtt_client_s *cliente;
+  volatile bool conectando;
+  uint32_t proxima_ms; // próxima tentativa permitida
+  uint32_t espera_ms;  // espera exponencial atual
+  uint32_t associacoes, conexoes;
+  mqtt_voo_t voo[MQTT_PICOW_VOO];
+} mqtt_picow_t;
+
+/**
+ * Liga o CYW43 em modo estação e prepara o cliente MQTT. Chamar da tarefa do
+ * publicador, depois do escalonador iniciar (o firmware do CYW43 leva algumas
+ * centenas de ms para carregar). Retorna false se o rádio não iniciou.
+ */
+bool mqtt_picow_init(mqtt_picow_t *m, const char *ssid, const char *senha, const char *broker, uint16_t porta,
+                     const char *cliente_id);
+
+// Preenche 't' com as funções deste transporte sobre 'm'
+void mqtt_picow_transporte(mqtt_picow_t *m, pub_transporte_t *t);
+
+#endif
@@ -0,0 +1,103 @@
+#include "perfil_xip.h"
+#include "hardware/clocks.h"
+#include "hardware/irq.h"
+#include "hardware/structs/nvic.h"
+#include "hardware/structs/systick.h"
+#include "hardware/structs/xip_ctrl.h"
+#include "FreeRTOS.h"
+#include "task.h"
+
+const char *const XIP_NOME_ESTAGIO[] = {"sensores", "display", "matriz", "isr_pwm", "isr_gpio", "latencia", "lat_fria"};
+
+// A medição fica sempre na SRAM, com ou sem QUENTE_NA_RAM: não pode
+// disputar o cache com o código medido
+#define NA_RAM(nome) __not_in_flash_func(nome)
+
+#define SYSTICK_EXATO_US 500 // abaixo de meio período do tique, o SysTick dá o ciclo exato
+
+static xip_medida_t medidas[XIP_ESTAGIOS];
+static uint32_t mhz = 125;
+
+static int sonda_irq = -1;
+static xip_marca_t sonda;
+static volatile xip_estagio_t sonda_estagio;
+
+/* === Medição === */
+
+void NA_RAM(perfil_xip_inicio)(xip_marca_t *m)
+{
+  m->acessos = xip_ctrl_hw->ctr_acc;
+  m->acertos = xip_ctrl_hw->ctr_hit;
+  m->us = time_us_32();
+  m->cvr = systick_hw->cvr;
+}
+
+// SysTick conta para baixo e recarrega a cada tique: a diferença é exata
+// enquanto couber numa volta; trechos longos usam o timer de 1 us
+static uint32_t NA_RAM(ciclos_desde)(const xip_marca_t *m, uint32_t cvr, uint32_t us)
+{
+  if (us - m->us >= SYSTICK_EXATO_US)
+    return (us - m->us) * mhz;
+  return m->cvr >= cvr ? m->cvr - cvr : m->cvr + systick_hw->rvr + 1 - cvr;
+}
+
+void NA_RAM(perfil_xip_fim)(const xip_marca_t *m, xip_estagio_t estagio)
+{
+  uint32_t cvr = systick_hw->cvr;
+  uint32_t us = time_us_32();
+  uint32_t acessos = xip_ctrl_hw->ctr_acc;
+  uint32_t acertos = xip_ctrl_hw->ctr_hit;
+
+  xip_medida_t *e = &medidas[estagio];
+  uint32_t c = ciclos_desde(m, cvr, us);
+  e->chamadas++;
+  e->ciclos += c;
+  if (c > e->ciclos_max)
+    e->ciclos_max = c;
+  e->acessos += acessos - m->acessos;
+  e->acertos += acertos - m->acertos;
+}
+
+void perfil_xip_ler(xip_estagio_t estagio, xip_medida_t *m)
+{
+  taskENTER_CRITICAL(); // as interrupções também escrevem
+  *m = medidas[estagio];
+  taskEXIT_CRITICAL();
+}
+
+/* === Sonda de latência === */
+
+// Segue QUENTE_NA_RAM como os tratadores de verdade: a latência medida
+// inclui buscar o começo do tratador na flash quando ele está lá
+static void __isr QUENTE(sonda_tratador)(void)
+{
+  perfil_xip_fim(&sonda, sonda_estagio);
+}
+
+void perfil_xip_init(void)
+{
+  mhz = clock_get_hz(clk_sys) / 1000000;
+  sonda_irq = user_irq_claim_unused(false);
+  if (sonda_irq < 0)
+    return;
+  irq_set_exclusive_handler(sonda_irq, sonda_tratador);
+  irq_set_enabled(sonda_irq, true);
+}
+
+void NA_RAM(perfil_xip_sonda)(uint n)
+{
+  if (sonda_irq < 0)
+    return;
+  for (uint i = 0; i < n; i++)
+  {
+    bool fria = i & 1;
+    if (fria)
+    {
+      xip_ctrl_hw->flush = 1;
+      (void)xip_ctrl_hw->flush; // a leitura espera o esvaziamento terminar
+    }
+    sonda_estagio = fria ? XIP_LATENCIA_FRIA : XIP_LATENCIA;
+    perfil_xip_inicio(&sonda);
+    nvic_hw->ispr = 1u << sonda_irq; // direto no NVIC: irq_set_pending está na flash
+  }
+}
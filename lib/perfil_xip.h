@@ -0,0 +1,96 @@
+#ifndef PERFIL_XIP_H
+#define PERFIL_XIP_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "pico/stdlib.h"
+
+// Código quente na SRAM e perfil do cache XIP.
+//
+// O firmware roda direto da flash QSPI (XIP), atrás de um cache de 16 kB; uma
+// falta para o processador por dezenas de ciclos. Funções e tabelas marcadas
+// com QUENTE() vão para a seção .time_critical do linker do SDK, copiada para
+// a SRAM no boot. A lista é curta e curada: laços por pixel do OLED, por LED
+// da matriz e os tratadores de interrupção (ver README). Compilar com
+// QUENTE_NA_RAM=0 devolve tudo à flash, para o relatório de antes e depois.
+//
+// Com XIP_PERFIL=1, PERFIL_XIP_INICIO/FIM medem cada estágio em ciclos (pelo
+// SysTick do FreeRTOS, que conta o clk_sys) e pelos contadores de acesso e de
+// acerto do cache (CTR_ACC e CTR_HIT). Os contadores são globais: contam
+// também as interrupções que caírem dentro do estágio.
+
+#ifndef QUENTE_NA_RAM
+#define QUENTE_NA_RAM 1
+#endif
+#ifndef XIP_PERFIL
+#define XIP_PERFIL 0
+#endif
+#define XIP_PERFIL_MS 5000 // relatório dos estágios
+#define XIP_SONDAS 16      // medições de latência por relatório (metade com o cache vazio)
+
+// Uso: void QUENTE(nome)(...) e static const T QUENTE(tabela)[] (o SDK só existe no alvo)
+#if QUENTE_NA_RAM && defined(__time_critical_func)
+#define QUENTE(nome) __time_critical_func(nome)
+#else
+#define QUENTE(nome) nome
+#endif
+
+typedef enum
+{
+  XIP_SENSORES,      // leitura, filtros e calibração de uma amostra
+  XIP_DISPLAY,       // um quadro do OLED: redesenho e envio
+  XIP_MATRIZ,        // um quadro da matriz: animador e DMA
+  XIP_ISR_PWM,       // efeitos do LED RGB (tique do alarme, 1,024 ms)
+  XIP_ISR_GPIO,      // bordas dos botões
+  XIP_LATENCIA,      // interrupção pendente até o tratador, cache quente
+  XIP_LATENCIA_FRIA, // o mesmo logo depois de esvaziar o cache
+  XIP_ESTAGIOS
+} xip_estagio_t;
+
+typedef struct
+{
+  uint32_t cvr, us; // SysTick e timer no início
+  uint32_t acessos, acertos;
+} xip_marca_t;
+
+typedef struct
+{
+  uint32_t chamadas;
+  uint64_t ciclos; // soma (média = ciclos / chamadas)
+  uint32_t ciclos_max;
+  uint32_t acessos, acertos;
+} xip_medida_t;
+
+#if XIP_PERFIL
+#define PERFIL_XIP_INICIO(m) \
+  xip_marca_t m;             \
+  perfil_xip_inicio(&m)
+#define PERFIL_XIP_FIM(m, estagio) perfil_xip_fim(&m, estagio)
+#else
+#define PERFIL_XIP_INICIO(m) ((void)0)
+#define PERFIL_XIP_FIM(m, estagio) ((void)0)
+#endif
+
+/**
+ * Reserva uma interrupção livre para a sonda de latência. Chamar no main(),
+ * antes do escalonador.
+ */
+void perfil_xip_init(void);
+
+// Seguras em interrupção; cada estágio tem um só contexto que o mede
+void perfil_xip_inicio(xip_marca_t *m);
+void perfil_xip_fim(const xip_marca_t *m, xip_estagio_t estagio);
+
+/**
+ * Pende a interrupção da sonda 'n' vezes (as ímpares com o cache esvaziado
+ * antes) e registra os ciclos até a primeira instrução do tratador. Chamar
+ * de uma tarefa.
+ */
+void perfil_xip_sonda(uint n);
+
+// Cópia coerente das medidas acumuladas do estágio desde o boot
+void perfil_xip_ler(xip_estagio_t estagio, xip_medida_t *m);
+
+extern const char *const XIP_NOME_ESTAGIO[];
+
+#endif
@@ -0,0 +1,267 @@
+#include "publicador.h"
+#include <stdio.h>
+#include <string.h>
+
+#define CUSTO_MS (1000u / PUBLICADOR_DRENO_POR_S) // crédito gasto por publicação
+#define CREDITO_MAX (CUSTO_MS * PUBLICADOR_EM_VOO)
+
+static inline pub_lote_t *lote(publicador_t *p, uint8_t k)
+{
+  return &p->fila[(p->primeiro + k) % PUBLICADOR_FILA];
+}
+
+static pub_lote_t *aberto(publicador_t *p)
+{
+  if (p->total == 0)
+    return NULL;
+  pub_lote_t *l = lote(p, p->total - 1);
+  return l->estado == LOTE_ABERTO ? l : NULL;
+}
+
+static inline uint8_t *poe_u16(uint8_t *d, uint16_t v)
+{
+  d[0] = (uint8_t)v;
+  d[1] = (uint8_t)(v >> 8);
+  return d + 2;
+}
+
+static inline uint8_t *poe_u32(uint8_t *d, uint32_t v)
+{
+  return poe_u16(poe_u16(d, (uint16_t)v), (uint16_t)(v >> 16));
+}
+
+void publicador_init(publicador_t *p, const pub_transporte_t *transporte, const char *estacao, uint16_t sessao)
+{
+  memset(p, 0, sizeof(*p));
+  p->transporte = transporte;
+  p->sessao = sessao;
+  p->proximo_id = 1;
+  snprintf(p->topico, sizeof(p->topico), "guardachuvas/%s/lotes", estacao);
+}
+
+/* === Lotes === */
+
+static void retira_primeiro(publicador_t *p)
+{
+  p->primeiro = (p->primeiro + 1) % PUBLICADOR_FILA;
+  p->total--;
+}
+
+// Retira o lote k do meio da fila, mantendo a ordem dos mais novos
+static void retira(publicador_t *p, uint8_t k)
+{
+  if (k == 0)
+  {
+    retira_primeiro(p);
+    return;
+  }
+  for (; k + 1 < p->total; k++)
+    *lote(p, k) = *lote(p, k + 1);
+  p->total--;
+}
+
+static void fecha(publicador_t *p)
+{
+  pub_lote_t *l = aberto(p);
+  if (l && l->n > PUBLICADOR_CABECALHO)
+  {
+    l->estado = LOTE_PENDENTE;
+    p->stats.lotes++;
+  }
+}
+
+static pub_lote_t *abre(publicador_t *p, uint32_t t_ms)
+{
+  // Fila cheia: perde o lote de amostras mais antigo (ou um já confirmado). Os
+  // urgentes, com o início da enchente, só saem quando a fila inteira for deles.
+  // O PUBACK do descartado, se vier, é ignorado.
+  if (p->total == PUBLICADOR_FILA)
+  {
+    uint8_t k = 0;
+    while (k < p->total && lote(p, k)->urgente && lote(p, k)->estado != LOTE_CONFIRMADO)
+      k++;
+    if (k == p->total)
+      k = 0;
+    pub_lote_t *velho = lote(p, k);
+    if (velho->estado == LOTE_EM_VOO)
+      p->em_voo--;
+    if (velho->estado != LOTE_CONFIRMADO)
+      p->stats.descartados++;
+    retira(p, k);
+  }
+
+  pub_lote_t *l = lote(p, p->total++);
+  if (p->total > p->stats.fila_max)
+    p->stats.fila_max = p->total;
+
+  l->estado = LOTE_ABERTO;
+  l->dup = l->urgente = false;
+  l->id = 0;
+  l->inicio_ms = t_ms;
+  l->dados[0] = PUBLICADOR_VERSAO;
+  poe_u16(poe_u16(&l->dados[1], p->sessao), p->proximo_lote++);
+  l->n = PUBLICADOR_CABECALHO;
+  return l;
+}
+
+static void anexa(publicador_t *p, uint32_t t_ms, tel_tipo_t tipo, const uint8_t *dados, uint8_t tamanho)
+{
+  pub_lote_t *l = aberto(p);
+  if (l && l->n + 2u + tamanho > PUBLICADOR_LOTE_MAX)
+  {
+    fecha(p);
+    l = NULL;
+  }
+  if (!l)
+    l = abre(p, t_ms);
+
+  l->dados[l->n++] = (uint8_t)tipo;
+  l->dados[l->n++] = tamanho;
+  memcpy(&l->dados[l->n], dados, tamanho);
+  l->n += tamanho;
+}
+
+/* === Eventos === */
+
+void publicador_amostra(publicador_t *p, uint32_t t_ms, uint16_t agua, uint16_t chuva, uint16_t agua_mm,
+                        uint16_t chuva_mmh_x10)
+{
+  if (p->amostrou && t_ms - p->ultima_amostra_ms < PUBLICADOR_AMOSTRA_MS)
+    return;
+  p->amostrou = true;
+  p->ultima_amostra_ms = t_ms;
+
+  uint8_t r[12], *d = r;
+  d = poe_u32(d, t_ms);
+  d = poe_u16(d, agua);
+  d = poe_u16(d, chuva);
+  d = poe_u16(d, agua_mm);
+  poe_u16(d, chuva_mmh_x10);
+  anexa(p, t_ms, TEL_AMOSTRA, r, sizeof(r));
+}
+
+static void anexa_urgente(publicador_t *p, uint32_t t_ms, tel_tipo_t tipo, const uint8_t *r, uint8_t tamanho)
+{
+  anexa(p, t_ms, tipo, r, tamanho);
+  aberto(p)->urgente = true;
+  fecha(p);
+}
+
+void publicador_estado(publicador_t *p, uint32_t t_ms, uint8_t anterior, uint8_t novo)
+{
+  uint8_t r[6];
+  poe_u32(r, t_ms);
+  r[4] = anterior;
+  r[5] = novo;
+  anexa_urgente(p, t_ms, TEL_ESTADO, r, sizeof(r));
+}
+
+void publicador_alarme(publicador_t *p, uint32_t t_ms, uint8_t de, uint8_t para, uint8_t causa)
+{
+  uint8_t r[7];
+  poe_u32(r, t_ms);
+  r[4] = de;
+  r[5] = para;
+  r[6] = causa;
+  anexa_urgente(p, t_ms, TEL_ALARME, r, sizeof(r));
+}
+
+/* === Envio === */
+
+static void confirma(publicador_t *p, uint16_t id)
+{
+  for (uint8_t k = 0; k < p->total; k++)
+  {
+    pub_lote_t *l = lote(p, k);
+    if (l->estado == LOTE_EM_VOO && l->id == id)
+    {
+      l->estado = LOTE_CONFIRMADO;
+      p->em_voo--;
+      p->stats.confirmados++;
+      break;
+    }
+  }
+  while (p->total && lote(p, 0)->estado == LOTE_CONFIRMADO)
+    retira_primeiro(p);
+}
+
+static bool publica(publicador_t *p, pub_lote_t *l, uint32_t agora_ms)
+{
+  const pub_transporte_t *t = p->transporte;
+  // Reenvio na mesma sessão repete o id (com DUP); um PUBACK atrasado do primeiro envio ainda confirma
+  uint16_t id = l->id;
+  if (l->estado != LOTE_EM_VOO)
+  {
+    id = p->proximo_id++;
+    if (p->proximo_id == 0)
+      p->proximo_id = 1;
+  }
+
+  if (!t->publicar(t->ctx, p->topico, l->dados, l->n, id, l->dup))
+    return false;
+
+  if (l->estado != LOTE_EM_VOO)
+    p->em_voo++;
+  else
+    p->stats.reenvios++;
+  l->estado = LOTE_EM_VOO;
+  l->id = id;
+  l->dup = true;
+  l->inicio_ms = agora_ms;
+  p->credito_ms -= CUSTO_MS;
+  p->stats.publicados++;
+  return true;
+}
+
+void publicador_servir(publicador_t *p, uint32_t agora_ms)
+{
+  const pub_transporte_t *t = p->transporte;
+  t->servir(t->ctx, agora_ms);
+
+  pub_lote_t *a = aberto(p);
+  if (a && a->n > PUBLICADOR_CABECALHO && agora_ms - a->inicio_ms >= PUBLICADOR_LOTE_MS)
+    fecha(p);
+
+  uint32_t dt = agora_ms - p->servido_ms;
+  p->servido_ms = agora_ms;
+  p->credito_ms = p->credito_ms + dt > CREDITO_MAX ? CREDITO_MAX : p->credito_ms + dt;
+
+  if (!t->conectado(t->ctx))
+  {
+    // A sessão caiu com o que estava em voo: volta para a fila
+    for (uint8_t k = 0; k < p->total; k++)
+      if (lote(p, k)->estado == LOTE_EM_VOO)
+        lote(p, k)->estado = LOTE_PENDENTE;
+    p->em_voo = 0;
+    return;
+  }
+
+  uint16_t id;
+  while ((id = t->confirmacao(t->ctx)) != 0)
+    confirma(p, id);
+
+  // Reenvios vencidos primeiro, depois os urgentes e por fim as amostras, do mais antigo ao mais novo
+  for (uint8_t passo = 0; passo < 3; passo++)
+  {
+    for (uint8_t k = 0; k < p->total && p->credito_ms >= CUSTO_MS; k++)
+    {
+      pub_lote_t *l = lote(p, k);
+      bool vez;
+      if (passo == 0)
+        vez = l->estado == LOTE_EM_VOO && agora_ms - l->inicio_ms >= PUBLICADOR_REENVIO_MS;
+      else
+        vez = l->estado == LOTE_PENDENTE && l->urgente == (passo == 1) && p->em_voo < PUBLICADOR_EM_VOO;
+      if (vez && !publica(p, l, agora_ms))
+        return; // transporte sem espaço: tenta na próxima chamada
+    }
+  }
+}
+
+uint8_t publicador_fila(const publicador_t *p)
+{
+  uint8_t n = p->total;
+  if (n && p->fila[(p->primeiro + n - 1) % PUBLICADOR_FILA].estado == LOTE_ABERTO &&
+      p->fila[(p->primeiro + n - 1) % PUBLICADOR_FILA].n <= PUBLICADOR_CABECALHO)
+    n--;
+  return n;
+}
@@ -0,0 +1,114 @@
+#ifndef PUBLICADOR_H
+#define PUBLICADOR_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "telemetria.h"
+
+// Publicador de telemetria em lotes por MQTT (QoS 1) com fila de
+// armazenamento e reenvio enquanto a rede estiver fora.
+//
+// Lote (payload de uma publicação):
+//   [versao:1][sessao:u16][lote:u16][registros...]
+// Os registros têm o mesmo formato da telemetria USB ([tipo][tamanho][dados],
+// tipos TEL_AMOSTRA, TEL_ESTADO e TEL_ALARME de telemetria.h). QoS 1 entrega
+// pelo menos uma vez: quem consome descarta repetidos pelo par (sessao, lote);
+// 'sessao' é sorteada a cada boot.
+//
+// Puro: não conhece FreeRTOS nem a pilha de rede. A rede entra por um
+// pub_transporte_t (lwIP no Pico W em mqtt_picow.c, sockets POSIX no host em
+// sim/publicador.c) e o relógio pelo 'agora_ms' de cada chamada. Quem produz
+// amostras não chama o publicador direto: entrega eventos a uma fila que a
+// tarefa do publicador esvazia (ver GuardaChuvas.c).
+
+#define PUBLICADOR_VERSAO 1
+#define PUBLICADOR_LOTE_MAX 512     // bytes por publicação
+#define PUBLICADOR_FILA 16          // lotes guardados (fechados + o aberto)
+#define PUBLICADOR_CABECALHO 5
+
+#ifndef PUBLICADOR_AMOSTRA_MS
+#define PUBLICADOR_AMOSTRA_MS 1000  // uma amostra por segundo vai no lote
+#endif
+#ifndef PUBLICADOR_LOTE_MS
+#define PUBLICADOR_LOTE_MS 30000    // idade máxima do lote aberto
+#endif
+#define PUBLICADOR_EM_VOO 2         // publicações sem PUBACK ao mesmo tempo
+#define PUBLICADOR_DRENO_POR_S 2    // publicações por segundo ao esvaziar a fila
+#define PUBLICADOR_REENVIO_MS 10000 // sem PUBACK nesse prazo, publica de novo
+
+typedef struct
+{
+  // Conexão, reconexão e keep-alive; chamada a cada publicador_servir()
+  void (*servir)(void *ctx, uint32_t agora_ms);
+  bool (*conectado)(void *ctx);
+  // Entrega uma publicação QoS 1 sem bloquear; false se não coube agora
+  bool (*publicar)(void *ctx, const char *topico, const uint8_t *dados, uint16_t n, uint16_t id, bool dup);
+  // Próximo id confirmado por PUBACK, ou 0 se não há
+  uint16_t (*confirmacao)(void *ctx);
+  void *ctx;
+} pub_transporte_t;
+
+typedef enum
+{
+  LOTE_ABERTO,     // recebendo registros
+  LOTE_PENDENTE,   // fechado, esperando vez de publicar
+  LOTE_EM_VOO,     // publicado, esperando PUBACK
+  LOTE_CONFIRMADO, // PUBACK recebido; sai da fila quando chegar à frente
+} pub_lote_estado_t;
+
+typedef struct
+{
+  pub_lote_estado_t estado;
+  bool dup;            // já foi publicado uma vez
+  bool urgente;        // tem mudança de estado ou de alarme: sai antes das amostras
+  uint16_t id;         // id do pacote enquanto em voo
+  uint16_t n;
+  uint32_t inicio_ms;  // primeiro registro (aberto) ou envio (em voo)
+  uint8_t dados[PUBLICADOR_LOTE_MAX];
+} pub_lote_t;
+
+typedef struct
+{
+  uint32_t lotes;       // lotes fechados
+  uint32_t publicados;  // publicações entregues ao transporte (inclui reenvios)
+  uint32_t confirmados; // lotes retirados da fila por PUBACK
+  uint32_t reenvios;
+  uint32_t descartados; // lotes perdidos com a fila cheia
+  uint8_t fila_max;
+} pub_stats_t;
+
+typedef struct
+{
+  pub_lote_t fila[PUBLICADOR_FILA]; // anel em ordem de criação; o último é o aberto
+  uint8_t primeiro, total;
+  uint16_t sessao, proximo_lote, proximo_id;
+  uint32_t ultima_amostra_ms;
+  bool amostrou;
+  uint32_t credito_ms; // balde de fichas do dreno, em ms de crédito
+  uint32_t servido_ms;
+  uint8_t em_voo;
+  char topico[48];
+  const pub_transporte_t *transporte;
+  pub_stats_t stats;
+} publicador_t;
+
+void publicador_init(publicador_t *p, const pub_transporte_t *transporte, const char *estacao, uint16_t sessao);
+
+// Eventos (da tarefa do publicador). Uma mudança de estado ou de fase do
+// alarme fecha o lote na hora, para o alerta não esperar PUBLICADOR_LOTE_MS.
+void publicador_amostra(publicador_t *p, uint32_t t_ms, uint16_t agua, uint16_t chuva, uint16_t agua_mm,
+                        uint16_t chuva_mmh_x10);
+void publicador_estado(publicador_t *p, uint32_t t_ms, uint8_t anterior, uint8_t novo);
+void publicador_alarme(publicador_t *p, uint32_t t_ms, uint8_t de, uint8_t para, uint8_t causa);
+
+/**
+ * Fecha o lote vencido, processa os PUBACK e publica o que estiver pendente,
+ * respeitando PUBLICADOR_EM_VOO e PUBLICADOR_DRENO_POR_S. Com o transporte
+ * desconectado, o que estava em voo volta a pendente e será reenviado.
+ */
+void publicador_servir(publicador_t *p, uint32_t agora_ms);
+
+// Lotes na fila (inclui o aberto, se tiver registros)
+uint8_t publicador_fila(const publicador_t *p);
+
+#endif
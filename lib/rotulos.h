@@ -0,0 +1,42 @@
+// Gerado por tools/rasterizar_rotulos.py a partir de lib/font.h: não editar à mão
+#ifndef ROTULOS_H
+#define ROTULOS_H
+
+#include "compositor.h"
+
+// "Seguro"
+static const uint8_t ROTULO_SEGURO_COLUNAS[48] = {
+    0x26, 0x6F, 0x49, 0x49, 0x49, 0x7B, 0x32, 0x00,
+    0x38, 0x7C, 0x54, 0x54, 0x54, 0x5C, 0x18, 0x00,
+    0x98, 0xBC, 0xA4, 0xA4, 0xA4, 0xFC, 0x7C, 0x00,
+    0x3C, 0x7C, 0x40, 0x40, 0x40, 0x7C, 0x7C, 0x00,
+    0x7C, 0x7C, 0x04, 0x04, 0x04, 0x0C, 0x08, 0x00,
+    0x38, 0x7C, 0x44, 0x44, 0x44, 0x7C, 0x38, 0x00,
+};
+static const imagem_t ROTULO_SEGURO = {ROTULO_SEGURO_COLUNAS, 48};
+
+// "Alerta"
+static const uint8_t ROTULO_ALERTA_COLUNAS[48] = {
+    0x7C, 0x7E, 0x13, 0x11, 0x13, 0x7E, 0x7C, 0x00,
+    0x00, 0x00, 0x41, 0x7F, 0x7F, 0x40, 0x00, 0x00,
+    0x38, 0x7C, 0x54, 0x54, 0x54, 0x5C, 0x18, 0x00,
+    0x7C, 0x7C, 0x04, 0x04, 0x04, 0x0C, 0x08, 0x00,
+    0x00, 0x04, 0x04, 0x3F, 0x7F, 0x44, 0x44, 0x00,
+    0x20, 0x74, 0x54, 0x54, 0x54, 0x7C, 0x78, 0x00,
+};
+static const imagem_t ROTULO_ALERTA = {ROTULO_ALERTA_COLUNAS, 48};
+
+// "Enchente"
+static const uint8_t ROTULO_ENCHENTE_COLUNAS[64] = {
+    0x7F, 0x7F, 0x49, 0x49, 0x49, 0x41, 0x41, 0x00,
+    0x7C, 0x7C, 0x04, 0x04, 0x04, 0x7C, 0x78, 0x00,
+    0x38, 0x7C, 0x44, 0x44, 0x44, 0x6C, 0x28, 0x00,
+    0x7F, 0x7F, 0x04, 0x04, 0x04, 0x7C, 0x78, 0x00,
+    0x38, 0x7C, 0x54, 0x54, 0x54, 0x5C, 0x18, 0x00,
+    0x7C, 0x7C, 0x04, 0x04, 0x04, 0x7C, 0x78, 0x00,
+    0x00, 0x04, 0x04, 0x3F, 0x7F, 0x44, 0x44, 0x00,
+    0x38, 0x7C, 0x54, 0x54, 0x54, 0x5C, 0x18, 0x00,
+};
+static const imagem_t ROTULO_ENCHENTE = {ROTULO_ENCHENTE_COLUNAS, 64};
+
+#endif
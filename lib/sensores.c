@@ -0,0 +1,156 @@
+#include "sensores.h"
+#include <string.h>
+#include "pico/stdlib.h"
+#include "hardware/adc.h"
+#include "telemetria.h"
+
+#define ADC_GPIO_BASE 26    // ADC0 = GPIO26
+#define ADC_ENTRADA_TEMP 4
+
+// ADS1115: disparo único, ±4,096 V, 860 amostras/s, comparador desligado
+#define ADS1115_REG_CONVERSAO 0x00
+#define ADS1115_REG_CONFIG 0x01
+#define ADS1115_CONFIG(canal) (0x8000u | ((4u + (canal)) << 12) | (1u << 9) | (1u << 8) | (7u << 5) | 3u)
+#define ADS1115_TIMEOUT_US 2000
+#define ADS1115_TENTATIVAS 8 // conversão leva ~1,2 ms a 860 amostras/s
+
+// Temperatura interna: T = 27 - (V - 0,706) / 0,001721, em 0,1 °C
+#define TEMP_MV_27C 706
+#define TEMP_Q16_POR_MV 380805 // (10000 / 1721) em Q16
+
+void sensores_init(sensores_t *s)
+{
+  memset(s, 0, sizeof(*s));
+  adc_init();
+}
+
+int sensores_registrar(sensores_t *s, const sensor_desc_t *desc)
+{
+  if (s->total >= SENSORES_MAX)
+    return -1;
+
+  uint8_t id = s->total++;
+  s->desc[id] = desc;
+  s->proximo_ms[id] = 0;
+  calib_preparar(&s->cal[id], 0, CALIB_GANHO_UNITARIO, CALIB_ADC_MAX);
+
+  if (desc->fonte == SENSOR_ADC_INTERNO)
+    adc_gpio_init(ADC_GPIO_BASE + desc->canal);
+  else if (desc->fonte == SENSOR_TEMPERATURA)
+    adc_set_temp_sensor_enabled(true);
+  return id;
+}
+
+void sensores_calibrar(sensores_t *s, uint8_t id, uint16_t offset, uint16_t ganho_q12, uint16_t fundo_escala)
+{
+  if (id < s->total)
+    calib_preparar(&s->cal[id], offset, ganho_q12, fundo_escala);
+}
+
+/* === Fontes === */
+
+static bool le_adc(uint8_t entrada, uint16_t *valor)
+{
+  // No modo bruto o ADC roda contínuo em ADC0/ADC1 por DMA: usa o par mais
+  // recente do anel e não mexe nas demais entradas para não quebrar o round-robin
+  if (telemetria_bruto_ativo())
+  {
+    uint16_t adc0, adc1;
+    if (entrada > 1 || !telemetria_bruto_ultimo(&adc0, &adc1))
+      return false;
+    *valor = entrada == 0 ? adc0 : adc1;
+    return true;
+  }
+
+  adc_select_input(entrada);
+  *valor = adc_read();
+  return true;
+}
+
+static bool le_ads1115(const sensor_desc_t *d, uint16_t *valor)
+{
+  uint16_t config = ADS1115_CONFIG(d->canal);
+  uint8_t cmd[3] = {ADS1115_REG_CONFIG, config >> 8, config & 0xFF};
+  uint8_t r[2];
+
+  if (i2c_write_timeout_us(d->i2c, d->endereco, cmd, 3, false, ADS1115_TIMEOUT_US) != 3)
+    return false;
+
+  // Espera o bit OS voltar a 1 (conversão concluída)
+  int tentativas = ADS1115_TENTATIVAS;
+  do
+  {
+    sleep_us(200);
+    if (i2c_write_timeout_us(d->i2c, d->endereco, cmd, 1, true, ADS1115_TIMEOUT_US) != 1 ||
+        i2c_read_timeout_us(d->i2c, d->endereco, r, 2, false, ADS1115_TIMEOUT_US) != 2)
+      return false;
+  } while (!(r[0] & 0x80) && --tentativas);
+  if (!tentativas)
+    return false;
+
+  cmd[0] = ADS1115_REG_CONVERSAO;
+  if (i2c_write_timeout_us(d->i2c, d->endereco, cmd, 1, true, ADS1115_TIMEOUT_US) != 1 ||
+      i2c_read_timeout_us(d->i2c, d->endereco, r, 2, false, ADS1115_TIMEOUT_US) != 2)
+    return false;
+
+  // 16 bits com sinal em ±4,096 V; entradas unipolares viram 0–4095
+  int16_t v = (int16_t)((r[0] << 8) | r[1]);
+  *valor = v < 0 ? 0 : (uint16_t)(v >> 3);
+  return true;
+}
+
+static bool le_fonte(const sensor_desc_t *d, uint16_t *valor)
+{
+  switch (d->fonte)
+  {
+  case SENSOR_ADC_INTERNO:
+    return le_adc(d->canal, valor);
+  case SENSOR_TEMPERATURA:
+    return le_adc(ADC_ENTRADA_TEMP, valor);
+  case SENSOR_I2C_ADS1115:
+    return le_ads1115(d, valor);
+  }
+  return false;
+}
+
+/* === Leitura === */
+
+uint16_t sensores_ler(sensores_t *s, uint32_t agora_ms, sensores_amostra_t *a)
+{
+  a->t_ms = agora_ms;
+  a->atualizados = 0;
+
+  for (uint8_t id = 0; id < s->total; id++)
+  {
+    const sensor_desc_t *d = s->desc[id];
+    if ((int32_t)(agora_ms - s->proximo_ms[id]) < 0)
+      continue;
+
+    uint16_t x;
+    if (!le_fonte(d, &x))
+      continue;
+    s->proximo_ms[id] = agora_ms + d->periodo_ms;
+
+    for (uint8_t f = 0; f < d->num_filtros; f++)
+      x = d->filtros[f].fn(d->filtros[f].estado, x);
+    a->bruto[id] = x;
+
+    if (d->fonte == SENSOR_TEMPERATURA)
+    {
+      int32_t mv = ((int32_t)x * 3300) >> 12;
+      a->cal[id] = x;
+      a->pct[id] = calib_percentual(x);
+      a->eng[id] = 270 - (((mv - TEMP_MV_27C) * TEMP_Q16_POR_MV) >> 16);
+    }
+    else
+    {
+      calib_saida_t saida;
+      calib_converter(&s->cal[id], x, &saida);
+      a->cal[id] = saida.cal;
+      a->pct[id] = saida.pct;
+      a->eng[id] = saida.eng;
+    }
+    a->atualizados |= 1u << id;
+  }
+  return a->atualizados;
+}
@@ -0,0 +1,83 @@
+#ifndef SENSORES_H
+#define SENSORES_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "hardware/i2c.h"
+#include "calibracao.h"
+
+// Registro de canais de sensores. Cada canal é descrito por uma entrada
+// constante (fonte, período, filtros) e registrado uma vez no início da
+// vSensorTask; a leitura devolve todos os canais em um layout de vetores
+// (um vetor por grandeza, indexado pelo id do canal), de modo que um canal
+// novo (umidade do solo, régua do rio, bateria) é só mais uma descrição.
+
+#define SENSORES_MAX 16
+
+typedef enum
+{
+  SENSOR_ADC_INTERNO, // ADC0–ADC3 do RP2040 (GPIO26–29)
+  SENSOR_TEMPERATURA, // sensor de temperatura interno (entrada 4 do ADC)
+  SENSOR_I2C_ADS1115, // conversor externo ADS1115 (entradas AIN0–AIN3)
+} sensor_fonte_t;
+
+// Estágio de filtro aplicado à leitura bruta (0–4095) antes da calibração
+typedef uint16_t (*sensor_filtro_fn)(void *estado, uint16_t x);
+
+typedef struct
+{
+  sensor_filtro_fn fn;
+  void *estado;
+} sensor_filtro_t;
+
+typedef struct
+{
+  const char *nome;
+  sensor_fonte_t fonte;
+  uint8_t canal;          // entrada do ADC interno ou do conversor externo
+  uint8_t endereco;       // endereço I2C (só SENSOR_I2C_ADS1115)
+  i2c_inst_t *i2c;        // barramento já inicializado (só SENSOR_I2C_ADS1115)
+  uint16_t periodo_ms;    // intervalo entre leituras (0 = toda chamada)
+  const sensor_filtro_t *filtros;
+  uint8_t num_filtros;
+} sensor_desc_t;
+
+// Amostra de todos os canais. Canais fora do período mantêm o último valor;
+// 'atualizados' marca (bit = id) os que foram lidos nesta chamada.
+typedef struct
+{
+  uint32_t t_ms;
+  uint16_t atualizados;
+  uint16_t bruto[SENSORES_MAX]; // após os filtros (0–4095)
+  uint16_t cal[SENSORES_MAX];   // após offset e ganho (0–4095)
+  uint8_t pct[SENSORES_MAX];    // 0–100 %
+  int32_t eng[SENSORES_MAX];    // unidade de engenharia (temperatura: 0,1 °C)
+} sensores_amostra_t;
+
+typedef struct
+{
+  const sensor_desc_t *desc[SENSORES_MAX];
+  calib_canal_t cal[SENSORES_MAX];
+  uint32_t proximo_ms[SENSORES_MAX];
+  uint8_t total;
+} sensores_t;
+
+void sensores_init(sensores_t *s);
+
+/**
+ * Registra um canal e prepara seu hardware. Retorna o id (índice nos vetores
+ * da amostra) ou -1 se o registro estiver cheio. A calibração começa unitária
+ * com fundo de escala 4095.
+ */
+int sensores_registrar(sensores_t *s, const sensor_desc_t *desc);
+
+// Ver calib_preparar(); chamada quando a configuração muda
+void sensores_calibrar(sensores_t *s, uint8_t id, uint16_t offset, uint16_t ganho_q12, uint16_t fundo_escala);
+
+/**
+ * Lê os canais cujo período venceu, aplica filtros e calibração e atualiza
+ * a amostra. Retorna a máscara de canais lidos.
+ */
+uint16_t sensores_ler(sensores_t *s, uint32_t agora_ms, sensores_amostra_t *a);
+
+#endif
@@ -1,116 +1,184 @@
 #include "ssd1306.h"
+#include <string.h>
 #include "font.h"
+#include "perfil_xip.h"
 
-void ssd1306_init(ssd1306_t *ssd, uint8_t width, uint8_t height, bool external_vcc, uint8_t address, i2c_inst_t *i2c) {
-  ssd->width = width;
-  ssd->height = height;
-  ssd->pages = height / 8U;
+// Nenhuma escrita fica presa no barramento: cada byte tem um prazo e as
+// falhas só são contadas (ver ssd->falhas)
+#define SSD1306_TIMEOUT_BYTE_US 100 // um byte leva ~23 us a 400 kHz
+
+static void escreve(ssd1306_t *ssd, const uint8_t *dados, size_t n) {
+  int r = i2c_write_timeout_per_char_us(ssd->i2c_port, ssd->address, dados, n, false, SSD1306_TIMEOUT_BYTE_US);
+  if (r != (int)n)
+    ssd->falhas++;
+}
+
+void ssd1306_init(ssd1306_t *ssd, bool external_vcc, uint8_t address, i2c_inst_t *i2c) {
   ssd->address = address;
   ssd->i2c_port = i2c;
-  ssd->bufsize = ssd->pages * ssd->width + 1;
-  ssd->ram_buffer = calloc(ssd->bufsize, sizeof(uint8_t));
+  ssd->external_vcc = external_vcc;
+  memset(ssd->ram_buffer, 0, sizeof(ssd->ram_buffer));
   ssd->ram_buffer[0] = 0x40;
   ssd->port_buffer[0] = 0x80;
+  ssd->falhas = 0;
 }
 
+// Sequência de configuração, enviada numa única transação I2C (byte de
+// controle 0x00: todos os bytes seguintes são comandos). Começa com o painel
+// desligado e só liga no fim, com a RAM já endereçada.
+static const uint8_t CONFIGURACAO[] = {
+  0x00,
+  SET_DISP | 0x00,
+#ifndef SSD1306_SH1106
+  SET_MEM_ADDR, 0x01,
+#endif
+  SET_DISP_START_LINE | 0x00,
+  SET_SEG_REMAP | 0x01,
+  SET_MUX_RATIO, HEIGHT - 1,
+  SET_COM_OUT_DIR | 0x08,
+  SET_DISP_OFFSET, 0x00,
+  SET_COM_PIN_CFG, SSD1306_COM_PINS,
+  SET_DISP_CLK_DIV, 0x80,
+  SET_PRECHARGE, 0xF1,
+  SET_VCOM_DESEL, 0x30,
+  SET_CONTRAST, 0xFF,
+  SET_ENTIRE_ON,
+  SET_NORM_INV,
+#ifdef SSD1306_SH1106
+  0xAD, 0x8B, // conversor DC-DC do SH1106 ligado
+#else
+  SET_CHARGE_PUMP, 0x14,
+#endif
+  SET_DISP | 0x01,
+};
+
 void ssd1306_config(ssd1306_t *ssd) {
-  ssd1306_command(ssd, SET_DISP | 0x00);
-  ssd1306_command(ssd, SET_MEM_ADDR);
-  ssd1306_command(ssd, 0x01);
-  ssd1306_command(ssd, SET_DISP_START_LINE | 0x00);
-  ssd1306_command(ssd, SET_SEG_REMAP | 0x01);
-  ssd1306_command(ssd, SET_MUX_RATIO);
-  ssd1306_command(ssd, HEIGHT - 1);
-  ssd1306_command(ssd, SET_COM_OUT_DIR | 0x08);
-  ssd1306_command(ssd, SET_DISP_OFFSET);
-  ssd1306_command(ssd, 0x00);
-  ssd1306_command(ssd, SET_COM_PIN_CFG);
-  ssd1306_command(ssd, 0x12);
-  ssd1306_command(ssd, SET_DISP_CLK_DIV);
-  ssd1306_command(ssd, 0x80);
-  ssd1306_command(ssd, SET_PRECHARGE);
-  ssd1306_command(ssd, 0xF1);
-  ssd1306_command(ssd, SET_VCOM_DESEL);
-  ssd1306_command(ssd, 0x30);
-  ssd1306_command(ssd, SET_CONTRAST);
-  ssd1306_command(ssd, 0xFF);
-  ssd1306_command(ssd, SET_ENTIRE_ON);
-  ssd1306_command(ssd, SET_NORM_INV);
-  ssd1306_command(ssd, SET_CHARGE_PUMP);
-  ssd1306_command(ssd, 0x14);
-  ssd1306_command(ssd, SET_DISP | 0x01);
+  escreve(ssd, CONFIGURACAO, sizeof(CONFIGURACAO));
 }
 
 void ssd1306_command(ssd1306_t *ssd, uint8_t command) {
   ssd->port_buffer[1] = command;
-  i2c_write_blocking(
-    ssd->i2c_port,
-    ssd->address,
-    ssd->port_buffer,
-    2,
-    false
-  );
+  escreve(ssd, ssd->port_buffer, 2);
+}
+
+void ssd1306_commands(ssd1306_t *ssd, const uint8_t *commands, size_t n) {
+  uint8_t bloco[1 + SSD1306_COMANDOS_MAX];
+  if (n > SSD1306_COMANDOS_MAX)
+    n = SSD1306_COMANDOS_MAX;
+  bloco[0] = 0x00;
+  memcpy(&bloco[1], commands, n);
+  escreve(ssd, bloco, n + 1);
 }
 
 void ssd1306_send_data(ssd1306_t *ssd) {
-  ssd1306_command(ssd, SET_COL_ADDR);
-  ssd1306_command(ssd, 0);
-  ssd1306_command(ssd, ssd->width - 1);
-  ssd1306_command(ssd, SET_PAGE_ADDR);
-  ssd1306_command(ssd, 0);
-  ssd1306_command(ssd, ssd->pages - 1);
-  i2c_write_blocking(
-    ssd->i2c_port,
-    ssd->address,
-    ssd->ram_buffer,
-    ssd->bufsize,
-    false
-  );
-}
-
-void ssd1306_pixel(ssd1306_t *ssd, uint8_t x, uint8_t y, bool value) {
-  uint16_t index = (y >> 3) + (x << 3) + 1;
-  uint8_t pixel = (y & 0b111);
-  if (value)
-    ssd->ram_buffer[index] |= (1 << pixel);
-  else
-    ssd->ram_buffer[index] &= ~(1 << pixel);
+#ifdef SSD1306_SH1106
+  ssd1306_send_region(ssd, 0, WIDTH - 1, 0, SSD1306_PAGES - 1);
+#else
+  static const uint8_t JANELA[] = {SET_COL_ADDR, 0, WIDTH - 1, SET_PAGE_ADDR, 0, SSD1306_PAGES - 1};
+  ssd1306_commands(ssd, JANELA, sizeof(JANELA));
+  escreve(ssd, ssd->ram_buffer, SSD1306_BUFSIZE);
+#endif
 }
 
-/*
-void ssd1306_fill(ssd1306_t *ssd, bool value) {
-  uint8_t byte = value ? 0xFF : 0x00;
-  for (uint8_t i = 1; i < ssd->bufsize; ++i)
-    ssd->ram_buffer[i] = byte;
-}*/
+#define SSD1306_BLOCO_REGIAO 128
 
-void ssd1306_fill(ssd1306_t *ssd, bool value) {
-    // Itera por todas as posições do display
-    for (uint8_t y = 0; y < ssd->height; ++y) {
-        for (uint8_t x = 0; x < ssd->width; ++x) {
-            ssd1306_pixel(ssd, x, y, value);
-        }
+#ifdef SSD1306_SH1106
+// O SH1106 só tem endereçamento por página: cada página da janela começa com
+// uma transação de comandos (página e coluna inicial, já com o deslocamento
+// da RAM de 132 colunas) e os bytes dela são colhidos do buffer vertical.
+void ssd1306_send_region(ssd1306_t *ssd, uint8_t x0, uint8_t x1, uint8_t p0, uint8_t p1) {
+  uint8_t bloco[1 + SSD1306_BLOCO_REGIAO];
+  uint8_t coluna = x0 + SSD1306_COLUNA0;
+
+  bloco[0] = 0x40;
+  for (uint p = p0; p <= p1; ++p) {
+    uint8_t cmd[4] = {0x00, 0xB0 | p, coluna & 0x0F, 0x10 | (coluna >> 4)};
+    escreve(ssd, cmd, sizeof(cmd));
+
+    size_t n = 1;
+    for (uint x = x0; x <= x1; ++x) {
+      bloco[n++] = ssd->ram_buffer[SSD1306_INDICE(x, p)];
+      if (n == sizeof(bloco)) {
+        escreve(ssd, bloco, n);
+        n = 1;
+      }
+    }
+    if (n > 1)
+      escreve(ssd, bloco, n);
+  }
+}
+#else
+// Envia só as colunas x0..x1 das páginas p0..p1. No endereçamento vertical o
+// ponteiro do controlador avança página a página e depois coluna, e continua
+// entre transações: os bytes vão em blocos de até SSD1306_BLOCO_REGIAO.
+void ssd1306_send_region(ssd1306_t *ssd, uint8_t x0, uint8_t x1, uint8_t p0, uint8_t p1) {
+  uint8_t bloco[1 + SSD1306_BLOCO_REGIAO];
+  size_t n = 1;
+
+  const uint8_t janela[] = {SET_COL_ADDR, x0, x1, SET_PAGE_ADDR, p0, p1};
+  ssd1306_commands(ssd, janela, sizeof(janela));
+
+  bloco[0] = 0x40;
+  for (uint x = x0; x <= x1; ++x) {
+    for (uint p = p0; p <= p1; ++p) {
+      bloco[n++] = ssd->ram_buffer[SSD1306_INDICE(x, p)];
+      if (n == sizeof(bloco)) {
+        escreve(ssd, bloco, n);
+        n = 1;
+      }
     }
+  }
+  if (n > 1)
+    escreve(ssd, bloco, n);
+}
+#endif
+
+/* === Desenho === */
+
+// As primitivas recortam uma vez na entrada, contra as constantes da
+// geometria, e depois escrevem bytes de coluna inteiros
+
+// Bits das linhas a..b (0–7) dentro de um byte de página
+static inline uint8_t mascara_linhas(uint8_t a, uint8_t b) {
+  return (uint8_t)((0xFFu << a) & (0xFFu >> (7 - b)));
 }
 
+static inline void aplica(uint8_t *byte, uint8_t mascara, bool value) {
+  if (value)
+    *byte |= mascara;
+  else
+    *byte &= ~mascara;
+}
 
+void QUENTE(ssd1306_pixel)(ssd1306_t *ssd, uint8_t x, uint8_t y, bool value) {
+  if (x >= WIDTH || y >= HEIGHT)
+    return;
+  aplica(&ssd->ram_buffer[SSD1306_INDICE(x, y >> 3)], 1u << (y & 7), value);
+}
+
+void ssd1306_fill(ssd1306_t *ssd, bool value) {
+  memset(ssd->ram_buffer + 1, value ? 0xFF : 0x00, SSD1306_BUFSIZE - 1);
+}
 
 void ssd1306_rect(ssd1306_t *ssd, uint8_t top, uint8_t left, uint8_t width, uint8_t height, bool value, bool fill) {
-  for (uint8_t x = left; x < left + width; ++x) {
-    ssd1306_pixel(ssd, x, top, value);
-    ssd1306_pixel(ssd, x, top + height - 1, value);
-  }
-  for (uint8_t y = top; y < top + height; ++y) {
-    ssd1306_pixel(ssd, left, y, value);
-    ssd1306_pixel(ssd, left + width - 1, y, value);
-  }
+  if (!width || !height || left >= WIDTH || top >= HEIGHT)
+    return;
+  uint16_t right = left + width - 1;
+  uint16_t bottom = top + height - 1;
+  uint8_t x1 = right < WIDTH ? right : WIDTH - 1;
+  uint8_t y1 = bottom < HEIGHT ? bottom : HEIGHT - 1;
 
-  if (fill) {
-    for (uint8_t x = left + 1; x < left + width - 1; ++x) {
-      for (uint8_t y = top + 1; y < top + height - 1; ++y) {
-        ssd1306_pixel(ssd, x, y, value);
-      }
-    }
+  ssd1306_hline(ssd, left, x1, top, value);
+  if (bottom < HEIGHT)
+    ssd1306_hline(ssd, left, x1, bottom, value);
+  ssd1306_vline(ssd, left, top, y1, value);
+  if (right < WIDTH)
+    ssd1306_vline(ssd, right, top, y1, value);
+
+  if (fill && width > 2 && height > 2) {
+    uint8_t xf = right - 1 < WIDTH ? right - 1 : WIDTH - 1;
+    for (uint8_t x = left + 1; x <= xf; ++x)
+      ssd1306_vline(ssd, x, top + 1, bottom - 1 < HEIGHT ? bottom - 1 : HEIGHT - 1, value);
   }
 }
 
@@ -143,40 +211,56 @@ void ssd1306_line(ssd1306_t *ssd, uint8_t x0, uint8_t y0, uint8_t x1, uint8_t y1
 }
 
 
-void ssd1306_hline(ssd1306_t *ssd, uint8_t x0, uint8_t x1, uint8_t y, bool value) {
-  for (uint8_t x = x0; x <= x1; ++x)
-    ssd1306_pixel(ssd, x, y, value);
+void QUENTE(ssd1306_hline)(ssd1306_t *ssd, uint8_t x0, uint8_t x1, uint8_t y, bool value) {
+  if (y >= HEIGHT || x0 >= WIDTH || x0 > x1)
+    return;
+  if (x1 >= WIDTH)
+    x1 = WIDTH - 1;
+  uint8_t *byte = &ssd->ram_buffer[SSD1306_INDICE(x0, y >> 3)];
+  uint8_t mascara = 1u << (y & 7);
+  for (uint8_t x = x0; x <= x1; ++x, byte += SSD1306_PAGES)
+    aplica(byte, mascara, value);
 }
 
-void ssd1306_vline(ssd1306_t *ssd, uint8_t x, uint8_t y0, uint8_t y1, bool value) {
-  for (uint8_t y = y0; y <= y1; ++y)
-    ssd1306_pixel(ssd, x, y, value);
+void QUENTE(ssd1306_vline)(ssd1306_t *ssd, uint8_t x, uint8_t y0, uint8_t y1, bool value) {
+  if (x >= WIDTH || y0 >= HEIGHT || y0 > y1)
+    return;
+  if (y1 >= HEIGHT)
+    y1 = HEIGHT - 1;
+  uint8_t *coluna = &ssd->ram_buffer[SSD1306_INDICE(x, 0)];
+  uint8_t p0 = y0 >> 3, p1 = y1 >> 3;
+  for (uint8_t p = p0; p <= p1; ++p)
+    aplica(&coluna[p], mascara_linhas(p == p0 ? y0 & 7 : 0, p == p1 ? y1 & 7 : 7), value);
 }
 
 // Função para desenhar um caractere
 void ssd1306_draw_char(ssd1306_t *ssd, char c, uint8_t x, uint8_t y)
 {
-  uint16_t index = 0;
+  ssd1306_draw_glyph(ssd, SSD1306_GLIFO(c), x, y); // Caractere inválido vira espaço
+}
 
-  // Verifica o caractere e calcula o índice correspondente na fonte
-  if (c >= ' ' && c <= '~') // Verifica se o caractere está na faixa ASCII válida
-  {
-    index = (c - ' ') * 8; // Calcula o índice baseado na posição do caractere na tabela ASCII
-  }
-  else
-  {
-    // Caractere inválido, desenha um espaço (ou pode ser tratado de outra forma)
-    index = 0; // Índice 0 corresponde ao caractere "nada" (espaço)
-  }
+// Desenha o glifo 'glifo' da fonte (8 colunas)
+void ssd1306_draw_glyph(ssd1306_t *ssd, uint8_t glifo, uint8_t x, uint8_t y)
+{
+  ssd1306_blit(ssd, &font[glifo * 8], 8, x, y);
+}
+
+void QUENTE(ssd1306_blit)(ssd1306_t *ssd, const uint8_t *colunas, uint8_t largura, uint8_t x, uint8_t y)
+{
+  if (y >= HEIGHT)
+    return;
 
-  // Desenha o caractere na tela
-  for (uint8_t i = 0; i < 8; ++i)
+  // Cada coluna é um byte de 8 linhas: cai inteira em uma página quando y é
+  // múltiplo de 8, senão se divide entre esta e a seguinte
+  uint8_t p = y >> 3, desloc = y & 7;
+  bool segunda = desloc && p + 1 < SSD1306_PAGES;
+  for (uint8_t i = 0; i < largura && x + i < WIDTH; ++i)
   {
-    uint8_t line = font[index + i]; // Acessa a linha correspondente do caractere na fonte
-    for (uint8_t j = 0; j < 8; ++j)
-    {
-      ssd1306_pixel(ssd, x + i, y + j, line & (1 << j)); // Desenha cada pixel do caractere
-    }
+    uint8_t line = colunas[i];
+    uint8_t *coluna = &ssd->ram_buffer[SSD1306_INDICE(x + i, p)];
+    coluna[0] = (coluna[0] & ~(0xFFu << desloc)) | (uint8_t)(line << desloc);
+    if (segunda)
+      coluna[1] = (coluna[1] & ~(0xFFu >> (8 - desloc))) | (line >> (8 - desloc));
   }
 }
 
@@ -187,14 +271,14 @@ void ssd1306_draw_string(ssd1306_t *ssd, const char *str, uint8_t x, uint8_t y)
   {
     ssd1306_draw_char(ssd, *str++, x, y);
     x += 8;
-    if (x + 8 >= ssd->width)
+    if (x + 8 >= WIDTH)
     {
       x = 0;
       y += 8;
     }
-    if (y + 8 >= ssd->height)
+    if (y + 8 >= HEIGHT)
     {
       break;
     }
   }
-}
\ No newline at end of file
+}
@@ -1,9 +1,51 @@
+#ifndef SSD1306_H
+#define SSD1306_H
+
 #include <stdlib.h>
 #include "pico/stdlib.h"
 #include "hardware/i2c.h"
 
+// Geometria do painel, fixa na compilação: o índice de cada pixel, o tamanho
+// do buffer e os laços por página saem de constantes. Escolher com
+// -DSSD1306_GEOMETRIA=<valor> (ou target_compile_definitions no CMake).
+#define SSD1306_128X64 0 // BitDogLab
+#define SSD1306_128X32 1
+#define SH1106_132X64 2 // 1,3": RAM de 132 colunas, 128 visíveis a partir da coluna 2
+
+#ifndef SSD1306_GEOMETRIA
+#define SSD1306_GEOMETRIA SSD1306_128X64
+#endif
+
+#if SSD1306_GEOMETRIA == SSD1306_128X64
+#define WIDTH 128
+#define HEIGHT 64
+#define SSD1306_COM_PINS 0x12 // COM alternados
+#define SSD1306_COLUNA0 0
+#elif SSD1306_GEOMETRIA == SSD1306_128X32
+#define WIDTH 128
+#define HEIGHT 32
+#define SSD1306_COM_PINS 0x02 // COM sequenciais
+#define SSD1306_COLUNA0 0
+#elif SSD1306_GEOMETRIA == SH1106_132X64
 #define WIDTH 128
 #define HEIGHT 64
+#define SSD1306_COM_PINS 0x12
+#define SSD1306_COLUNA0 2 // primeira coluna visível na RAM do SH1106
+#define SSD1306_SH1106 1  // só endereçamento por página
+#else
+#error "SSD1306_GEOMETRIA desconhecida"
+#endif
+
+#define SSD1306_PAGES (HEIGHT / 8)
+#define SSD1306_BUFSIZE (WIDTH * SSD1306_PAGES + 1) // +1: byte de controle 0x40
+#define SSD1306_COMANDOS_MAX 32 // comandos por transação em ssd1306_commands
+
+// Byte da coluna x, página p no ram_buffer (endereçamento vertical: cada
+// coluna ocupa SSD1306_PAGES bytes contíguos)
+#define SSD1306_INDICE(x, p) (1 + (size_t)(x) * SSD1306_PAGES + (p))
+
+// Índice do glifo de um caractere ASCII visível na fonte (font.h); fora da faixa vira espaço
+#define SSD1306_GLIFO(c) ((c) >= ' ' && (c) <= '~' ? (uint8_t)((c) - ' ') : 0)
 
 typedef enum {
   SET_CONTRAST = 0x81,
@@ -26,18 +68,21 @@ typedef enum {
 } ssd1306_command_t;
 
 typedef struct {
-  uint8_t width, height, pages, address;
+  uint8_t address;
   i2c_inst_t *i2c_port;
   bool external_vcc;
-  uint8_t *ram_buffer;
-  size_t bufsize;
+  uint8_t ram_buffer[SSD1306_BUFSIZE];
   uint8_t port_buffer[2];
+  uint16_t falhas; // escritas I2C que não completaram (prazo ou NACK)
 } ssd1306_t;
 
-void ssd1306_init(ssd1306_t *ssd, uint8_t width, uint8_t height, bool external_vcc, uint8_t address, i2c_inst_t *i2c);
+void ssd1306_init(ssd1306_t *ssd, bool external_vcc, uint8_t address, i2c_inst_t *i2c);
 void ssd1306_config(ssd1306_t *ssd);
 void ssd1306_command(ssd1306_t *ssd, uint8_t command);
+// Vários comandos numa só transação I2C (até SSD1306_COMANDOS_MAX)
+void ssd1306_commands(ssd1306_t *ssd, const uint8_t *commands, size_t n);
 void ssd1306_send_data(ssd1306_t *ssd);
+void ssd1306_send_region(ssd1306_t *ssd, uint8_t x0, uint8_t x1, uint8_t p0, uint8_t p1);
 
 void ssd1306_pixel(ssd1306_t *ssd, uint8_t x, uint8_t y, bool value);
 void ssd1306_fill(ssd1306_t *ssd, bool value);
@@ -46,4 +91,9 @@ void ssd1306_line(ssd1306_t *ssd, uint8_t x0, uint8_t y0, uint8_t x1, uint8_t y1
 void ssd1306_hline(ssd1306_t *ssd, uint8_t x0, uint8_t x1, uint8_t y, bool value);
 void ssd1306_vline(ssd1306_t *ssd, uint8_t x, uint8_t y0, uint8_t y1, bool value);
 void ssd1306_draw_char(ssd1306_t *ssd, char c, uint8_t x, uint8_t y);
-void ssd1306_draw_string(ssd1306_t *ssd, const char *str, uint8_t x, uint8_t y);
\ No newline at end of file
+void ssd1306_draw_glyph(ssd1306_t *ssd, uint8_t glifo, uint8_t x, uint8_t y);
+// Colunas de 8 pixels já rasterizadas (um byte por coluna, bit 0 em cima), como os glifos da fonte
+void ssd1306_blit(ssd1306_t *ssd, const uint8_t *colunas, uint8_t largura, uint8_t x, uint8_t y);
+void ssd1306_draw_string(ssd1306_t *ssd, const char *str, uint8_t x, uint8_t y);
+
+#endif
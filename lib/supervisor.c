@@ -0,0 +1,238 @@
+#include "supervisor.h"
+#include <string.h>
+#include "pico/stdlib.h"
+#include "hardware/gpio.h"
+#include "hardware/watchdog.h"
+#include "FreeRTOS.h"
+#include "task.h"
+
+// Rascunho 0–3 do watchdog (4–7 são do watchdog_reboot do SDK):
+//   [0] SUP_MAGICO | causa, [1] nome (4 letras), [2] atraso_ms, [3] ligado_s
+#define SUP_MAGICO 0x5C0A0000u
+#define SUP_MAGICO_MASCARA 0xFFFF0000u
+
+// Recuperação da I2C: bit-bang a ~100 kHz
+#define I2C_PULSOS_LIBERAR 9
+#define I2C_MEIO_PERIODO_US 5
+
+typedef struct
+{
+  const char *nome;
+  uint32_t prazo_us;
+  sup_recuperar_fn recuperar;
+  void *ctx;
+  volatile uint32_t batida_us; // escrita pela tarefa supervisionada
+  uint32_t graca_us;           // batida_us deixada pela recuperação
+  bool recuperando;            // recuperação feita, esperando a próxima batida
+  uint32_t inicio_us;          // ativação em curso (só a própria tarefa escreve)
+  uint32_t exec_max_us;
+  uint32_t ativacoes;
+} sup_tarefa_t;
+
+static sup_tarefa_t tarefas[SUP_TAREFAS_MAX];
+static volatile uint8_t total;
+static sup_reinicio_t anterior;
+static sup_stats_t stats;
+
+/* === Causa do reinício === */
+
+void supervisor_init(void)
+{
+  uint32_t marca = watchdog_hw->scratch[0];
+
+  memset(&anterior, 0, sizeof(anterior));
+  if ((marca & SUP_MAGICO_MASCARA) == SUP_MAGICO)
+  {
+    uint32_t nome = watchdog_hw->scratch[1];
+    anterior.causa = (sup_causa_t)(marca & 0xFF);
+    memcpy(anterior.tarefa, &nome, 4);
+    anterior.atraso_ms = watchdog_hw->scratch[2];
+    anterior.ligado_s = watchdog_hw->scratch[3];
+  }
+  else if (watchdog_enable_caused_reboot())
+  {
+    anterior.causa = SUP_CAUSA_WATCHDOG;
+  }
+  watchdog_hw->scratch[0] = 0;
+}
+
+void supervisor_reinicio_anterior(sup_reinicio_t *r)
+{
+  *r = anterior;
+}
+
+static void reinicia(const sup_tarefa_t *t, uint32_t atraso_us)
+{
+  uint32_t nome = 0;
+  strncpy((char *)&nome, t->nome, 4);
+
+  watchdog_hw->scratch[1] = nome;
+  watchdog_hw->scratch[2] = atraso_us / 1000;
+  watchdog_hw->scratch[3] = to_ms_since_boot(get_absolute_time()) / 1000;
+  watchdog_hw->scratch[0] = SUP_MAGICO | SUP_CAUSA_PRAZO;
+  watchdog_reboot(0, 0, 0);
+  while (true)
+    tight_loop_contents();
+}
+
+/* === Batidas === */
+
+int supervisor_registrar(const char *nome, uint32_t prazo_ms, sup_recuperar_fn recuperar, void *ctx)
+{
+  int id = -1;
+
+  taskENTER_CRITICAL();
+  if (total < SUP_TAREFAS_MAX)
+  {
+    id = total;
+    sup_tarefa_t *t = &tarefas[id];
+    t->nome = nome;
+    t->prazo_us = prazo_ms * 1000;
+    t->recuperar = recuperar;
+    t->ctx = ctx;
+    t->batida_us = time_us_32();
+    t->recuperando = false;
+    t->exec_max_us = 0;
+    t->ativacoes = 0;
+    total++; // publicada por último: a verificação só vê entradas completas
+  }
+  taskEXIT_CRITICAL();
+  return id;
+}
+
+void supervisor_prazo(int id, uint32_t prazo_ms)
+{
+  if (id >= 0)
+    tarefas[id].prazo_us = prazo_ms * 1000;
+}
+
+void supervisor_batida(int id)
+{
+  if (id >= 0)
+    tarefas[id].batida_us = time_us_32();
+}
+
+/* === Medição === */
+
+void supervisor_inicio(int id)
+{
+  if (id >= 0)
+    tarefas[id].inicio_us = time_us_32();
+}
+
+void supervisor_fim(int id)
+{
+  if (id < 0)
+    return;
+  sup_tarefa_t *t = &tarefas[id];
+  uint32_t gasto = time_us_32() - t->inicio_us;
+  if (gasto > t->exec_max_us)
+    t->exec_max_us = gasto;
+  t->ativacoes++;
+}
+
+bool supervisor_tarefa(int id, sup_tarefa_info_t *info)
+{
+  if (id < 0 || id >= total)
+    return false;
+  const sup_tarefa_t *t = &tarefas[id];
+  memset(info->nome, 0, sizeof(info->nome));
+  strncpy(info->nome, t->nome, 4);
+  taskENTER_CRITICAL(); // par coerente com a tarefa medida
+  info->exec_max_us = t->exec_max_us;
+  info->ativacoes = t->ativacoes;
+  taskEXIT_CRITICAL();
+  return true;
+}
+
+/* === Verificação === */
+
+static void verifica(sup_tarefa_t *t, uint32_t agora)
+{
+  uint32_t batida = t->batida_us;
+  if (t->recuperando && batida != t->graca_us)
+    t->recuperando = false; // voltou a bater depois da recuperação
+
+  uint32_t atraso = agora - batida;
+  if (t->prazo_us == 0 || atraso <= t->prazo_us)
+    return; // só medição, ou em dia
+
+  // Primeiro vencimento: recuperação dirigida e mais um prazo
+  if (t->recuperar && !t->recuperando)
+  {
+    t->recuperar(t->ctx);
+    stats.recuperacoes++;
+    t->recuperando = true;
+    t->graca_us = t->batida_us = time_us_32();
+    return;
+  }
+  reinicia(t, atraso);
+}
+
+void vSupervisorTask(void *params)
+{
+  watchdog_enable(SUP_WATCHDOG_MS, true); // pausa com o depurador parado
+
+  TickType_t ultimo = xTaskGetTickCount();
+  while (true)
+  {
+    uint32_t inicio = time_us_32();
+    uint8_t n = total;
+    for (uint8_t i = 0; i < n; i++)
+      verifica(&tarefas[i], inicio);
+    watchdog_update();
+
+    // Custo da própria verificação (inclui as raras recuperações)
+    uint32_t gasto = time_us_32() - inicio;
+    stats.verificacoes++;
+    stats.us_total += gasto;
+    if (gasto > stats.us_max)
+      stats.us_max = gasto;
+
+    vTaskDelayUntil(&ultimo, pdMS_TO_TICKS(SUP_PERIODO_MS));
+  }
+}
+
+void supervisor_stats(sup_stats_t *s)
+{
+  taskENTER_CRITICAL();
+  *s = stats;
+  taskEXIT_CRITICAL();
+}
+
+/* === Recuperações === */
+
+void supervisor_destravar_i2c(i2c_inst_t *i2c, uint sda, uint scl, uint baudrate)
+{
+  // Reinicia o controlador; as linhas viram dreno aberto por software
+  // (saída em 0 ou entrada com o pull-up já ligado)
+  i2c_deinit(i2c);
+  gpio_set_function(sda, GPIO_FUNC_SIO);
+  gpio_set_function(scl, GPIO_FUNC_SIO);
+  gpio_put(sda, 0);
+  gpio_put(scl, 0);
+  gpio_set_dir(sda, GPIO_IN);
+  gpio_set_dir(scl, GPIO_IN);
+
+  // Pulsos de SCL até o escravo terminar o byte que prendia a SDA
+  for (int i = 0; i < I2C_PULSOS_LIBERAR && !gpio_get(sda); i++)
+  {
+    gpio_set_dir(scl, GPIO_OUT);
+    busy_wait_us(I2C_MEIO_PERIODO_US);
+    gpio_set_dir(scl, GPIO_IN);
+    busy_wait_us(I2C_MEIO_PERIODO_US);
+  }
+
+  // STOP: SDA sobe com SCL em 1
+  gpio_set_dir(scl, GPIO_OUT);
+  gpio_set_dir(sda, GPIO_OUT);
+  busy_wait_us(I2C_MEIO_PERIODO_US);
+  gpio_set_dir(scl, GPIO_IN);
+  busy_wait_us(I2C_MEIO_PERIODO_US);
+  gpio_set_dir(sda, GPIO_IN);
+  busy_wait_us(I2C_MEIO_PERIODO_US);
+
+  i2c_init(i2c, baudrate);
+  gpio_set_function(sda, GPIO_FUNC_I2C);
+  gpio_set_function(scl, GPIO_FUNC_I2C);
+}
@@ -0,0 +1,112 @@
+#ifndef SUPERVISOR_H
+#define SUPERVISOR_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "hardware/i2c.h"
+
+// Supervisor de saúde com o watchdog do RP2040. Cada tarefa supervisionada
+// se registra com um prazo e dá batidas (supervisor_batida) sempre que
+// conclui uma volta com sucesso. A vSupervisorTask, na maior prioridade,
+// confere os prazos e alimenta o watchdog:
+//   1. prazo vencido: chama a recuperação da tarefa (destravar a I2C,
+//      reiniciar a máquina PIO) e dá mais um prazo;
+//   2. vencido de novo: grava a causa nos registradores de rascunho do
+//      watchdog e reinicia a placa.
+// Se a própria vSupervisorTask parar, o watchdog não é alimentado e reinicia
+// a placa sozinho. A causa é lida no boot seguinte (supervisor_init).
+//
+// O supervisor também mede o pior tempo de cada ativação (supervisor_inicio /
+// supervisor_fim), que alimenta a análise de escalonabilidade
+// (tools/escalonabilidade.py) pela telemetria.
+
+#define SUP_TAREFAS_MAX 8
+#define SUP_PERIODO_MS 100  // período da verificação
+#define SUP_WATCHDOG_MS 2000 // sem alimentação por esse tempo, o hardware reinicia
+
+typedef void (*sup_recuperar_fn)(void *ctx);
+
+typedef enum
+{
+  SUP_CAUSA_NENHUMA,  // boot normal (energia, RUN, BOOTSEL)
+  SUP_CAUSA_PRAZO,    // tarefa sem batida mesmo após a recuperação
+  SUP_CAUSA_WATCHDOG, // watchdog venceu sem aviso (supervisor parado)
+} sup_causa_t;
+
+// Causa do reinício anterior, lida dos registradores de rascunho
+typedef struct
+{
+  sup_causa_t causa;
+  char tarefa[5];      // quatro primeiras letras do nome da tarefa
+  uint32_t atraso_ms;  // tempo sem batida quando a placa foi reiniciada
+  uint32_t ligado_s;   // tempo ligado antes do reinício
+} sup_reinicio_t;
+
+typedef struct
+{
+  uint32_t verificacoes; // voltas da vSupervisorTask
+  uint32_t us_max;       // pior tempo de uma verificação
+  uint32_t us_total;     // soma dos tempos (média = us_total / verificacoes)
+  uint32_t recuperacoes; // recuperações disparadas desde o boot
+} sup_stats_t;
+
+// Medição de uma tarefa registrada
+typedef struct
+{
+  char nome[5];         // quatro primeiras letras, como no reinício
+  uint32_t exec_max_us; // pior ativação, de supervisor_inicio a supervisor_fim
+  uint32_t ativacoes;
+} sup_tarefa_info_t;
+
+/**
+ * Lê e apaga a causa do reinício anterior. Chamar no início do main(),
+ * antes de qualquer tarefa.
+ */
+void supervisor_init(void);
+
+void supervisor_reinicio_anterior(sup_reinicio_t *r);
+
+/**
+ * Registra a tarefa chamadora. 'prazo_ms' é o maior intervalo aceitável
+ * entre batidas (0: só medição, sem prazo); 'recuperar' (opcional) roda na
+ * vSupervisorTask quando o prazo vence pela primeira vez. Retorna o id para
+ * as batidas ou -1.
+ */
+int supervisor_registrar(const char *nome, uint32_t prazo_ms, sup_recuperar_fn recuperar, void *ctx);
+
+// Troca o prazo (ex.: o período da tarefa mudou na configuração)
+void supervisor_prazo(int id, uint32_t prazo_ms);
+
+/**
+ * Marca progresso da tarefa: uma leitura do timer e uma escrita de 32 bits.
+ */
+void supervisor_batida(int id);
+
+/**
+ * Delimitam uma ativação da tarefa: início logo depois da espera (fila,
+ * notificação ou período) e fim quando a saída foi entregue. O intervalo
+ * inclui a preempção por tarefas mais prioritárias, então o pior valor é um
+ * limite superior do tempo de execução, nunca um valor otimista.
+ */
+void supervisor_inicio(int id);
+void supervisor_fim(int id);
+
+/**
+ * Liga o watchdog e verifica os prazos a cada SUP_PERIODO_MS. Criar com a
+ * maior prioridade entre as tarefas.
+ */
+void vSupervisorTask(void *params);
+
+void supervisor_stats(sup_stats_t *s);
+
+// Medição da tarefa 'id' (ids de 0 em diante); false depois da última
+bool supervisor_tarefa(int id, sup_tarefa_info_t *info);
+
+/**
+ * Recuperação de barramento I2C travado: desliga o controlador, gera até
+ * nove pulsos de SCL até o escravo soltar a SDA, um STOP, e reinicia o
+ * controlador. Quem estava preso no controlador sai com erro.
+ */
+void supervisor_destravar_i2c(i2c_inst_t *i2c, uint sda, uint scl, uint baudrate);
+
+#endif
@@ -0,0 +1,422 @@
+#include "telemetria.h"
+#include <string.h>
+#include "pico/stdlib.h"
+#include "hardware/adc.h"
+#include "hardware/dma.h"
+#include "FreeRTOS.h"
+#include "task.h"
+
+#define ANEL_TAM 2048 // anel de registros (potência de 2)
+#define ANEL_MASCARA (ANEL_TAM - 1)
+
+#define BRUTO_ANEL_BITS 10                          // anel de DMA de 1 KiB
+#define BRUTO_AMOSTRAS (1u << (BRUTO_ANEL_BITS - 1)) // 512 amostras de 16 bits (256 pares)
+#define BRUTO_PARES_POR_REGISTRO 48
+#define BRUTO_CONTAGEM_DMA (0xFFFFFFFFu & ~(BRUTO_AMOSTRAS - 1)) // múltiplo do anel: cada volta termina no início
+#define BRUTO_HZ_MIN 367    // abaixo disso o divisor do ADC passa dos 16 bits inteiros
+#define BRUTO_HZ_MAX 250000 // 96 ciclos de 48 MHz por conversão, duas por par
+
+#define TEL_PERIODO_MS 10    // período da tarefa de envio
+#define TEL_STATS_MS 1000    // período do registro de estatísticas
+
+// Anel de registros: escrito pelos produtores em seção crítica, lido só pela tarefa
+static uint8_t anel[ANEL_TAM];
+static volatile uint16_t anel_cabeca;
+static volatile uint16_t anel_cauda;
+static tel_stats_t stats;
+
+// Aquisição contínua por DMA (modo bruto)
+static uint16_t bruto_anel[BRUTO_AMOSTRAS] __attribute__((aligned(1u << BRUTO_ANEL_BITS)));
+static int bruto_dma = -1;        // dois canais encadeados: um rearma o outro ao terminar
+static int bruto_dma_par = -1;
+static int bruto_dma_visto;       // canal ativo na última leitura da contagem
+static uint64_t bruto_base;       // amostras das transferências já terminadas
+static uint32_t bruto_periodo_us; // período de um par ADC0/ADC1
+static uint64_t bruto_t0_us;      // instante do primeiro par
+static uint64_t bruto_lidos;      // amostras já transmitidas (monotônico)
+
+/* === CRC e COBS === */
+
+static const uint16_t crc_nibble[16] = {
+  0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
+  0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF,
+};
+
+uint16_t telemetria_crc16(const uint8_t *dados, size_t tamanho)
+{
+  uint16_t crc = 0xFFFF;
+  while (tamanho--)
+  {
+    crc ^= (uint16_t)(*dados++) << 8;
+    crc = (crc << 4) ^ crc_nibble[crc >> 12];
+    crc = (crc << 4) ^ crc_nibble[crc >> 12];
+  }
+  return crc;
+}
+
+size_t telemetria_cobs(const uint8_t *entrada, size_t tamanho, uint8_t *saida)
+{
+  size_t escrito = 1, pos_codigo = 0;
+  uint8_t codigo = 1;
+
+  for (size_t i = 0; i < tamanho; i++)
+  {
+    if (entrada[i] == 0)
+    {
+      saida[pos_codigo] = codigo;
+      pos_codigo = escrito++;
+      codigo = 1;
+    }
+    else
+    {
+      saida[escrito++] = entrada[i];
+      if (++codigo == 0xFF)
+      {
+        saida[pos_codigo] = codigo;
+        pos_codigo = escrito++;
+        codigo = 1;
+      }
+    }
+  }
+  saida[pos_codigo] = codigo;
+  return escrito;
+}
+
+/* === Anel de registros === */
+
+void telemetria_init(void)
+{
+  anel_cabeca = 0;
+  anel_cauda = 0;
+  memset(&stats, 0, sizeof(stats));
+}
+
+bool telemetria_registrar(tel_tipo_t tipo, const void *dados, uint8_t tamanho)
+{
+  bool ok = false;
+
+  taskENTER_CRITICAL();
+  uint16_t ocupado = (anel_cabeca - anel_cauda) & ANEL_MASCARA;
+  if (ocupado + 2u + tamanho < ANEL_TAM)
+  {
+    uint16_t c = anel_cabeca;
+    anel[c] = (uint8_t)tipo;
+    anel[(c + 1) & ANEL_MASCARA] = tamanho;
+    for (uint8_t i = 0; i < tamanho; i++)
+      anel[(c + 2 + i) & ANEL_MASCARA] = ((const uint8_t *)dados)[i];
+    anel_cabeca = (c + 2 + tamanho) & ANEL_MASCARA;
+
+    ocupado += 2u + tamanho;
+    if (ocupado > stats.ocupacao_max)
+      stats.ocupacao_max = ocupado;
+    ok = true;
+  }
+  else
+  {
+    stats.descartados++;
+  }
+  taskEXIT_CRITICAL();
+
+  return ok;
+}
+
+static inline uint8_t *poe_u16(uint8_t *p, uint16_t v)
+{
+  p[0] = (uint8_t)v;
+  p[1] = (uint8_t)(v >> 8);
+  return p + 2;
+}
+
+static inline uint8_t *poe_u32(uint8_t *p, uint32_t v)
+{
+  p = poe_u16(p, (uint16_t)v);
+  return poe_u16(p, (uint16_t)(v >> 16));
+}
+
+void telemetria_amostra(uint32_t t_ms, uint16_t agua, uint16_t chuva, uint16_t agua_mm, uint16_t chuva_mmh_x10)
+{
+  uint8_t r[12], *p = r;
+  p = poe_u32(p, t_ms);
+  p = poe_u16(p, agua);
+  p = poe_u16(p, chuva);
+  p = poe_u16(p, agua_mm);
+  poe_u16(p, chuva_mmh_x10);
+  telemetria_registrar(TEL_AMOSTRA, r, sizeof(r));
+}
+
+void telemetria_canais(uint32_t t_ms, uint16_t mascara, const int32_t eng[16])
+{
+  uint8_t r[6 + 16 * 4], *p = r;
+  p = poe_u32(p, t_ms);
+  p = poe_u16(p, mascara);
+  for (int id = 0; id < 16; id++)
+    if (mascara & (1u << id))
+      p = poe_u32(p, (uint32_t)eng[id]);
+  telemetria_registrar(TEL_CANAIS, r, (uint8_t)(p - r));
+}
+
+void telemetria_estado(uint32_t t_ms, uint8_t anterior, uint8_t novo)
+{
+  uint8_t r[6], *p = r;
+  p = poe_u32(p, t_ms);
+  *p++ = anterior;
+  *p = novo;
+  telemetria_registrar(TEL_ESTADO, r, sizeof(r));
+}
+
+void telemetria_alarme(uint32_t t_ms, uint8_t de, uint8_t para, uint8_t causa)
+{
+  uint8_t r[7], *p = r;
+  p = poe_u32(p, t_ms);
+  *p++ = de;
+  *p++ = para;
+  *p = causa;
+  telemetria_registrar(TEL_ALARME, r, sizeof(r));
+}
+
+void telemetria_reinicio(uint8_t causa, const char tarefa[4], uint32_t atraso_ms, uint32_t ligado_s)
+{
+  uint8_t r[13], *p = r;
+  *p++ = causa;
+  memcpy(p, tarefa, 4);
+  p = poe_u32(p + 4, atraso_ms);
+  poe_u32(p, ligado_s);
+  telemetria_registrar(TEL_REINICIO, r, sizeof(r));
+}
+
+void telemetria_boot(uint16_t orcamento_ms, const uint32_t *fases_us, uint8_t fases)
+{
+  uint8_t r[2 + 4 * 16], *p = r;
+  if (fases > 16)
+    fases = 16;
+  *p++ = (uint8_t)orcamento_ms;
+  *p++ = (uint8_t)(orcamento_ms >> 8);
+  for (uint8_t i = 0; i < fases; i++)
+    p = poe_u32(p, fases_us[i]);
+  telemetria_registrar(TEL_BOOT, r, (uint8_t)(p - r));
+}
+
+void telemetria_tarefa(const char tarefa[4], uint32_t exec_max_us, uint32_t ativacoes)
+{
+  uint8_t r[12], *p = r;
+  memcpy(p, tarefa, 4);
+  p = poe_u32(p + 4, exec_max_us);
+  poe_u32(p, ativacoes);
+  telemetria_registrar(TEL_TAREFA, r, sizeof(r));
+}
+
+void telemetria_xip(uint8_t estagio, bool na_ram, uint32_t chamadas, uint32_t ciclos_medio, uint32_t ciclos_max,
+                    uint32_t acessos, uint32_t acertos)
+{
+  uint8_t r[22], *p = r;
+  *p++ = estagio;
+  *p++ = na_ram;
+  p = poe_u32(p, chamadas);
+  p = poe_u32(p, ciclos_medio);
+  p = poe_u32(p, ciclos_max);
+  p = poe_u32(p, acessos);
+  poe_u32(p, acertos);
+  telemetria_registrar(TEL_XIP, r, sizeof(r));
+}
+
+void telemetria_stats(tel_stats_t *saida)
+{
+  taskENTER_CRITICAL();
+  *saida = stats;
+  taskEXIT_CRITICAL();
+}
+
+static void registra_stats(void)
+{
+  tel_stats_t s;
+  telemetria_stats(&s);
+
+  uint8_t r[18], *p = r;
+  p = poe_u32(p, to_ms_since_boot(get_absolute_time()));
+  p = poe_u32(p, s.descartados);
+  p = poe_u32(p, s.quadros);
+  p = poe_u32(p, s.bytes);
+  poe_u16(p, s.ocupacao_max);
+  telemetria_registrar(TEL_STATS, r, sizeof(r));
+}
+
+/* === Modo bruto (ADC contínuo + DMA) === */
+
+void telemetria_bruto_iniciar(uint32_t hz)
+{
+  if (bruto_dma >= 0 || hz == 0)
+    return;
+  if (hz < BRUTO_HZ_MIN)
+    hz = BRUTO_HZ_MIN;
+  if (hz > BRUTO_HZ_MAX)
+    hz = BRUTO_HZ_MAX;
+
+  bruto_periodo_us = 1000000u / hz;
+
+  // ADC em modo contínuo alternando ADC0 e ADC1; cada par leva 1/hz segundos
+  adc_select_input(0);
+  adc_set_round_robin(0x3);
+  adc_fifo_setup(true, true, 1, false, false);
+  adc_set_clkdiv(48000000.0f / (2.0f * hz) - 1.0f);
+
+  // DMA do FIFO do ADC para o anel, com wrap de endereço feito pelo hardware. Cada
+  // canal conta um múltiplo do anel e, ao terminar (~24 dias a 1 kHz), dispara o
+  // outro, que começa do início do anel; o primeiro recarrega a contagem ao ser
+  // disparado de volta. Nenhuma interrupção e nenhuma amostra perdida na troca.
+  bruto_dma = dma_claim_unused_channel(true);
+  bruto_dma_par = dma_claim_unused_channel(true);
+  for (int i = 0; i < 2; i++)
+  {
+    int canal = i ? bruto_dma_par : bruto_dma;
+    dma_channel_config c = dma_channel_get_default_config(canal);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_16);
+    channel_config_set_read_increment(&c, false);
+    channel_config_set_write_increment(&c, true);
+    channel_config_set_ring(&c, true, BRUTO_ANEL_BITS);
+    channel_config_set_dreq(&c, DREQ_ADC);
+    channel_config_set_chain_to(&c, i ? bruto_dma : bruto_dma_par);
+    dma_channel_configure(canal, &c, bruto_anel, &adc_hw->fifo, BRUTO_CONTAGEM_DMA, false);
+  }
+  dma_channel_start(bruto_dma);
+
+  bruto_dma_visto = bruto_dma;
+  bruto_base = 0;
+  bruto_lidos = 0;
+  bruto_t0_us = time_us_64();
+  adc_run(true);
+}
+
+bool telemetria_bruto_ativo(void)
+{
+  return bruto_dma >= 0;
+}
+
+// Amostras já escritas pelo DMA desde o início: as transferências terminadas mais
+// a do canal ativo (a contagem decresce a cada amostra). Entre duas leituras há no
+// máximo uma troca de canal, e o canal que ainda não começou conta zero.
+static uint64_t bruto_escritas(void)
+{
+  taskENTER_CRITICAL(); // lida pela vSensorTask e pela tarefa de telemetria
+  int ativo = dma_channel_is_busy(bruto_dma) ? bruto_dma : bruto_dma_par;
+  if (ativo != bruto_dma_visto)
+  {
+    bruto_base += BRUTO_CONTAGEM_DMA;
+    bruto_dma_visto = ativo;
+  }
+  uint64_t escritas = bruto_base + (BRUTO_CONTAGEM_DMA - dma_channel_hw_addr(ativo)->transfer_count);
+  taskEXIT_CRITICAL();
+  return escritas;
+}
+
+bool telemetria_bruto_ultimo(uint16_t *adc0, uint16_t *adc1)
+{
+  if (bruto_dma < 0)
+    return false;
+
+  uint64_t escritas = bruto_escritas() & ~(uint64_t)1; // só pares completos
+  if (escritas < 2)
+    return false;
+
+  uint32_t i = (uint32_t)(escritas - 2);
+  *adc0 = bruto_anel[i & (BRUTO_AMOSTRAS - 1)];
+  *adc1 = bruto_anel[(i + 1) & (BRUTO_AMOSTRAS - 1)];
+  return true;
+}
+
+// Acrescenta ao quadro um registro TEL_BRUTO com os pares pendentes que couberem
+static size_t anexa_bruto(uint8_t *quadro, size_t n)
+{
+  uint64_t escritas = bruto_escritas() & ~(uint64_t)1;
+
+  // Se o DMA deu a volta no anel antes de ser lido, pula o trecho perdido
+  if (escritas - bruto_lidos > BRUTO_AMOSTRAS)
+  {
+    taskENTER_CRITICAL();
+    stats.descartados += (uint32_t)((escritas - bruto_lidos - BRUTO_AMOSTRAS) >> 1);
+    taskEXIT_CRITICAL();
+    bruto_lidos = escritas - BRUTO_AMOSTRAS;
+  }
+
+  uint32_t pares = (uint32_t)((escritas - bruto_lidos) >> 1);
+  size_t livre = TELEMETRIA_QUADRO_MAX - n;
+  if (pares == 0 || livre < 2 + 6 + 4)
+    return n;
+
+  uint32_t cabem = (livre - 2 - 6) >> 2;
+  if (pares > cabem)
+    pares = cabem;
+  if (pares > BRUTO_PARES_POR_REGISTRO)
+    pares = BRUTO_PARES_POR_REGISTRO;
+
+  uint8_t *p = &quadro[n];
+  *p++ = TEL_BRUTO;
+  *p++ = (uint8_t)(6 + pares * 4);
+  p = poe_u32(p, (uint32_t)(bruto_t0_us + (bruto_lidos >> 1) * bruto_periodo_us));
+  p = poe_u16(p, (uint16_t)bruto_periodo_us);
+  for (uint32_t k = 0; k < pares * 2; k++)
+    p = poe_u16(p, bruto_anel[(uint32_t)(bruto_lidos + k) & (BRUTO_AMOSTRAS - 1)]);
+  bruto_lidos += pares * 2;
+
+  return (size_t)(p - quadro);
+}
+
+// Move registros inteiros do anel para o quadro enquanto couberem
+static size_t anexa_registros(uint8_t *quadro, size_t n)
+{
+  while (anel_cauda != anel_cabeca)
+  {
+    uint16_t t = anel_cauda;
+    uint8_t tamanho = anel[(t + 1) & ANEL_MASCARA];
+    if (n + 2u + tamanho > TELEMETRIA_QUADRO_MAX)
+      break;
+    for (uint16_t i = 0; i < 2u + tamanho; i++)
+      quadro[n++] = anel[(t + i) & ANEL_MASCARA];
+    anel_cauda = (t + 2 + tamanho) & ANEL_MASCARA;
+  }
+  return n;
+}
+
+void vTelemetriaTask(void *params)
+{
+  uint8_t quadro[TELEMETRIA_QUADRO_MAX + 2];                  // registros + CRC
+  uint8_t linha[TELEMETRIA_QUADRO_MAX + 2 + 2 + 1];           // COBS + delimitador
+  uint8_t seq = 0;
+  TickType_t ultimo_stats = xTaskGetTickCount();
+
+  while (true)
+  {
+    if (xTaskGetTickCount() - ultimo_stats >= pdMS_TO_TICKS(TEL_STATS_MS))
+    {
+      ultimo_stats += pdMS_TO_TICKS(TEL_STATS_MS);
+      registra_stats();
+    }
+
+    // Esvazia tudo o que estiver pendente, um quadro por vez
+    while (true)
+    {
+      size_t n = 0;
+      quadro[n++] = TELEMETRIA_VERSAO;
+      quadro[n++] = seq;
+      n = anexa_registros(quadro, n);
+      if (bruto_dma >= 0)
+        n = anexa_bruto(quadro, n);
+      if (n == 2)
+        break;
+
+      uint16_t crc = telemetria_crc16(quadro, n);
+      quadro[n++] = (uint8_t)crc;
+      quadro[n++] = (uint8_t)(crc >> 8);
+
+      size_t tam = telemetria_cobs(quadro, n, linha);
+      linha[tam++] = 0x00;
+
+      // Só esta tarefa escreve na USB; se o host não ler, quem espera é ela
+      stdio_put_string((const char *)linha, (int)tam, false, false);
+      seq++;
+      stats.quadros++;
+      stats.bytes += tam;
+    }
+
+    vTaskDelay(pdMS_TO_TICKS(TEL_PERIODO_MS));
+  }
+}
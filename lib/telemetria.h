@@ -0,0 +1,95 @@
+#ifndef TELEMETRIA_H
+#define TELEMETRIA_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+// Telemetria binária pela USB CDC (mesmo link do printf).
+//
+// Quadro (antes da codificação COBS, terminado por 0x00 na linha):
+//   [versao:1][seq:1][registros...][crc16:2, little-endian]
+// Registro:
+//   [tipo:1][tamanho:1][dados: 'tamanho' bytes, little-endian]
+// O CRC é CRC-16/CCITT-FALSE (poli 0x1021, início 0xFFFF) sobre versão, seq e registros.
+// O decodificador do host está em tools/telemetria_decoder.py.
+
+#ifndef TELEMETRIA_ATIVA
+#define TELEMETRIA_ATIVA 1 // 1: USB transporta quadros binários; 0: apenas logs de texto
+#endif
+
+#define TELEMETRIA_VERSAO 1
+#define TELEMETRIA_QUADRO_MAX 240 // bytes de registros por quadro (antes do COBS)
+
+typedef enum
+{
+  TEL_AMOSTRA = 0x01, // t_ms:u32, agua:u16, chuva:u16, agua_mm:u16, chuva_mmh_x10:u16
+  TEL_ESTADO = 0x02,  // t_ms:u32, anterior:u8, novo:u8
+  TEL_STATS = 0x03,   // t_ms:u32, descartados:u32, quadros:u32, bytes:u32, ocupacao_max:u16
+  TEL_BRUTO = 0x04,   // t_us:u32, periodo_us:u16, pares (adc0:u16, adc1:u16)...
+  TEL_TEXTO = 0x05,   // texto ASCII sem terminador (respostas de comandos)
+  TEL_CANAIS = 0x06,  // t_ms:u32, mascara:u16, eng:i32 para cada bit da máscara (ordem crescente de id)
+  TEL_REINICIO = 0x07, // causa:u8, tarefa:char[4], atraso_ms:u32, ligado_s:u32 (uma vez, no boot)
+  TEL_ALARME = 0x08,   // t_ms:u32, de:u8, para:u8, causa:u8 (alarme_fase_t / alarme_causa_t)
+  TEL_BOOT = 0x09,     // orcamento_ms:u16, t_us:u32 por fase na ordem de boot_fase_t (uma vez, no boot)
+  TEL_TAREFA = 0x0A,   // tarefa:char[4], exec_max_us:u32, ativacoes:u32 (pior ativação, ver supervisor.h)
+  TEL_XIP = 0x0B,      // estagio:u8, na_ram:u8, chamadas:u32, ciclos_medio:u32, ciclos_max:u32, acessos:u32, acertos:u32
+} tel_tipo_t;
+
+typedef struct
+{
+  uint32_t descartados;  // registros perdidos por falta de espaço no anel
+  uint32_t quadros;      // quadros enviados
+  uint32_t bytes;        // bytes enviados na USB (após COBS)
+  uint16_t ocupacao_max; // maior ocupação do anel de registros (bytes)
+} tel_stats_t;
+
+/**
+ * Inicializa o anel de registros. Deve ser chamada antes de qualquer produtor.
+ */
+void telemetria_init(void);
+
+/**
+ * Enfileira um registro sem bloquear. Se não houver espaço, descarta e conta.
+ * Pode ser chamada de qualquer tarefa (não de ISR).
+ */
+bool telemetria_registrar(tel_tipo_t tipo, const void *dados, uint8_t tamanho);
+
+// Atalhos para os registros usados pelo firmware
+void telemetria_amostra(uint32_t t_ms, uint16_t agua, uint16_t chuva, uint16_t agua_mm, uint16_t chuva_mmh_x10);
+void telemetria_estado(uint32_t t_ms, uint8_t anterior, uint8_t novo);
+void telemetria_canais(uint32_t t_ms, uint16_t mascara, const int32_t eng[16]);
+void telemetria_alarme(uint32_t t_ms, uint8_t de, uint8_t para, uint8_t causa);
+void telemetria_reinicio(uint8_t causa, const char tarefa[4], uint32_t atraso_ms, uint32_t ligado_s);
+void telemetria_boot(uint16_t orcamento_ms, const uint32_t *fases_us, uint8_t fases);
+void telemetria_tarefa(const char tarefa[4], uint32_t exec_max_us, uint32_t ativacoes);
+void telemetria_xip(uint8_t estagio, bool na_ram, uint32_t chamadas, uint32_t ciclos_medio, uint32_t ciclos_max,
+                    uint32_t acessos, uint32_t acertos);
+
+/**
+ * Liga a aquisição contínua do ADC0/ADC1 em round-robin a 'hz' pares por
+ * segundo, com DMA para um anel em RAM. A vSensorTask passa a ler o par mais
+ * recente desse anel e a tarefa de telemetria transmite todos os pares.
+ * 'hz' é limitado a 367–250000 (divisor do ADC de 16 bits, 96 ciclos por conversão).
+ */
+void telemetria_bruto_iniciar(uint32_t hz);
+bool telemetria_bruto_ativo(void);
+
+/**
+ * Par mais recente do anel de DMA (ADC0, ADC1). Retorna false se o modo
+ * bruto estiver desligado.
+ */
+bool telemetria_bruto_ultimo(uint16_t *adc0, uint16_t *adc1);
+
+/**
+ * Tarefa que esvazia o anel em quadros COBS e escreve na USB.
+ */
+void vTelemetriaTask(void *params);
+
+void telemetria_stats(tel_stats_t *stats);
+
+// Funções puras usadas pelo firmware e reproduzidas pelo decodificador do host
+uint16_t telemetria_crc16(const uint8_t *dados, size_t tamanho);
+size_t telemetria_cobs(const uint8_t *entrada, size_t tamanho, uint8_t *saida);
+
+#endif
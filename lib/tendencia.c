@@ -0,0 +1,79 @@
+#include "tendencia.h"
+#include <string.h>
+#include "perfil_xip.h"
+
+// Em modo de endereçamento vertical cada coluna ocupa SSD1306_PAGES bytes contíguos.
+static inline uint8_t *coluna(ssd1306_t *ssd, uint8_t x, uint8_t pagina)
+{
+  return &ssd->ram_buffer[SSD1306_INDICE(x, pagina)];
+}
+
+// Escreve uma coluna preenchida de baixo para cima proporcional ao valor (0–4095).
+static void QUENTE(desenha_coluna)(const sparkline_t *s, ssd1306_t *ssd, uint8_t x, uint16_t valor)
+{
+  if (!s->paginas)
+    return;
+  uint8_t altura = s->paginas * 8;
+  uint8_t h = (uint8_t)(((uint32_t)valor * altura) >> 12) + 1; // 1..altura, sem divisão
+
+  // Bit 0 é a linha de cima da região; preenche os h bits de baixo
+  uint32_t mascara = (h >= 32) ? 0xFFFFFFFFu : ((1u << h) - 1u) << (altura - h);
+
+  uint8_t *col = coluna(ssd, x, s->pagina);
+  for (uint8_t p = 0; p < s->paginas; p++)
+    col[p] = (uint8_t)(mascara >> (p * 8));
+}
+
+void sparkline_init(sparkline_t *s, uint8_t x, uint8_t pagina, uint8_t largura, uint8_t paginas,
+                    hist_nivel_t nivel, hist_canal_t canal)
+{
+  s->x = x;
+  s->pagina = pagina;
+  s->largura = largura > WIDTH ? WIDTH : largura;
+  // Recorta contra a geometria do painel (no 128x32 a região pode não caber)
+  if (paginas > 4)
+    paginas = 4;
+  s->paginas = pagina >= SSD1306_PAGES ? 0 : (paginas > SSD1306_PAGES - pagina ? SSD1306_PAGES - pagina : paginas);
+  s->nivel = nivel;
+  s->canal = canal;
+  s->visto = 0;
+}
+
+void sparkline_redesenhar(sparkline_t *s, ssd1306_t *ssd, const historico_t *h)
+{
+  uint16_t valores[128];
+  size_t n = historico_copiar(h, s->nivel, s->canal, valores, s->largura, &s->visto);
+
+  // Colunas sem histórico ficam apagadas à esquerda
+  uint8_t vazias = s->largura - (uint8_t)n;
+  for (uint8_t i = 0; i < vazias; i++)
+    memset(coluna(ssd, s->x + i, s->pagina), 0, s->paginas);
+  for (size_t i = 0; i < n; i++)
+    desenha_coluna(s, ssd, s->x + vazias + i, valores[i]);
+}
+
+bool sparkline_atualizar(sparkline_t *s, ssd1306_t *ssd, const historico_t *h)
+{
+  uint32_t novas = historico_total(h, s->nivel) - s->visto;
+  if (novas == 0)
+    return false;
+  if (novas >= s->largura)
+  {
+    sparkline_redesenhar(s, ssd, h);
+    return true;
+  }
+
+  uint16_t valores[128];
+  size_t n = historico_copiar(h, s->nivel, s->canal, valores, novas, &s->visto);
+
+  // Desloca as colunas existentes n posições para a esquerda, byte a byte
+  for (uint8_t x = s->x; x + n < s->x + s->largura; x++)
+    memcpy(coluna(ssd, x, s->pagina), coluna(ssd, x + n, s->pagina), s->paginas);
+
+  // Desenha apenas as colunas recém-deslocadas para dentro da região
+  uint8_t primeira = s->x + s->largura - (uint8_t)n;
+  for (size_t i = 0; i < n; i++)
+    desenha_coluna(s, ssd, primeira + i, valores[i]);
+
+  return true;
+}
@@ -0,0 +1,31 @@
+#ifndef TENDENCIA_H
+#define TENDENCIA_H
+
+#include "ssd1306.h"
+#include "historico.h"
+
+// Gráfico de tendência (sparkline) desenhado direto nos bytes de coluna do ram_buffer.
+// Ocupa as colunas x..x+largura-1 e as páginas pagina..pagina+paginas-1 (até 4 páginas).
+typedef struct
+{
+  uint8_t x, pagina, largura, paginas;
+  hist_nivel_t nivel;
+  hist_canal_t canal;
+  uint32_t visto; // total do nível já desenhado
+} sparkline_t;
+
+void sparkline_init(sparkline_t *s, uint8_t x, uint8_t pagina, uint8_t largura, uint8_t paginas,
+                    hist_nivel_t nivel, hist_canal_t canal);
+
+/**
+ * Redesenha todas as colunas a partir do histórico (usado ao entrar na tela).
+ */
+void sparkline_redesenhar(sparkline_t *s, ssd1306_t *ssd, const historico_t *h);
+
+/**
+ * Desloca a região pelas amostras novas e desenha somente as colunas novas.
+ * Retorna true se algo mudou no buffer.
+ */
+bool sparkline_atualizar(sparkline_t *s, ssd1306_t *ssd, const historico_t *h);
+
+#endif
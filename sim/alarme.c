@@ -0,0 +1,174 @@
+/*
+ * Reprodução de traços no gerenciador de alarme do GuardaChuvas
+ *
+ * Alimenta lib/alarme.c (o mesmo código do firmware) com um traço de
+ * eventos e um relógio simulado no lugar dos software timers do FreeRTOS,
+ * e imprime cada transição. Serve para conferir o silêncio, a escalada e a
+ * limpeza com sequências gravadas ou escritas à mão, sem a placa. Os
+ * parâmetros passam pelo config_valida do firmware: o que a placa recusaria
+ * (silêncio ou limpeza zero, por exemplo) também é recusado aqui.
+ *
+ * Uso:
+ *   make -C sim
+ *   ./sim/alarme sim/alarme_exemplo.csv
+ *   ./sim/alarme -s 600 -l 30 -u 10 traco.csv
+ *
+ * Traço (CSV, '#' comenta):
+ *   t_ms,amostra,<risco>,<nivel_agua_pct>   risco: 0–2 ou SEGURO/ALERTA/ENCHENTE
+ *   t_ms,reconhecer
+ * Saída: transicao,t_ms,de,para,causa
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <unistd.h>
+#include "alarme.h"
+#include "config.h"
+
+#define SEM_PRAZO UINT64_MAX
+
+typedef struct
+{
+  uint64_t agora_ms;
+  uint64_t vence_ms[ALARME_TEMPORIZADORES]; // SEM_PRAZO = desarmado
+  uint32_t transicoes;
+} relogio_t;
+
+static void temporizador(void *ctx, alarme_temp_t temp, uint32_t ms)
+{
+  relogio_t *r = ctx;
+  r->vence_ms[temp] = ms ? r->agora_ms + ms : SEM_PRAZO;
+}
+
+static void transicao(void *ctx, alarme_fase_t de, alarme_fase_t para, alarme_causa_t causa)
+{
+  relogio_t *r = ctx;
+  printf("transicao,%llu,%s,%s,%s\n", (unsigned long long)r->agora_ms, ALARME_NOME_FASE[de], ALARME_NOME_FASE[para],
+         ALARME_NOME_CAUSA[causa]);
+  r->transicoes++;
+}
+
+// Dispara, em ordem, os temporizadores que vencem até 't_ms'
+static void avanca(alarme_t *a, relogio_t *r, uint64_t t_ms)
+{
+  while (true)
+  {
+    int prox = -1;
+    for (int i = 0; i < ALARME_TEMPORIZADORES; i++)
+      if (r->vence_ms[i] <= t_ms && (prox < 0 || r->vence_ms[i] < r->vence_ms[prox]))
+        prox = i;
+    if (prox < 0)
+      break;
+    r->agora_ms = r->vence_ms[prox];
+    r->vence_ms[prox] = SEM_PRAZO;
+    alarme_expirou(a, (alarme_temp_t)prox);
+  }
+  r->agora_ms = t_ms;
+}
+
+static int le_risco(const char *s)
+{
+  static const char *const NOMES[] = {"SEGURO", "ALERTA", "ENCHENTE"};
+  for (int i = 0; i < 3; i++)
+    if (strcmp(s, NOMES[i]) == 0)
+      return i;
+  char *fim;
+  long v = strtol(s, &fim, 10);
+  return (*fim == '\0' && v >= SEGURO && v <= ENCHENTE) ? (int)v : -1;
+}
+
+static void uso(const char *nome)
+{
+  fprintf(stderr,
+          "uso: %s [-s silencio_s] [-l limpeza_s] [-u subida_pct] traco.csv\n"
+          "  padrões iguais aos da configuração do firmware (600 s, 30 s, 10 %%)\n",
+          nome);
+  exit(2);
+}
+
+int main(int argc, char **argv)
+{
+  config_t cfg;
+  config_padrao(&cfg);
+  int op;
+  while ((op = getopt(argc, argv, "s:l:u:h")) != -1)
+  {
+    switch (op)
+    {
+    case 's': cfg.alarme_silencio_s = (uint16_t)atol(optarg); break;
+    case 'l': cfg.alarme_limpeza_s = (uint16_t)atol(optarg); break;
+    case 'u': cfg.alarme_subida_pct = (uint8_t)atoi(optarg); break;
+    default: uso(argv[0]);
+    }
+  }
+  if (optind != argc - 1)
+    uso(argv[0]);
+  if (!config_valida(&cfg))
+  {
+    fprintf(stderr, "parâmetros recusados pelo config_valida (silêncio e limpeza > 0, subida 1–100%%)\n");
+    return 2;
+  }
+  alarme_param_t p = {(uint32_t)cfg.alarme_silencio_s * 1000, (uint32_t)cfg.alarme_limpeza_s * 1000,
+                      cfg.alarme_subida_pct};
+
+  FILE *f = strcmp(argv[optind], "-") == 0 ? stdin : fopen(argv[optind], "r");
+  if (!f)
+  {
+    perror(argv[optind]);
+    return 1;
+  }
+
+  relogio_t r = {0};
+  for (int i = 0; i < ALARME_TEMPORIZADORES; i++)
+    r.vence_ms[i] = SEM_PRAZO;
+  alarme_t a;
+  alarme_init(&a, &p, temporizador, transicao, &r);
+
+  char linha[128];
+  unsigned num = 0, erros = 0;
+  while (fgets(linha, sizeof(linha), f))
+  {
+    num++;
+    linha[strcspn(linha, "\r\n")] = '\0';
+    if (linha[0] == '#' || linha[0] == '\0')
+      continue;
+
+    char *campos[4] = {0};
+    int n = 0;
+    for (char *c = strtok(linha, ","); c && n < 4; c = strtok(NULL, ","))
+      campos[n++] = c;
+
+    uint64_t t = n > 0 ? strtoull(campos[0], NULL, 10) : 0;
+    if (n < 2 || t < r.agora_ms)
+    {
+      fprintf(stderr, "linha %u: evento inválido ou fora de ordem\n", num);
+      erros++;
+      continue;
+    }
+    avanca(&a, &r, t);
+
+    if (strcmp(campos[1], "amostra") == 0 && n == 4 && le_risco(campos[2]) >= 0)
+    {
+      alarme_amostra(&a, (alert_state_t)le_risco(campos[2]), (uint8_t)atoi(campos[3]));
+    }
+    else if (strcmp(campos[1], "reconhecer") == 0)
+    {
+      alarme_reconhecer(&a);
+    }
+    else
+    {
+      fprintf(stderr, "linha %u: evento desconhecido '%s'\n", num, campos[1]);
+      erros++;
+    }
+  }
+  if (f != stdin)
+    fclose(f);
+
+  // Deixa vencer o que ainda estiver armado
+  avanca(&a, &r, SEM_PRAZO - 1);
+  fprintf(stderr, "%u transições, fase final: %s, %u linhas com erro\n", r.transicoes, ALARME_NOME_FASE[a.fase], erros);
+  return erros ? 1 : 0;
+}
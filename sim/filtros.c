@@ -0,0 +1,164 @@
+/*
+ * Bancada do banco de filtros do GuardaChuvas no host
+ *
+ * Mede o custo por amostra de cada estágio de lib/filtros.c (o mesmo código
+ * do firmware) e da cadeia padrão dos canais, e mostra o efeito sobre o
+ * sinal de teste: quanto cada saída se afasta da rampa limpa e quantas vezes
+ * cruza um limiar (cada cruzamento seria uma troca de estado e um bipe).
+ * No alvo, a mesma bancada roda no boot com -DFILTROS_MEDIR=1.
+ *
+ * Uso:
+ *   make -C sim
+ *   ./sim/filtros [-n amostras]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <time.h>
+#include "filtros.h"
+
+#define LIMIAR 2048       // limiar de teste no meio da escala
+#define PERIODO_MS 100    // período padrão da vSensorTask
+
+static uint32_t relogio_ns(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint32_t)((uint64_t)ts.tv_sec * 1000000000u + ts.tv_nsec);
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+static uint32_t relogio_ciclos(void)
+{
+  return (uint32_t)__builtin_ia32_rdtsc();
+}
+#define TEM_CICLOS 1
+#else
+#define TEM_CICLOS 0
+#endif
+
+// Cadeia padrão da chuva e do nível de água, como um estágio só
+typedef struct
+{
+  filtro_mediana_t mediana;
+  filtro_ema_q15_t ema;
+  filtro_biquad_t biquad;
+} cadeia_t;
+
+static uint16_t cadeia_chuva(void *estado, uint16_t x)
+{
+  cadeia_t *c = estado;
+  return filtro_ema_q15(&c->ema, filtro_mediana(&c->mediana, x));
+}
+
+static uint16_t cadeia_agua(void *estado, uint16_t x)
+{
+  cadeia_t *c = estado;
+  return filtro_biquad(&c->biquad, filtro_mediana(&c->mediana, x));
+}
+
+static uint16_t identidade(void *estado, uint16_t x)
+{
+  (void)estado;
+  return x;
+}
+
+typedef struct
+{
+  const char *nome;
+  sensor_filtro_fn fn;
+} estagio_t;
+
+static const estagio_t ESTAGIOS[] = {
+    {"identidade", identidade},
+    {"mediana 3", filtro_mediana},
+    {"mediana 5", filtro_mediana},
+    {"mediana 9", filtro_mediana},
+    {"ema q15", filtro_ema_q15},
+    {"biquad q14", filtro_biquad},
+    {"cadeia chuva", cadeia_chuva},
+    {"cadeia agua", cadeia_agua},
+};
+#define TOTAL_ESTAGIOS (sizeof(ESTAGIOS) / sizeof(ESTAGIOS[0]))
+
+// Estado novo de cada estágio, na configuração padrão
+static void prepara(unsigned i, cadeia_t *c)
+{
+  static const uint8_t JANELA[] = {0, 3, 5, 9};
+  memset(c, 0, sizeof(*c));
+  filtro_mediana_init(&c->mediana, i >= 1 && i <= 3 ? JANELA[i] : FILTRO_PADRAO_MEDIANA);
+  filtro_ema_q15_init(&c->ema, FILTRO_PADRAO_ALFA);
+  filtro_biquad_passa_baixa(&c->biquad, FILTRO_PADRAO_CORTE_HZ, 1000.0f / PERIODO_MS);
+}
+
+static void *estado_de(unsigned i, cadeia_t *c)
+{
+  switch (i)
+  {
+  case 4: return &c->ema;
+  case 5: return &c->biquad;
+  case 6:
+  case 7: return c;
+  default: return &c->mediana;
+  }
+}
+
+static void uso(const char *nome)
+{
+  fprintf(stderr, "uso: %s [-n amostras]\n", nome);
+  exit(2);
+}
+
+int main(int argc, char **argv)
+{
+  uint32_t n = 1000000;
+  int op;
+  while ((op = getopt(argc, argv, "n:h")) != -1)
+  {
+    switch (op)
+    {
+    case 'n': n = (uint32_t)strtoul(optarg, NULL, 10); break;
+    default: uso(argv[0]);
+    }
+  }
+  if (!n)
+    uso(argv[0]);
+
+  printf("%-14s %10s %10s %10s %10s\n", "estagio", "ns/amostra", TEM_CICLOS ? "ciclos" : "-", "erro max", "cruzamentos");
+  for (unsigned i = 0; i < TOTAL_ESTAGIOS; i++)
+  {
+    cadeia_t c;
+    prepara(i, &c);
+    filtros_bancada(ESTAGIOS[i].fn, estado_de(i, &c), n / 10 + 1, relogio_ns); // aquece caches e preditor
+    double ns = (double)filtros_bancada(ESTAGIOS[i].fn, estado_de(i, &c), n, relogio_ns) / n;
+    double ciclos = 0;
+#if TEM_CICLOS
+    ciclos = (double)filtros_bancada(ESTAGIOS[i].fn, estado_de(i, &c), n, relogio_ciclos) / n;
+#endif
+
+    // Efeito no sinal de teste: desvio da rampa limpa (depois do atraso do
+    // filtro) e cruzamentos do limiar em um ciclo completo do triângulo
+    prepara(i, &c);
+    int erro_max = 0;
+    unsigned cruzamentos = 0;
+    int acima = -1;
+    for (uint32_t k = 0; k < 8192; k++)
+    {
+      int y = ESTAGIOS[i].fn(estado_de(i, &c), filtros_sinal_teste(k));
+      uint32_t fase = k & 8191;
+      int limpo = fase < 4096 ? (int)fase : (int)(8191 - fase);
+      int erro = abs(y - limpo);
+      if (k > 64 && erro > erro_max)
+        erro_max = erro;
+      int agora = y >= LIMIAR;
+      if (acima >= 0 && agora != acima)
+        cruzamentos++;
+      acima = agora;
+    }
+    printf("%-14s %10.1f %10.1f %10d %10u\n", ESTAGIOS[i].nome, ns, ciclos, erro_max, cruzamentos);
+  }
+  return 0;
+}
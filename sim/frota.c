@@ -0,0 +1,560 @@
+/*
+ * Simulador de frota do GuardaChuvas
+ *
+ * Roda a cadeia de processamento de cada estação (filtros, calibração, classificação,
+ * histórico em cascata, tendência no OLED e animação da matriz) para milhares
+ * de estações virtuais em um único processo no Linux, com as mesmas
+ * bibliotecas de lib/ que vão para o firmware. Cada estação tem sua própria
+ * alimentação (sintética ou reprodução de uma captura da telemetria) e as
+ * estações são distribuídas entre as threads com roubo de trabalho.
+ *
+ * Uso:
+ *   make -C sim
+ *   ./sim/frota -n 2000 -d 3600 -t linhas.csv
+ *   ./sim/frota -r sessao.csv        (CSV de tools/telemetria_decoder.py)
+ *
+ * Fica de fora o que o firmware ainda mantém como instância única:
+ * system_state/tela_atual/historico (GuardaChuvas.c), o anel da telemetria
+ * (telemetria.c) e a configuração ativa (config.c).
+ * A cola entre as bibliotecas (estacao_amostra) espelha a vSensorTask e a
+ * vMatrixTask.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <time.h>
+#include "config.h"
+#include "calibracao.h"
+#include "filtros.h"
+#include "alerta.h"
+#include "historico.h"
+#include "tendencia.h"
+#include "animador.h"
+#include "anim_linhas.h"
+
+#define PERIODO_MS 100           // período padrão da vSensorTask
+#define QUADRO_MS 20             // relógio de quadros da vMatrixTask
+#define FADE_NIVEL_MS 300
+#define FADE_ESTADO_MS 500
+#define RODADA_S 60              // tempo simulado por item de trabalho
+#define AMOSTRAS_RODADA (RODADA_S * 1000 / PERIODO_MS)
+
+static const char *const NOME_ESTADO[] = {"SEGURO", "ALERTA", "ENCHENTE"};
+
+/* === Estação === */
+
+typedef struct
+{
+  uint32_t t_ms;
+  uint8_t de, para;
+} transicao_t;
+
+typedef struct
+{
+  // Estado que o firmware mantém por estação
+  historico_t hist;
+  filtro_mediana_t mediana_agua, mediana_chuva;
+  filtro_ema_q15_t ema_chuva;
+  filtro_biquad_t biquad_agua;
+  calib_canal_t cal_agua, cal_chuva;
+  ssd1306_t ssd;
+  sparkline_t spark_agua, spark_chuva;
+  animador_t anim;
+  uint8_t faixa, estado;
+
+  // Alimentação sintética
+  uint32_t rng;
+  int32_t agua_q8;        // nível simulado em Q8
+  int32_t chuva;          // intensidade atual
+  int32_t chuva_alvo;     // intensidade da tempestade (0 = sem chuva)
+  uint32_t chuva_restante; // amostras até o fim da tempestade
+  uint16_t prob_tempestade; // chance por amostra, em 1/65536
+
+  // Reprodução
+  uint32_t replay_pos;
+
+  // Resultados
+  uint32_t t_ms;
+  uint64_t amostras;
+  uint32_t soma_quadros;   // impede que o compilador descarte a composição
+  transicao_t *linha;
+  uint32_t n_linha, cap_linha;
+} estacao_t;
+
+static config_t cfg;
+static uint16_t *replay_agua, *replay_chuva;
+static uint32_t replay_total;
+
+static uint32_t xorshift(uint32_t *s)
+{
+  uint32_t x = *s;
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  return *s = x;
+}
+
+static void estacao_init(estacao_t *e, uint32_t id, uint32_t semente)
+{
+  memset(e, 0, sizeof(*e));
+  historico_init(&e->hist);
+  calib_preparar(&e->cal_agua, cfg.cal_offset[0], cfg.cal_ganho_q12[0], cfg.cal_fundo_escala[0]);
+  calib_preparar(&e->cal_chuva, cfg.cal_offset[1], cfg.cal_ganho_q12[1], cfg.cal_fundo_escala[1]);
+  filtro_mediana_init(&e->mediana_agua, FILTRO_PADRAO_MEDIANA);
+  filtro_mediana_init(&e->mediana_chuva, FILTRO_PADRAO_MEDIANA);
+  filtro_ema_q15_init(&e->ema_chuva, FILTRO_PADRAO_ALFA);
+  filtro_biquad_passa_baixa(&e->biquad_agua, FILTRO_PADRAO_CORTE_HZ, 1000.0f / PERIODO_MS);
+
+  ssd1306_init(&e->ssd, false, 0x3C, NULL);
+  sparkline_init(&e->spark_agua, 0, 1, 128, 3, HIST_10HZ, HIST_AGUA);
+  sparkline_init(&e->spark_chuva, 0, 5, 128, 3, HIST_10HZ, HIST_CHUVA);
+  animador_init(&e->anim, cfg.matriz_brilho);
+  e->faixa = 0xFF;
+  e->estado = SEGURO;
+
+  e->rng = (semente ^ (id * 2654435761u)) | 1;
+  e->prob_tempestade = 2 + xorshift(&e->rng) % 20; // de ~1 a ~10 tempestades por hora
+  if (replay_total)
+    e->replay_pos = (id * 7919u) % replay_total;
+}
+
+static void estacao_liberar(estacao_t *e)
+{
+  free(e->linha);
+}
+
+// Chuva em tempestades com intensidade e duração sorteadas; água acumula e drena
+static void alimentacao_sintetica(estacao_t *e, uint16_t *agua, uint16_t *chuva)
+{
+  uint32_t r = xorshift(&e->rng);
+
+  if (e->chuva_restante == 0)
+  {
+    e->chuva_alvo = 0;
+    if ((r & 0xFFFF) < e->prob_tempestade)
+    {
+      e->chuva_alvo = 500 + (int32_t)((r >> 16) % 3596);
+      e->chuva_restante = 600 + (xorshift(&e->rng) % 12000); // 1 a 21 min
+    }
+  }
+  else
+  {
+    e->chuva_restante--;
+  }
+
+  e->chuva += (e->chuva_alvo - e->chuva) >> 4;
+  e->agua_q8 += (e->chuva * 22) >> 8;
+  e->agua_q8 -= e->agua_q8 >> 12;
+  if (e->agua_q8 > (CALIB_ADC_MAX << 8))
+    e->agua_q8 = CALIB_ADC_MAX << 8;
+
+  int32_t ruido = (int32_t)((r >> 8) & 63) - 32;
+  int32_t c = e->chuva + ruido;
+  *chuva = (uint16_t)(c < 0 ? 0 : c > CALIB_ADC_MAX ? CALIB_ADC_MAX : c);
+  *agua = (uint16_t)(e->agua_q8 >> 8);
+}
+
+static void registra_transicao(estacao_t *e, uint8_t para)
+{
+  if (e->n_linha == e->cap_linha)
+  {
+    e->cap_linha = e->cap_linha ? e->cap_linha * 2 : 8;
+    e->linha = realloc(e->linha, e->cap_linha * sizeof(transicao_t));
+    if (e->linha == NULL)
+    {
+      perror("realloc");
+      exit(1);
+    }
+  }
+  e->linha[e->n_linha++] = (transicao_t){e->t_ms, e->estado, para};
+}
+
+// Uma amostra da vSensorTask seguida do que o display e a matriz fazem com ela
+static void estacao_amostra(estacao_t *e, uint16_t agua, uint16_t chuva)
+{
+  agua = filtro_biquad(&e->biquad_agua, filtro_mediana(&e->mediana_agua, agua));
+  chuva = filtro_ema_q15(&e->ema_chuva, filtro_mediana(&e->mediana_chuva, chuva));
+
+  calib_saida_t a, c;
+  calib_converter(&e->cal_agua, agua, &a);
+  calib_converter(&e->cal_chuva, chuva, &c);
+
+  alert_state_t estado = alerta_classificar(a.pct, c.pct, &cfg);
+  if (estado != e->estado)
+  {
+    registra_transicao(e, estado);
+    animador_trocar(&e->anim, 1, LINHA_ESTADO[estado], FADE_ESTADO_MS);
+    e->estado = estado;
+  }
+
+  historico_registrar(&e->hist, a.cal, c.cal);
+
+  // Display na tela de tendência de 1 minuto
+  sparkline_atualizar(&e->spark_agua, &e->ssd, &e->hist);
+  sparkline_atualizar(&e->spark_chuva, &e->ssd, &e->hist);
+
+  // Matriz: troca de linhas do tempo e quadros até a próxima amostra
+  uint8_t faixa = anim_faixa_nivel(a.pct);
+  if (faixa != e->faixa)
+  {
+    animador_trocar(&e->anim, 0, &LINHA_NIVEL[faixa], FADE_NIVEL_MS);
+    e->faixa = faixa;
+  }
+
+  uint8_t quadro[ANIM_LEDS][3];
+  for (int q = 0; q < PERIODO_MS / QUADRO_MS; q++)
+  {
+    animador_quadro(&e->anim, QUADRO_MS, quadro);
+    e->soma_quadros += quadro[12][0] + quadro[12][1] + quadro[12][2];
+  }
+
+  e->t_ms += PERIODO_MS;
+  e->amostras++;
+}
+
+static void estacao_rodada(estacao_t *e)
+{
+  for (int i = 0; i < AMOSTRAS_RODADA; i++)
+  {
+    uint16_t agua, chuva;
+    if (replay_total)
+    {
+      agua = replay_agua[e->replay_pos];
+      chuva = replay_chuva[e->replay_pos];
+      if (++e->replay_pos == replay_total)
+        e->replay_pos = 0;
+    }
+    else
+    {
+      alimentacao_sintetica(e, &agua, &chuva);
+    }
+    estacao_amostra(e, agua, chuva);
+  }
+}
+
+/* === Reprodução de capturas === */
+
+// Lê as linhas "amostra,t,agua,chuva,..." do CSV do decodificador da telemetria
+static bool carrega_replay(const char *caminho)
+{
+  FILE *f = fopen(caminho, "r");
+  if (f == NULL)
+  {
+    perror(caminho);
+    return false;
+  }
+
+  uint32_t cap = 0;
+  char linha[256];
+  while (fgets(linha, sizeof(linha), f))
+  {
+    unsigned long t;
+    unsigned agua, chuva;
+    if (sscanf(linha, "amostra,%lu,%u,%u", &t, &agua, &chuva) != 3)
+      continue;
+    if (replay_total == cap)
+    {
+      cap = cap ? cap * 2 : 4096;
+      replay_agua = realloc(replay_agua, cap * sizeof(uint16_t));
+      replay_chuva = realloc(replay_chuva, cap * sizeof(uint16_t));
+      if (replay_agua == NULL || replay_chuva == NULL)
+      {
+        perror("realloc");
+        exit(1);
+      }
+    }
+    replay_agua[replay_total] = agua > CALIB_ADC_MAX ? CALIB_ADC_MAX : agua;
+    replay_chuva[replay_total] = chuva > CALIB_ADC_MAX ? CALIB_ADC_MAX : chuva;
+    replay_total++;
+  }
+  fclose(f);
+
+  if (replay_total == 0)
+  {
+    fprintf(stderr, "%s: nenhuma linha 'amostra'\n", caminho);
+    return false;
+  }
+  return true;
+}
+
+/* === Pool de threads com roubo de trabalho === */
+
+// Deque por thread: o dono retira do fim, os ladrões retiram do início
+typedef struct
+{
+  pthread_mutex_t trava;
+  uint32_t *itens;
+  uint32_t inicio, fim;
+  uint64_t executados, roubados;
+} deque_t;
+
+static estacao_t *estacoes;
+static uint32_t num_estacoes;
+static deque_t *deques;
+static int num_threads;
+static pthread_barrier_t barreira_inicio, barreira_fim;
+static volatile bool encerrar;
+
+static bool retira_proprio(deque_t *d, uint32_t *id)
+{
+  bool ok = false;
+  pthread_mutex_lock(&d->trava);
+  if (d->fim > d->inicio)
+  {
+    *id = d->itens[--d->fim];
+    ok = true;
+  }
+  pthread_mutex_unlock(&d->trava);
+  return ok;
+}
+
+static bool rouba(int ladrao, uint32_t *id)
+{
+  for (int k = 1; k < num_threads; k++)
+  {
+    deque_t *d = &deques[(ladrao + k) % num_threads];
+    pthread_mutex_lock(&d->trava);
+    bool ok = d->fim > d->inicio;
+    if (ok)
+      *id = d->itens[d->inicio++];
+    pthread_mutex_unlock(&d->trava);
+    if (ok)
+      return true;
+  }
+  return false;
+}
+
+static void *trabalhador(void *arg)
+{
+  int w = (int)(intptr_t)arg;
+  deque_t *d = &deques[w];
+
+  while (true)
+  {
+    pthread_barrier_wait(&barreira_inicio);
+    if (encerrar)
+      break;
+
+    uint32_t id;
+    while (true)
+    {
+      if (retira_proprio(d, &id))
+        d->executados++;
+      else if (rouba(w, &id))
+        d->roubados++;
+      else
+        break;
+      estacao_rodada(&estacoes[id]);
+    }
+    pthread_barrier_wait(&barreira_fim);
+  }
+  return NULL;
+}
+
+// Cada thread recebe um bloco contíguo de estações; o desequilíbrio é corrigido por roubo
+static void distribui(void)
+{
+  uint32_t por_thread = (num_estacoes + num_threads - 1) / num_threads;
+  for (int w = 0; w < num_threads; w++)
+  {
+    deque_t *d = &deques[w];
+    uint32_t primeiro = w * por_thread;
+    uint32_t ultimo = primeiro + por_thread > num_estacoes ? num_estacoes : primeiro + por_thread;
+    d->inicio = 0;
+    d->fim = 0;
+    for (uint32_t id = primeiro; id < ultimo; id++)
+      d->itens[d->fim++] = id;
+  }
+}
+
+/* === Relatórios === */
+
+static double agora_s(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static long rss_kib(void)
+{
+  long total, paginas = 0;
+  FILE *f = fopen("/proc/self/statm", "r");
+  if (f != NULL)
+  {
+    if (fscanf(f, "%ld %ld", &total, &paginas) != 2)
+      paginas = 0;
+    fclose(f);
+  }
+  return paginas * (sysconf(_SC_PAGESIZE) / 1024);
+}
+
+static void relatorio(double segundos, uint32_t rodadas)
+{
+  uint64_t amostras = 0, linha_bytes = 0, transicoes = 0, executados = 0, roubados = 0;
+  uint32_t com_enchente = 0;
+  for (uint32_t i = 0; i < num_estacoes; i++)
+  {
+    estacao_t *e = &estacoes[i];
+    amostras += e->amostras;
+    transicoes += e->n_linha;
+    linha_bytes += e->cap_linha * sizeof(transicao_t);
+    for (uint32_t k = 0; k < e->n_linha; k++)
+      if (e->linha[k].para == ENCHENTE)
+      {
+        com_enchente++;
+        break;
+      }
+  }
+  for (int w = 0; w < num_threads; w++)
+  {
+    executados += deques[w].executados;
+    roubados += deques[w].roubados;
+  }
+
+  size_t display = sizeof(ssd1306_t) + 2 * sizeof(sparkline_t);
+  size_t por_estacao = sizeof(estacao_t);
+
+  printf("estacoes            %u (%s)\n", num_estacoes, replay_total ? "reproducao" : "sinteticas");
+  printf("threads             %d\n", num_threads);
+  printf("tempo simulado      %u s por estacao\n", rodadas * RODADA_S);
+  printf("tempo real          %.2f s\n", segundos);
+  printf("amostras            %llu\n", (unsigned long long)amostras);
+  printf("amostras/s          %.0f\n", amostras / segundos);
+  printf("itens de trabalho   %llu proprios, %llu roubados\n",
+         (unsigned long long)executados, (unsigned long long)roubados);
+  printf("transicoes          %llu (%u estacoes chegaram a ENCHENTE)\n",
+         (unsigned long long)transicoes, com_enchente);
+  printf("memoria/estacao     %zu bytes fixos + %.0f bytes de linha do tempo (media)\n",
+         por_estacao, (double)linha_bytes / num_estacoes);
+  printf("  historico         %zu\n", sizeof(historico_t));
+  printf("  display           %zu (buffer do OLED + sparklines)\n", display);
+  printf("  animador          %zu\n", sizeof(animador_t));
+  printf("  calibracao        %zu\n", 2 * sizeof(calib_canal_t));
+  printf("RSS do processo     %ld KiB\n", rss_kib());
+}
+
+static bool grava_linhas(const char *caminho)
+{
+  FILE *f = fopen(caminho, "w");
+  if (f == NULL)
+  {
+    perror(caminho);
+    return false;
+  }
+  fprintf(f, "estacao,t_ms,de,para\n");
+  for (uint32_t i = 0; i < num_estacoes; i++)
+    for (uint32_t k = 0; k < estacoes[i].n_linha; k++)
+    {
+      const transicao_t *t = &estacoes[i].linha[k];
+      fprintf(f, "%u,%u,%s,%s\n", i, t->t_ms, NOME_ESTADO[t->de], NOME_ESTADO[t->para]);
+    }
+  fclose(f);
+  return true;
+}
+
+/* === Principal === */
+
+static void uso(const char *prog)
+{
+  fprintf(stderr,
+          "uso: %s [-n estacoes] [-d segundos] [-j threads] [-s semente] [-r captura.csv] [-t linhas.csv]\n",
+          prog);
+  exit(2);
+}
+
+int main(int argc, char **argv)
+{
+  uint32_t duracao_s = 3600, semente = 1;
+  const char *arquivo_replay = NULL, *arquivo_linhas = NULL;
+  num_estacoes = 1000;
+  num_threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+
+  int opt;
+  while ((opt = getopt(argc, argv, "n:d:j:s:r:t:h")) != -1)
+  {
+    switch (opt)
+    {
+    case 'n':
+      num_estacoes = (uint32_t)strtoul(optarg, NULL, 0);
+      break;
+    case 'd':
+      duracao_s = (uint32_t)strtoul(optarg, NULL, 0);
+      break;
+    case 'j':
+      num_threads = atoi(optarg);
+      break;
+    case 's':
+      semente = (uint32_t)strtoul(optarg, NULL, 0);
+      break;
+    case 'r':
+      arquivo_replay = optarg;
+      break;
+    case 't':
+      arquivo_linhas = optarg;
+      break;
+    default:
+      uso(argv[0]);
+    }
+  }
+  if (num_estacoes == 0 || num_threads < 1 || duracao_s < RODADA_S)
+    uso(argv[0]);
+
+  config_padrao(&cfg);
+  if (arquivo_replay && !carrega_replay(arquivo_replay))
+    return 1;
+
+  estacoes = malloc(num_estacoes * sizeof(estacao_t));
+  deques = calloc(num_threads, sizeof(deque_t));
+  if (estacoes == NULL || deques == NULL)
+  {
+    perror("malloc");
+    return 1;
+  }
+  for (uint32_t i = 0; i < num_estacoes; i++)
+    estacao_init(&estacoes[i], i, semente);
+
+  pthread_barrier_init(&barreira_inicio, NULL, num_threads + 1);
+  pthread_barrier_init(&barreira_fim, NULL, num_threads + 1);
+  pthread_t *threads = malloc(num_threads * sizeof(pthread_t));
+  for (int w = 0; w < num_threads; w++)
+  {
+    pthread_mutex_init(&deques[w].trava, NULL);
+    deques[w].itens = malloc(num_estacoes * sizeof(uint32_t));
+    pthread_create(&threads[w], NULL, trabalhador, (void *)(intptr_t)w);
+  }
+
+  uint32_t rodadas = duracao_s / RODADA_S;
+  double t0 = agora_s();
+  for (uint32_t r = 0; r < rodadas; r++)
+  {
+    distribui();
+    pthread_barrier_wait(&barreira_inicio);
+    pthread_barrier_wait(&barreira_fim);
+  }
+  double segundos = agora_s() - t0;
+
+  encerrar = true;
+  pthread_barrier_wait(&barreira_inicio);
+  for (int w = 0; w < num_threads; w++)
+    pthread_join(threads[w], NULL);
+
+  relatorio(segundos, rodadas);
+  int ret = (arquivo_linhas && !grava_linhas(arquivo_linhas)) ? 1 : 0;
+
+  for (uint32_t i = 0; i < num_estacoes; i++)
+    estacao_liberar(&estacoes[i]);
+  for (int w = 0; w < num_threads; w++)
+    free(deques[w].itens);
+  free(threads);
+  free(deques);
+  free(estacoes);
+  free(replay_agua);
+  free(replay_chuva);
+  return ret;
+}
@@ -0,0 +1,309 @@
+/*
+ * Conferência da geometria do OLED (lib/ssd1306.c) no host
+ *
+ * Compilado uma vez para cada SSD1306_GEOMETRIA. Um painel emulado recebe as
+ * escritas I2C do driver (endereçamento vertical do SSD1306, por página no
+ * SH1106 com a RAM de 132 colunas) e o programa confere:
+ *   - cada (x, y) acende exatamente o bit y & 7 do byte SSD1306_INDICE(x, y >> 3);
+ *   - o quadro inteiro e a região de uma coluna/página levam esse pixel à
+ *     coluna x + SSD1306_COLUNA0 e à página y >> 3 do painel;
+ *   - coordenadas fora do painel não escrevem no buffer;
+ *   - com o buffer cheio, nenhuma coluna fora da faixa visível é escrita;
+ *   - linhas, retângulos e caracteres batem com um modelo pixel a pixel.
+ *
+ * Uso:
+ *   make -C sim teste
+ *   ./sim/geometria_0   (0 = SSD1306 128x64, 1 = SSD1306 128x32, 2 = SH1106 132x64)
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "ssd1306.h"
+#include "font.h"
+
+#define PAINEL_COLUNAS 132
+#define PAINEL_PAGINAS 8
+
+/* === Painel emulado === */
+
+static struct
+{
+  uint8_t ram[PAINEL_PAGINAS][PAINEL_COLUNAS];
+  uint8_t modo; // 0 horizontal, 1 vertical, 2 página (padrão após o reset)
+  uint8_t col_ini, col_fim, pag_ini, pag_fim;
+  uint8_t col, pag;
+} painel;
+
+static int falhas;
+
+#define CONFERE(cond, ...)             \
+  do                                   \
+  {                                    \
+    if (!(cond) && falhas++ < 20)      \
+    {                                  \
+      printf("FALHA: " __VA_ARGS__);   \
+      printf("\n");                    \
+    }                                  \
+  } while (0)
+
+static void painel_reset(void)
+{
+  memset(&painel, 0, sizeof(painel));
+  painel.modo = 2;
+  painel.col_fim = 127;
+  painel.pag_fim = PAINEL_PAGINAS - 1;
+}
+
+// Bytes de argumento de cada comando com parâmetros
+static int argumentos(uint8_t cmd)
+{
+  switch (cmd)
+  {
+  case SET_MEM_ADDR:
+  case SET_CONTRAST:
+  case SET_MUX_RATIO:
+  case SET_DISP_OFFSET:
+  case SET_COM_PIN_CFG:
+  case SET_DISP_CLK_DIV:
+  case SET_PRECHARGE:
+  case SET_VCOM_DESEL:
+  case SET_CHARGE_PUMP:
+  case 0xAD: // DC-DC do SH1106
+    return 1;
+  case SET_COL_ADDR:
+  case SET_PAGE_ADDR:
+    return 2;
+  default:
+    return 0;
+  }
+}
+
+static void comando(const uint8_t *c)
+{
+  switch (c[0])
+  {
+  case SET_MEM_ADDR:
+    painel.modo = c[1] & 3;
+    return;
+  case SET_COL_ADDR:
+    painel.col = painel.col_ini = c[1];
+    painel.col_fim = c[2];
+    return;
+  case SET_PAGE_ADDR:
+    painel.pag = painel.pag_ini = c[1];
+    painel.pag_fim = c[2];
+    return;
+  }
+  if (c[0] <= 0x0F)
+    painel.col = (painel.col & 0xF0) | c[0];
+  else if (c[0] <= 0x1F)
+    painel.col = (uint8_t)((painel.col & 0x0F) | (c[0] & 0x0F) << 4);
+  else if ((c[0] & 0xF8) == 0xB0)
+    painel.pag = c[0] & 7;
+}
+
+static void dado(uint8_t b)
+{
+  CONFERE(painel.col < PAINEL_COLUNAS && painel.pag < PAINEL_PAGINAS, "escrita fora da RAM: coluna %u, página %u",
+          painel.col, painel.pag);
+  if (painel.col < PAINEL_COLUNAS && painel.pag < PAINEL_PAGINAS)
+    painel.ram[painel.pag][painel.col] = b;
+
+  if (painel.modo == 1)
+  {
+    if (painel.pag++ >= painel.pag_fim)
+    {
+      painel.pag = painel.pag_ini;
+      painel.col = painel.col >= painel.col_fim ? painel.col_ini : painel.col + 1;
+    }
+  }
+  else if (painel.modo == 0)
+  {
+    if (painel.col++ >= painel.col_fim)
+    {
+      painel.col = painel.col_ini;
+      painel.pag = painel.pag >= painel.pag_fim ? painel.pag_ini : painel.pag + 1;
+    }
+  }
+  else
+    painel.col++;
+}
+
+// Uma transação I2C: byte de controle 0x00 (comandos), 0x80 (um comando) ou 0x40 (dados)
+void geometria_escuta(const uint8_t *src, size_t len)
+{
+  if (len == 0)
+    return;
+  if (src[0] == 0x40)
+  {
+    for (size_t i = 1; i < len; i++)
+      dado(src[i]);
+    return;
+  }
+  CONFERE(src[0] == 0x00 || src[0] == 0x80, "byte de controle desconhecido 0x%02X", src[0]);
+  for (size_t i = 1; i < len; i += 1 + argumentos(src[i]))
+  {
+    CONFERE(i + argumentos(src[i]) < len, "comando 0x%02X sem argumentos", src[i]);
+    if (i + argumentos(src[i]) < len)
+      comando(&src[i]);
+  }
+}
+
+/* === Conferências === */
+
+static ssd1306_t ssd;
+static bool modelo[HEIGHT][WIDTH]; // referência pixel a pixel
+
+static bool painel_pixel(uint x, uint y)
+{
+  return painel.ram[y >> 3][x + SSD1306_COLUNA0] >> (y & 7) & 1;
+}
+
+static bool buffer_pixel(uint x, uint y)
+{
+  return ssd.ram_buffer[SSD1306_INDICE(x, y >> 3)] >> (y & 7) & 1;
+}
+
+// Só o bit de (x, y) aceso no buffer e, depois do envio, no painel
+static void confere_so(uint x, uint y, const char *envio)
+{
+  CONFERE(ssd.ram_buffer[0] == 0x40, "byte de controle do buffer alterado");
+  for (size_t i = 1; i < SSD1306_BUFSIZE; i++)
+  {
+    uint8_t esperado = i == SSD1306_INDICE(x, y >> 3) ? (uint8_t)(1u << (y & 7)) : 0;
+    CONFERE(ssd.ram_buffer[i] == esperado, "pixel (%u,%u): byte %zu = 0x%02X, esperado 0x%02X", x, y, i,
+            ssd.ram_buffer[i], esperado);
+  }
+  for (uint p = 0; p < PAINEL_PAGINAS; p++)
+    for (uint c = 0; c < PAINEL_COLUNAS; c++)
+    {
+      uint8_t esperado = (p == y >> 3 && c == x + SSD1306_COLUNA0) ? (uint8_t)(1u << (y & 7)) : 0;
+      CONFERE(painel.ram[p][c] == esperado, "pixel (%u,%u) por %s: painel página %u coluna %u = 0x%02X", x, y,
+              envio, p, c, painel.ram[p][c]);
+    }
+}
+
+static void confere_pixels(void)
+{
+  for (uint y = 0; y < HEIGHT; y++)
+    for (uint x = 0; x < WIDTH; x++)
+    {
+      ssd1306_fill(&ssd, false);
+      ssd1306_pixel(&ssd, x, y, true);
+
+      memset(painel.ram, 0, sizeof(painel.ram));
+      ssd1306_send_data(&ssd);
+      confere_so(x, y, "quadro");
+
+      memset(painel.ram, 0, sizeof(painel.ram));
+      ssd1306_send_region(&ssd, x, x, y >> 3, y >> 3);
+      confere_so(x, y, "região");
+    }
+}
+
+static void confere_recorte(void)
+{
+  ssd1306_fill(&ssd, false);
+  for (uint v = 0; v < 256; v++)
+  {
+    ssd1306_pixel(&ssd, WIDTH + (v % (256 - WIDTH)), v % HEIGHT, true);
+    ssd1306_pixel(&ssd, v % WIDTH, HEIGHT + (v % (256 - HEIGHT)), true);
+  }
+  for (size_t i = 1; i < SSD1306_BUFSIZE; i++)
+    CONFERE(ssd.ram_buffer[i] == 0, "pixel fora do painel escreveu no byte %zu", i);
+}
+
+static void confere_cheio(void)
+{
+  ssd1306_fill(&ssd, true);
+  memset(painel.ram, 0, sizeof(painel.ram));
+  ssd1306_send_data(&ssd);
+  for (uint p = 0; p < PAINEL_PAGINAS; p++)
+    for (uint c = 0; c < PAINEL_COLUNAS; c++)
+    {
+      bool visivel = p < SSD1306_PAGES && c - SSD1306_COLUNA0 < WIDTH;
+      CONFERE(painel.ram[p][c] == (visivel ? 0xFF : 0x00), "quadro cheio: página %u coluna %u = 0x%02X", p, c,
+              painel.ram[p][c]);
+    }
+}
+
+static void modelo_ponto(int x, int y, bool v)
+{
+  if (x >= 0 && x < WIDTH && y >= 0 && y < HEIGHT)
+    modelo[y][x] = v;
+}
+
+static void confere_primitivas(uint n)
+{
+  srand(1);
+  ssd1306_fill(&ssd, false);
+  memset(modelo, 0, sizeof(modelo));
+  for (uint k = 0; k < n; k++)
+  {
+    int a = rand() % (WIDTH + 16), b = rand() % (WIDTH + 16);
+    int c = rand() % (HEIGHT + 16), d = rand() % (HEIGHT + 16);
+    bool v = rand() & 1;
+    switch (rand() % 4)
+    {
+    case 0:
+      ssd1306_hline(&ssd, a, b, c, v);
+      for (int x = a; x <= b; x++)
+        modelo_ponto(x, c, v);
+      break;
+    case 1:
+      ssd1306_vline(&ssd, a, c, d, v);
+      for (int y = c; y <= d; y++)
+        modelo_ponto(a, y, v);
+      break;
+    case 2:
+    {
+      int w = 1 + rand() % 40, h = 1 + rand() % 20;
+      ssd1306_rect(&ssd, c, a, w, h, v, true);
+      for (int y = c; y < c + h; y++)
+        for (int x = a; x < a + w; x++)
+          modelo_ponto(x, y, v);
+      break;
+    }
+    default:
+    {
+      char ch = (char)(' ' + rand() % 95);
+      ssd1306_draw_char(&ssd, ch, a, c);
+      for (int col = 0; col < 8; col++)
+        for (int lin = 0; lin < 8; lin++)
+          modelo_ponto(a + col, c + lin, font[SSD1306_GLIFO(ch) * 8 + col] >> lin & 1);
+      break;
+    }
+    }
+  }
+
+  memset(painel.ram, 0, sizeof(painel.ram));
+  ssd1306_send_data(&ssd);
+  for (uint y = 0; y < HEIGHT; y++)
+    for (uint x = 0; x < WIDTH; x++)
+    {
+      CONFERE(buffer_pixel(x, y) == modelo[y][x], "primitivas: buffer (%u,%u) difere do modelo", x, y);
+      CONFERE(painel_pixel(x, y) == modelo[y][x], "primitivas: painel (%u,%u) difere do modelo", x, y);
+    }
+}
+
+int main(void)
+{
+  painel_reset();
+  ssd1306_init(&ssd, false, 0x3C, NULL);
+  ssd1306_config(&ssd);
+#ifdef SSD1306_SH1106
+  CONFERE(painel.modo == 2, "SH1106 não pode receber SET_MEM_ADDR");
+#else
+  CONFERE(painel.modo == 1, "configuração não ligou o endereçamento vertical");
+#endif
+
+  confere_pixels();
+  confere_recorte();
+  confere_cheio();
+  confere_primitivas(20000);
+
+  printf("geometria %d (%dx%d, coluna 0 do painel = %d): %s\n", SSD1306_GEOMETRIA, WIDTH, HEIGHT,
+         SSD1306_COLUNA0, falhas ? "FALHOU" : "ok");
+  return falhas ? 1 : 0;
+}
@@ -0,0 +1,33 @@
+#ifndef SIM_HARDWARE_I2C_H
+#define SIM_HARDWARE_I2C_H
+
+// No simulador o OLED só existe em RAM: as escritas I2C são descartadas, ou
+// entregues a SIM_I2C_ESCUTA (um painel emulado, em sim/geometria.c)
+#include "pico/stdlib.h"
+
+typedef struct i2c_inst i2c_inst_t;
+
+#ifdef SIM_I2C_ESCUTA
+void SIM_I2C_ESCUTA(const uint8_t *src, size_t len);
+#endif
+
+static inline int i2c_write_blocking(i2c_inst_t *i2c, uint8_t addr, const uint8_t *src, size_t len, bool nostop)
+{
+  (void)i2c;
+  (void)addr;
+  (void)src;
+  (void)nostop;
+#ifdef SIM_I2C_ESCUTA
+  SIM_I2C_ESCUTA(src, len);
+#endif
+  return (int)len;
+}
+
+static inline int i2c_write_timeout_per_char_us(i2c_inst_t *i2c, uint8_t addr, const uint8_t *src, size_t len,
+                                                bool nostop, uint timeout_per_char_us)
+{
+  (void)timeout_per_char_us;
+  return i2c_write_blocking(i2c, addr, src, len, nostop);
+}
+
+#endif
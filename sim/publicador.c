@@ -0,0 +1,442 @@
+/*
+ * Publicador MQTT do GuardaChuvas no host
+ *
+ * Roda lib/publicador.c (o mesmo código do firmware) contra um broker MQTT
+ * de verdade, com um cliente MQTT 3.1.1 mínimo sobre sockets POSIX no lugar
+ * do CYW43 + lwIP. Uma estação sintética gera amostras a 10 Hz, com o nível
+ * de água subindo e descendo entre os estados; uma janela de queda (-f)
+ * derruba a conexão para exercitar o armazenamento e o dreno na volta.
+ * Com -v, uma segunda conexão assina o tópico e confere se todos os lotes
+ * chegaram, contando os repetidos do QoS 1.
+ *
+ * Uso:
+ *   make -C sim
+ *   mosquitto -p 1883 &
+ *   ./sim/publicador -d 600 -f 120:300 -v
+ *   ./sim/publicador -b 192.168.0.10 -x 1        (tempo real)
+ *
+ * O relógio da estação avança 100 ms por volta; -x acelera em relação ao
+ * tempo real (padrão 10x).
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <math.h>
+#include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include "publicador.h"
+
+#define PERIODO_MS 100          // período padrão da vSensorTask
+#define KEEPALIVE_S 60
+#define ESPERA_MIN_MS 1000      // como em lib/mqtt_picow.h
+#define ESPERA_MAX_MS 60000
+#define ACKS 64
+#define ESCOAMENTO_MS 300000    // depois da duração, espera a fila esvaziar por até isso
+
+/* === Cliente MQTT mínimo === */
+
+typedef struct
+{
+  const char *host, *porta, *id;
+  int fd;
+  bool aceito;
+  uint8_t rx[8192];
+  size_t n;
+  uint32_t agora_ms;    // relógio da última chamada de servir()
+  uint32_t enviado_ms;  // último pacote enviado (keep-alive)
+  uint32_t proxima_ms, espera_ms;
+  bool fora;            // dentro da janela de queda
+  uint16_t acks[ACKS];  // PUBACK recebidos, em ordem
+  uint8_t acks_ini, acks_fim;
+  uint32_t conexoes;
+  void (*recebido)(void *ctx, const uint8_t *dados, size_t n); // PUBLISH de assinatura
+  void *ctx;
+} mqtt_t;
+
+static size_t poe_tamanho(uint8_t *d, uint32_t v)
+{
+  size_t i = 0;
+  do
+  {
+    d[i] = v % 128;
+    v /= 128;
+    if (v)
+      d[i] |= 0x80;
+    i++;
+  } while (v);
+  return i;
+}
+
+static size_t poe_texto(uint8_t *d, const char *s)
+{
+  size_t n = strlen(s);
+  d[0] = (uint8_t)(n >> 8);
+  d[1] = (uint8_t)n;
+  memcpy(d + 2, s, n);
+  return n + 2;
+}
+
+static void fecha(mqtt_t *m)
+{
+  if (m->fd >= 0)
+    close(m->fd);
+  m->fd = -1;
+  m->aceito = false;
+  m->n = 0;
+}
+
+static bool envia(mqtt_t *m, const uint8_t *d, size_t n, uint32_t agora_ms)
+{
+  if (m->fd < 0)
+    return false;
+  ssize_t r = send(m->fd, d, n, MSG_NOSIGNAL);
+  if (r < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+    return false; // sem espaço agora; nada saiu
+  if (r != (ssize_t)n)
+  {
+    fecha(m); // envio parcial ou erro: a sessão não tem como continuar
+    return false;
+  }
+  m->enviado_ms = agora_ms;
+  return true;
+}
+
+static void conecta(mqtt_t *m, uint32_t agora_ms)
+{
+  m->proxima_ms = agora_ms + m->espera_ms;
+  m->espera_ms = m->espera_ms * 2 > ESPERA_MAX_MS ? ESPERA_MAX_MS : m->espera_ms * 2;
+
+  struct addrinfo dica = {.ai_family = AF_UNSPEC, .ai_socktype = SOCK_STREAM}, *res;
+  if (getaddrinfo(m->host, m->porta, &dica, &res) != 0)
+    return;
+  int fd = socket(res->ai_family, res->ai_socktype, res->ai_protocol);
+  if (fd >= 0 && connect(fd, res->ai_addr, res->ai_addrlen) != 0)
+  {
+    close(fd);
+    fd = -1;
+  }
+  freeaddrinfo(res);
+  if (fd < 0)
+    return;
+  int um = 1;
+  setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &um, sizeof(um));
+  fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+  m->fd = fd;
+
+  // CONNECT com sessão limpa: o que ficou em voo é reenviado pelo publicador
+  uint8_t corpo[128], pac[136];
+  size_t c = poe_texto(corpo, "MQTT");
+  corpo[c++] = 4;    // 3.1.1
+  corpo[c++] = 0x02; // clean session
+  corpo[c++] = KEEPALIVE_S >> 8;
+  corpo[c++] = KEEPALIVE_S & 0xFF;
+  c += poe_texto(corpo + c, m->id);
+  pac[0] = 0x10;
+  size_t p = 1 + poe_tamanho(pac + 1, (uint32_t)c);
+  memcpy(pac + p, corpo, c);
+  envia(m, pac, p + c, agora_ms);
+}
+
+static void assina(mqtt_t *m, const char *topico, uint32_t agora_ms)
+{
+  uint8_t corpo[80], pac[88];
+  size_t c = 0;
+  corpo[c++] = 0;
+  corpo[c++] = 1; // id do SUBSCRIBE
+  c += poe_texto(corpo + c, topico);
+  corpo[c++] = 1; // QoS 1
+  pac[0] = 0x82;
+  size_t p = 1 + poe_tamanho(pac + 1, (uint32_t)c);
+  memcpy(pac + p, corpo, c);
+  envia(m, pac, p + c, agora_ms);
+}
+
+// Trata um pacote completo do broker
+static void pacote(mqtt_t *m, uint8_t tipo, const uint8_t *d, size_t n, uint32_t agora_ms)
+{
+  switch (tipo >> 4)
+  {
+  case 2: // CONNACK
+    m->aceito = n >= 2 && d[1] == 0;
+    if (m->aceito)
+    {
+      m->espera_ms = ESPERA_MIN_MS;
+      m->conexoes++;
+    }
+    break;
+  case 4: // PUBACK
+    if (n >= 2 && (uint8_t)(m->acks_fim - m->acks_ini) < ACKS)
+      m->acks[m->acks_fim++ % ACKS] = (uint16_t)(d[0] << 8 | d[1]);
+    break;
+  case 3: // PUBLISH (assinatura)
+  {
+    if (n < 2)
+      break;
+    size_t t = 2 + (size_t)(d[0] << 8 | d[1]);
+    uint8_t qos = (tipo >> 1) & 3;
+    if (t + (qos ? 2 : 0) > n)
+      break;
+    if (qos)
+    {
+      uint8_t ack[4] = {0x40, 2, d[t], d[t + 1]};
+      envia(m, ack, sizeof(ack), agora_ms);
+      t += 2;
+    }
+    if (m->recebido)
+      m->recebido(m->ctx, d + t, n - t);
+    break;
+  }
+  default: // SUBACK, PINGRESP
+    break;
+  }
+}
+
+static void le(mqtt_t *m, uint32_t agora_ms)
+{
+  while (m->fd >= 0)
+  {
+    ssize_t r = recv(m->fd, m->rx + m->n, sizeof(m->rx) - m->n, 0);
+    if (r < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+      break;
+    if (r <= 0)
+    {
+      fecha(m);
+      return;
+    }
+    m->n += (size_t)r;
+
+    // Separa os pacotes completos: [tipo][tamanho variável][corpo]
+    size_t ini = 0;
+    while (m->n - ini >= 2)
+    {
+      uint32_t tam = 0, mult = 1;
+      size_t i = ini + 1;
+      while (i < m->n && i - ini <= 4)
+      {
+        tam += (m->rx[i] & 0x7F) * mult;
+        mult *= 128;
+        if (!(m->rx[i++] & 0x80))
+          break;
+      }
+      if ((i > 0 && (m->rx[i - 1] & 0x80)) || i + tam > m->n)
+        break;
+      pacote(m, m->rx[ini], m->rx + i, tam, agora_ms);
+      if (m->fd < 0)
+        return;
+      ini = i + tam;
+    }
+    memmove(m->rx, m->rx + ini, m->n - ini);
+    m->n -= ini;
+    if (m->n == sizeof(m->rx))
+      fecha(m); // pacote maior que o buffer
+  }
+}
+
+/* === Transporte do publicador === */
+
+static void servir(void *ctx, uint32_t agora_ms)
+{
+  mqtt_t *m = ctx;
+  m->agora_ms = agora_ms;
+  if (m->fora)
+  {
+    fecha(m); // Wi-Fi caiu: a conexão some sem DISCONNECT
+    return;
+  }
+  if (m->fd < 0 && (int32_t)(agora_ms - m->proxima_ms) >= 0)
+    conecta(m, agora_ms);
+  le(m, agora_ms);
+  if (m->aceito && agora_ms - m->enviado_ms >= KEEPALIVE_S * 1000 / 2)
+  {
+    static const uint8_t PINGREQ[2] = {0xC0, 0};
+    envia(m, PINGREQ, sizeof(PINGREQ), agora_ms);
+  }
+}
+
+static bool conectado(void *ctx)
+{
+  mqtt_t *m = ctx;
+  return m->fd >= 0 && m->aceito;
+}
+
+static bool publicar(void *ctx, const char *topico, const uint8_t *dados, uint16_t n, uint16_t id, bool dup)
+{
+  mqtt_t *m = ctx;
+  uint8_t pac[8 + 64 + PUBLICADOR_LOTE_MAX];
+  size_t tt = strlen(topico);
+  if (tt > 64)
+    return false;
+  pac[0] = 0x32 | (dup ? 0x08 : 0); // PUBLISH QoS 1
+  size_t p = 1 + poe_tamanho(pac + 1, (uint32_t)(2 + tt + 2 + n));
+  p += poe_texto(pac + p, topico);
+  pac[p++] = (uint8_t)(id >> 8);
+  pac[p++] = (uint8_t)id;
+  memcpy(pac + p, dados, n);
+  return envia(m, pac, p + n, m->agora_ms);
+}
+
+static uint16_t confirmacao(void *ctx)
+{
+  mqtt_t *m = ctx;
+  if (m->acks_ini == m->acks_fim)
+    return 0;
+  return m->acks[m->acks_ini++ % ACKS];
+}
+
+/* === Conferência dos lotes recebidos === */
+
+typedef struct
+{
+  uint16_t sessao;
+  uint8_t visto[65536 / 8];
+  uint32_t distintos, repetidos, registros, invalidos;
+} conferencia_t;
+
+static void recebido(void *ctx, const uint8_t *d, size_t n)
+{
+  conferencia_t *c = ctx;
+  if (n < PUBLICADOR_CABECALHO || d[0] != PUBLICADOR_VERSAO || (uint16_t)(d[1] | d[2] << 8) != c->sessao)
+  {
+    c->invalidos++;
+    return;
+  }
+  uint16_t lote = (uint16_t)(d[3] | d[4] << 8);
+  if (c->visto[lote / 8] & (1 << lote % 8))
+  {
+    c->repetidos++; // QoS 1: descartado pelo par (sessao, lote)
+    return;
+  }
+  c->visto[lote / 8] |= (uint8_t)(1 << lote % 8);
+  c->distintos++;
+  for (size_t i = PUBLICADOR_CABECALHO; i + 2 <= n; i += 2u + d[i + 1])
+    c->registros++;
+}
+
+/* === Estação sintética === */
+
+// Nível sobe e desce num ciclo de 5 min, passando por ALERTA e ENCHENTE
+static void amostra(publicador_t *p, uint32_t t_ms, uint8_t *estado)
+{
+  double fase = 2 * M_PI * t_ms / 300000.0;
+  uint16_t agua = (uint16_t)(2048 - 1800 * cos(fase));
+  uint16_t chuva = (uint16_t)(1024 + 900 * sin(fase) + rand() % 64);
+  uint8_t novo = agua >= 3276 ? 2 : agua >= 2457 ? 1 : 0; // 80 % e 60 %
+  publicador_amostra(p, t_ms, agua, chuva, (uint16_t)(agua * 1000u / 4095), (uint16_t)(chuva * 500u / 4095));
+  if (novo != *estado)
+  {
+    publicador_estado(p, t_ms, *estado, novo);
+    *estado = novo;
+  }
+}
+
+static void uso(const char *nome)
+{
+  fprintf(stderr,
+          "uso: %s [-b broker] [-p porta] [-d duracao_s] [-f ini_s:fim_s] [-x velocidade] [-v]\n"
+          "  -f: janela sem rede; -x: relógio da estação em relação ao real (padrão 10);\n"
+          "  -v: assina o tópico e confere os lotes recebidos\n",
+          nome);
+  exit(2);
+}
+
+int main(int argc, char **argv)
+{
+  const char *host = "127.0.0.1", *porta = "1883";
+  uint32_t duracao_s = 600, fora_ini = 0, fora_fim = 0;
+  double velocidade = 10;
+  bool conferir = false;
+  int op;
+  while ((op = getopt(argc, argv, "b:p:d:f:x:vh")) != -1)
+  {
+    switch (op)
+    {
+    case 'b': host = optarg; break;
+    case 'p': porta = optarg; break;
+    case 'd': duracao_s = (uint32_t)atol(optarg); break;
+    case 'f':
+      if (sscanf(optarg, "%u:%u", &fora_ini, &fora_fim) != 2 || fora_fim <= fora_ini)
+        uso(argv[0]);
+      break;
+    case 'x': velocidade = atof(optarg); break;
+    case 'v': conferir = true; break;
+    default: uso(argv[0]);
+    }
+  }
+  if (optind != argc || velocidade <= 0)
+    uso(argv[0]);
+
+  srand((unsigned)getpid());
+  uint16_t sessao = (uint16_t)rand();
+  char estacao[24];
+  snprintf(estacao, sizeof(estacao), "sim%04x", sessao);
+
+  mqtt_t rede = {.host = host, .porta = porta, .id = estacao, .fd = -1, .espera_ms = ESPERA_MIN_MS};
+  pub_transporte_t transporte = {servir, conectado, publicar, confirmacao, &rede};
+  static publicador_t pub;
+  publicador_init(&pub, &transporte, estacao, sessao);
+
+  static conferencia_t conf;
+  conf.sessao = sessao;
+  char id_assinante[32];
+  snprintf(id_assinante, sizeof(id_assinante), "%s-conf", estacao);
+  mqtt_t assinante = {.host = host, .porta = porta, .id = id_assinante, .fd = -1, .espera_ms = ESPERA_MIN_MS,
+                      .recebido = recebido, .ctx = &conf};
+  bool assinado = false;
+
+  uint8_t estado = 0;
+  uint32_t fim_ms = duracao_s * 1000, limite_ms = fim_ms + ESCOAMENTO_MS;
+  uint32_t t = 0;
+  for (; t < limite_ms; t += PERIODO_MS)
+  {
+    if (t < fim_ms)
+      amostra(&pub, t, &estado);
+    else if (publicador_fila(&pub) == 0)
+      break;
+
+    rede.fora = t >= fora_ini * 1000 && t < fora_fim * 1000;
+    publicador_servir(&pub, t);
+
+    if (conferir)
+    {
+      // Assina depois do CONNACK; sessão limpa, então assina de novo a cada conexão
+      if (assinante.fd < 0)
+        assinado = false;
+      servir(&assinante, t);
+      if (assinante.aceito && !assinado)
+        assinado = true, assina(&assinante, pub.topico, t);
+    }
+    usleep((useconds_t)(PERIODO_MS * 1000 / velocidade));
+  }
+
+  // Dá tempo para os últimos lotes chegarem ao assinante
+  for (int i = 0; conferir && i < 20; i++, t += PERIODO_MS)
+  {
+    servir(&assinante, t);
+    usleep(50000);
+  }
+
+  const pub_stats_t *s = &pub.stats;
+  printf("topico %s, sessao %u, %u conexoes\n", pub.topico, sessao, rede.conexoes);
+  printf("lotes %u, publicados %u, confirmados %u, reenvios %u, descartados %u, fila max %u, na fila %u\n", s->lotes,
+         s->publicados, s->confirmados, s->reenvios, s->descartados, s->fila_max, publicador_fila(&pub));
+  int rc = publicador_fila(&pub) ? 1 : 0;
+  if (conferir)
+  {
+    uint32_t esperados = s->lotes - s->descartados;
+    printf("recebidos %u de %u lotes (%u registros), %u repetidos, %u invalidos\n", conf.distintos, esperados,
+           conf.registros, conf.repetidos, conf.invalidos);
+    if (conf.distintos < esperados)
+      rc = 1;
+  }
+  fecha(&rede);
+  fecha(&assinante);
+  return rc;
+}
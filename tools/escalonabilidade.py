@@ -0,0 +1,233 @@
+#!/usr/bin/env python3
+"""
+Análise de escalonabilidade das tarefas do GuardaChuvas (tabela TAREFAS em GuardaChuvas.c).
+
+Lê prioridades, períodos, prazos e gatilhos da tabela, e o tempo de execução de
+pior caso (WCET) de tools/wcet.csv, substituído pelo medido na placa quando há
+--medidas (CSV do telemetria_decoder.py com os registros "tarefa"). Calcula a
+utilização e o tempo de resposta de cada tarefa por análise de tempo de resposta
+com prioridade fixa:
+
+    R = C + B + soma sobre as de prioridade >= (e interrupções) de ceil((R + J) / T) * C
+
+B é o maior trecho sem preempção e J o atraso de liberação de quem é acordado
+por outra tarefa (o tempo de resposta do gatilho). Prioridade igual conta como
+interferência (fatias de tempo do FreeRTOS). A cadeia sensor→alerta soma os
+tempos de resposta do sensor e da saída; a matriz, que consulta a caixa de
+correio no próprio relógio, soma também um período dela. O buzzer é acordado
+pela amostra e pelas transições do alarme (gerenciador na tarefa de
+temporizadores), e o padrão liga/desliga não o bloqueia.
+
+Sai com código 1 se a utilização passar de 100 %, se uma tarefa com prazo
+perder o prazo ou se uma cadeia passar de CADEIA_PRAZO_MS. O CMake roda esta
+análise a cada compilação (alvo escalonabilidade).
+
+Uso:
+    python3 tools/escalonabilidade.py
+    python3 tools/escalonabilidade.py --medidas sessao.csv
+"""
+
+import argparse
+import csv
+import math
+import os
+import re
+import sys
+
+RAIZ = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+
+# Cadeias até as saídas de alerta: (produtor, consumidor, consumidor acordado pela escrita do produtor).
+# Quem não é acordado consulta no próprio relógio e pode ver a amostra só no período seguinte.
+CADEIAS = [
+    ("SENSOR", "LED", True),
+    ("SENSOR", "BUZZER", True),
+    ("SENSOR", "MATRIZ", False),
+    ("TEMPORIZADOR", "BUZZER", True),  # reconhecimento, escalada e limpeza do alarme
+]
+
+LIMITE_US = 10_000_000  # tempo de resposta acima disso é tratado como sem limite
+
+
+def le_defines(caminhos):
+    """#define NOME VALOR dos fontes, para avaliar as colunas da tabela."""
+    defines = {}
+    for caminho in caminhos:
+        with open(caminho, encoding="utf-8") as f:
+            for linha in f:
+                m = re.match(r"\s*#\s*define\s+(\w+)\s+([^/\n]+)", linha)
+                if m:
+                    defines.setdefault(m.group(1), m.group(2).strip())
+    return defines
+
+
+def avalia(expr, defines, profundidade=0):
+    if profundidade > 16:
+        raise ValueError(f"macro recursiva: {expr}")
+    expr = re.sub(r"\(\s*[A-Za-z_]\w*_t\s*\)", "", expr)  # casts como ( TickType_t )
+    expr = re.sub(r"\b(\d+)[uUlL]+\b", r"\1", expr)
+
+    def troca(m):
+        nome = m.group(0)
+        if nome not in defines:
+            raise ValueError(f"macro desconhecida: {nome}")
+        return f"({avalia(defines[nome], defines, profundidade + 1)})"
+
+    return int(eval(re.sub(r"\b[A-Za-z_]\w*\b", troca, expr), {"__builtins__": {}}))
+
+
+def le_tabela(fonte, defines):
+    with open(fonte, encoding="utf-8") as f:
+        texto = f.read()
+    inicio = texto.find("TAREFAS[TAREFA_TOTAL]")
+    if inicio < 0:
+        raise ValueError(f"tabela TAREFAS não encontrada em {fonte}")
+    inicio = texto.index("{", inicio) + 1  # depois do "[TAREFA_TOTAL] = {", que não é uma linha
+    corpo = texto[inicio:texto.index("};", inicio)]
+    corpo = re.sub(r"//[^\n]*", "", corpo)
+
+    tarefas = {}
+    for m in re.finditer(r"\[TAREFA_(\w+)\]\s*=\s*\{(.*?)\}", corpo, re.S):
+        campos = [c.strip() for c in m.group(2).split(",")]
+        if len(campos) != 7:
+            raise ValueError(f"linha da tabela com {len(campos)} colunas: TAREFA_{m.group(1)}")
+        _, nome, _, prio, periodo, prazo, gatilho = campos
+        tarefas[m.group(1)] = {
+            "id": m.group(1),
+            "nome": nome.strip('"'),
+            "prio": avalia(prio, defines),
+            "T": avalia(periodo, defines) * 1000,
+            "D": avalia(prazo, defines) * 1000,
+            "gatilho": None if gatilho == "TAREFA_NENHUMA" else gatilho.replace("TAREFA_", "", 1),
+        }
+    return tarefas
+
+
+def le_wcet(caminho):
+    with open(caminho, encoding="utf-8") as f:
+        linhas = [l for l in f if l.strip() and not l.lstrip().startswith("#")]
+    return list(csv.DictReader(linhas))
+
+
+def le_medidas(caminho):
+    """Pior valor de cada registro "tarefa,,nome,exec_max_us,ativacoes" do decodificador."""
+    medidas = {}
+    with open(caminho, encoding="utf-8") as f:
+        for campos in csv.reader(f):
+            if len(campos) >= 4 and campos[0] == "tarefa" and int(campos[4] if len(campos) > 4 else 1) > 0:
+                medidas[campos[2]] = max(medidas.get(campos[2], 0), int(campos[3]))
+    return medidas
+
+
+def resposta(t, tarefas, isrs, bloqueio):
+    """Menor ponto fixo de R; None se passar do prazo (ou de LIMITE_US sem prazo)."""
+    limite = t["D"] or LIMITE_US
+    interf = [u for u in tarefas.values() if u is not t and u["prio"] >= t["prio"]] + isrs
+    r = t["C"] + bloqueio
+    while True:
+        novo = t["C"] + bloqueio + sum(math.ceil((r + u["J"]) / u["T"]) * u["C"] for u in interf)
+        if novo == r:
+            return r
+        if novo > limite:
+            return None
+        r = novo
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__.splitlines()[1])
+    ap.add_argument("--fonte", default=os.path.join(RAIZ, "GuardaChuvas.c"), help="arquivo com a tabela TAREFAS")
+    ap.add_argument("--wcet", default=os.path.join(RAIZ, "tools", "wcet.csv"))
+    ap.add_argument("--medidas", help="CSV do telemetria_decoder.py com registros tarefa (WCET medido)")
+    args = ap.parse_args()
+
+    lib = os.path.join(os.path.dirname(os.path.abspath(args.fonte)), "lib")
+    cabecalhos = sorted(os.path.join(lib, a) for a in os.listdir(lib) if a.endswith(".h"))
+    defines = le_defines([args.fonte] + cabecalhos)
+    tarefas = le_tabela(args.fonte, defines)
+    prazo_cadeia = avalia("CADEIA_PRAZO_MS", defines) * 1000
+
+    isrs, bloqueio, erros = [], 0, []
+    por_nome = {t["nome"]: t for t in tarefas.values()}
+    for linha in le_wcet(args.wcet):
+        c = int(linha["wcet_us"])
+        if linha["tipo"] == "tarefa":
+            if linha["nome"] not in por_nome:
+                erros.append(f"{args.wcet}: tarefa fora da tabela: {linha['nome']}")
+                continue
+            por_nome[linha["nome"]].update(C=c, origem=linha["origem"])
+        elif linha["tipo"] == "isr":
+            isrs.append({"nome": linha["nome"], "C": c, "T": int(linha["periodo_us"]), "J": 0})
+        elif linha["tipo"] == "bloqueio":
+            bloqueio = max(bloqueio, c)
+
+    # Medidas da placa: o nome do supervisor são as quatro primeiras letras
+    if args.medidas:
+        for nome, c in le_medidas(args.medidas).items():
+            for t in tarefas.values():
+                if nome and t["nome"].startswith(nome):
+                    t.update(C=c, origem="medido")
+    for t in tarefas.values():
+        if "C" not in t:
+            erros.append(f"sem WCET para {t['nome']} em {args.wcet}")
+    if erros:
+        for e in erros:
+            print(e, file=sys.stderr)
+        return 1
+
+    # Ponto fixo global: o atraso de liberação depende do tempo de resposta do gatilho
+    for t in tarefas.values():
+        t["J"], t["R"] = 0, t["C"]
+    for _ in range(len(tarefas) + 1):
+        for t in tarefas.values():
+            t["R"] = resposta(t, tarefas, isrs, bloqueio)
+        mudou = False
+        for t in tarefas.values():
+            g = tarefas.get(t["gatilho"]) if t["gatilho"] else None
+            j = (g["R"] if g and g["R"] is not None else 0)
+            if j != t["J"]:
+                t["J"], mudou = j, True
+        if not mudou:
+            break
+
+    falhas = []
+    print(f"{'tarefa':<16}{'prio':>5}{'T ms':>8}{'D ms':>8}{'C us':>8}  {'origem':<10}{'R us':>8}{'folga':>8}")
+    for t in sorted(tarefas.values(), key=lambda t: (-t["prio"], t["D"] or LIMITE_US)):
+        if t["R"] is None:
+            r, folga = "-", "-"
+            falhas.append(f"{t['nome']}: sem tempo de resposta dentro do " + ("prazo" if t["D"] else "limite"))
+        else:
+            r = str(t["R"])
+            folga = f"{100 * (t['D'] - t['R']) // t['D']}%" if t["D"] else "-"
+        prazo = f"{t['D'] / 1000:g}" if t["D"] else "-"
+        print(f"{t['nome']:<16}{t['prio']:>5}{t['T'] / 1000:>8g}{prazo:>8}"
+              f"{t['C']:>8}  {t['origem']:<10}{r:>8}{folga:>8}")
+
+    todas = list(tarefas.values()) + isrs
+    u = sum(x["C"] / x["T"] for x in todas)
+    n = len(todas)
+    print(f"\nutilização {100 * u:.1f}% ({len(isrs)} interrupções {100 * sum(x['C'] / x['T'] for x in isrs):.1f}%), "
+          f"limite RM para {n}: {100 * n * (2 ** (1 / n) - 1):.1f}%, bloqueio {bloqueio} us")
+    if u > 1:
+        falhas.append(f"utilização {100 * u:.1f}% acima de 100%")
+
+    print(f"\ncadeias (prazo {prazo_cadeia // 1000} ms):")
+    for produtor, consumidor, acordado in CADEIAS:
+        p, c = tarefas[produtor], tarefas[consumidor]
+        if p["R"] is None or c["R"] is None:
+            falhas.append(f"cadeia {p['nome']} -> {c['nome']}: sem tempo de resposta")
+            continue
+        fim = p["R"] + c["R"] + (0 if acordado else c["T"])
+        print(f"  {p['nome']} -> {c['nome']}: {fim} us")
+        if fim > prazo_cadeia:
+            falhas.append(f"cadeia {p['nome']} -> {c['nome']}: {fim} us > {prazo_cadeia} us")
+
+    if falhas:
+        print("\nESCALONABILIDADE: FALHOU", file=sys.stderr)
+        for f in falhas:
+            print(f"  {f}", file=sys.stderr)
+        return 1
+    print("\nescalonável")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
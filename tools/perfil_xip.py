@@ -0,0 +1,82 @@
+#!/usr/bin/env python3
+"""
+Relatório de antes e depois do código quente na SRAM (lib/perfil_xip.h).
+
+Lê os registros "xip" de CSVs do telemetria_decoder.py capturados com
+XIP_PERFIL ligado e compara, por estágio, ciclos por chamada, pior caso e taxa
+de acerto do cache XIP. Cada estágio usa o último registro do arquivo (os
+contadores acumulam desde o boot). O "antes" é a compilação com
+QUENTE_NA_RAM desligado; com um arquivo só, mostra apenas a tabela dele.
+
+Estágios: sensores, display e matriz são um quadro de cada tarefa; isr_pwm e
+isr_gpio os tratadores; latencia e lat_fria o tempo da interrupção pendente
+até o tratador, com o cache quente e logo depois de esvaziado.
+
+Uso:
+    python3 tools/perfil_xip.py flash.csv ram.csv
+    python3 tools/perfil_xip.py sessao.csv
+"""
+
+import argparse
+import csv
+import sys
+
+
+def le_xip(caminho):
+    """Último "xip,,estagio,ram|flash,chamadas,medio,max,acessos,acertos" de cada estágio."""
+    estagios = {}
+    with open(caminho, encoding="utf-8") as f:
+        for campos in csv.reader(f):
+            if len(campos) >= 9 and campos[0] == "xip":
+                chamadas, medio, maximo, acessos, acertos = (int(c) for c in campos[4:9])
+                estagios[campos[2]] = {"local": campos[3], "chamadas": chamadas, "medio": medio,
+                                       "max": maximo, "acessos": acessos, "acertos": acertos}
+    return estagios
+
+
+def acerto(e):
+    return f"{100 * e['acertos'] / e['acessos']:.1f}%" if e["acessos"] else "-"
+
+
+def locais(estagios):
+    return "/".join(sorted({e["local"] for e in estagios.values()})) or "?"
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__.splitlines()[1])
+    ap.add_argument("antes", help="CSV com os registros xip (QUENTE_NA_RAM desligado)")
+    ap.add_argument("depois", nargs="?", help="CSV com os registros xip (QUENTE_NA_RAM ligado)")
+    args = ap.parse_args()
+
+    antes = le_xip(args.antes)
+    if not antes:
+        print(f"{args.antes}: sem registros xip (compilar com XIP_PERFIL ligado)", file=sys.stderr)
+        return 1
+
+    if not args.depois:
+        print(f"{'estagio':<10}{'chamadas':>10}{'ciclos':>9}{'max':>9}{'acerto':>8}   ({locais(antes)})")
+        for nome, e in antes.items():
+            print(f"{nome:<10}{e['chamadas']:>10}{e['medio']:>9}{e['max']:>9}{acerto(e):>8}")
+        return 0
+
+    depois = le_xip(args.depois)
+    if not depois:
+        print(f"{args.depois}: sem registros xip (compilar com XIP_PERFIL ligado)", file=sys.stderr)
+        return 1
+
+    print(f"ciclos por chamada: {locais(antes)} -> {locais(depois)}")
+    print(f"{'estagio':<10}{'antes':>9}{'depois':>9}{'delta':>8}{'max antes':>11}{'max depois':>12}"
+          f"{'acerto antes':>14}{'depois':>8}")
+    for nome in list(antes) + [n for n in depois if n not in antes]:
+        a, d = antes.get(nome), depois.get(nome)
+        if not a or not d or not a["chamadas"] or not d["chamadas"]:
+            print(f"{nome:<10}  sem chamadas nas duas capturas")
+            continue
+        delta = f"{100 * (d['medio'] - a['medio']) / a['medio']:+.0f}%" if a["medio"] else "-"
+        print(f"{nome:<10}{a['medio']:>9}{d['medio']:>9}{delta:>8}{a['max']:>11}{d['max']:>12}"
+              f"{acerto(a):>14}{acerto(d):>8}")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
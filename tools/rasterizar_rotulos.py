@@ -0,0 +1,83 @@
+#!/usr/bin/env python3
+"""
+Rasteriza rótulos fixos do display do GuardaChuvas com a fonte de lib/font.h.
+
+Gera lib/rotulos.h com as colunas de cada rótulo já prontas (um byte por
+coluna, bit 0 em cima, o layout do ram_buffer do SSD1306) em vetores
+constantes, que ficam na flash. O compositor copia essas colunas direto para
+o buffer (WIDGET_IMAGEM), sem formatar nem procurar glifos a cada quadro.
+Rodar de novo ao mudar a fonte ou a lista de ROTULOS.
+
+Uso:
+    python3 tools/rasterizar_rotulos.py
+    python3 tools/rasterizar_rotulos.py --fonte lib/font.h -o lib/rotulos.h
+"""
+
+import argparse
+import os
+import re
+
+RAIZ = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+
+# Nome do símbolo -> texto
+ROTULOS = {
+    "SEGURO": "Seguro",
+    "ALERTA": "Alerta",
+    "ENCHENTE": "Enchente",
+}
+
+
+def le_fonte(caminho):
+    with open(caminho, encoding="utf-8") as f:
+        texto = f.read()
+    corpo = texto[texto.index("{") + 1:texto.rindex("}")]
+    corpo = re.sub(r"//[^\n]*", "", corpo)  # o comentário de cada linha é o próprio caractere
+    bytes_ = [int(v, 16) for v in re.findall(r"0x[0-9A-Fa-f]{2}", corpo)]
+    if len(bytes_) % 8:
+        raise SystemExit(f"{caminho}: {len(bytes_)} bytes, esperado múltiplo de 8")
+    return bytes_
+
+
+def colunas(fonte, texto):
+    saida = []
+    for c in texto:
+        glifo = ord(c) - ord(" ") if " " <= c <= "~" else 0
+        saida += fonte[glifo * 8:glifo * 8 + 8]
+    return saida
+
+
+def gera(fonte):
+    linhas = [
+        "// Gerado por tools/rasterizar_rotulos.py a partir de lib/font.h: não editar à mão",
+        "#ifndef ROTULOS_H",
+        "#define ROTULOS_H",
+        "",
+        '#include "compositor.h"',
+        "",
+    ]
+    for nome, texto in ROTULOS.items():
+        cols = colunas(fonte, texto)
+        linhas.append(f"// \"{texto}\"")
+        linhas.append(f"static const uint8_t ROTULO_{nome}_COLUNAS[{len(cols)}] = {{")
+        for i in range(0, len(cols), 8):
+            linhas.append("    " + ", ".join(f"0x{b:02X}" for b in cols[i:i + 8]) + ",")
+        linhas.append("};")
+        linhas.append(f"static const imagem_t ROTULO_{nome} = {{ROTULO_{nome}_COLUNAS, {len(cols)}}};")
+        linhas.append("")
+    linhas.append("#endif")
+    return "\n".join(linhas) + "\n"
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    ap.add_argument("--fonte", default=os.path.join(RAIZ, "lib", "font.h"))
+    ap.add_argument("-o", "--saida", default=os.path.join(RAIZ, "lib", "rotulos.h"))
+    args = ap.parse_args()
+
+    with open(args.saida, "w", encoding="utf-8") as f:
+        f.write(gera(le_fonte(args.fonte)))
+    print(f"{args.saida}: {len(ROTULOS)} rótulos")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,203 @@
+#!/usr/bin/env python3
+"""
+Decodificador da telemetria binária do GuardaChuvas (lib/telemetria.h).
+
+Lê quadros COBS terminados em 0x00 da porta USB CDC (ou de um arquivo gravado
+com --arquivo ou --gravar), confere o CRC-16/CCITT-FALSE e grava os registros em CSV.
+
+Uso:
+    python3 tools/telemetria_decoder.py /dev/ttyACM0 -o sessao.csv
+    python3 tools/telemetria_decoder.py captura.bin --arquivo -o sessao.csv
+    python3 tools/telemetria_decoder.py /dev/ttyACM0 -c "set agua_enchente 75" -c salvar
+
+Saída CSV (uma linha por registro):
+    tipo,t,campo1,campo2,...
+Amostras do modo bruto são expandidas em uma linha por par (t em microssegundos)
+e registros de canais em uma linha por canal (canais,t,id,valor).
+"""
+
+import argparse
+import struct
+import sys
+
+VERSAO = 1
+TEL_AMOSTRA, TEL_ESTADO, TEL_STATS, TEL_BRUTO, TEL_TEXTO, TEL_CANAIS = 0x01, 0x02, 0x03, 0x04, 0x05, 0x06
+TEL_REINICIO, TEL_ALARME, TEL_BOOT, TEL_TAREFA, TEL_XIP = 0x07, 0x08, 0x09, 0x0A, 0x0B
+ESTADOS = {0: "SEGURO", 1: "ALERTA", 2: "ENCHENTE"}
+CAUSAS = {0: "NENHUMA", 1: "PRAZO", 2: "WATCHDOG"}
+FASES = {0: "limpo", 1: "ativo", 2: "reconhecido", 3: "escalado"}
+CAUSAS_ALARME = {0: "risco", 1: "reconhecer", 2: "subida", 3: "silencio", 4: "limpeza"}
+FASES_BOOT = ["main", "seguro", "escalonador", "amostra", "led", "buzzer", "matriz", "display"]  # lib/boot.h
+ESTAGIOS_XIP = ["sensores", "display", "matriz", "isr_pwm", "isr_gpio", "latencia", "lat_fria"]  # lib/perfil_xip.h
+
+
+def crc16(dados):
+    crc = 0xFFFF
+    for b in dados:
+        crc ^= b << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) if crc & 0x8000 else (crc << 1)
+            crc &= 0xFFFF
+    return crc
+
+
+def cobs_decodifica(dados):
+    saida = bytearray()
+    i = 0
+    while i < len(dados):
+        codigo = dados[i]
+        if codigo == 0 or i + codigo > len(dados) + 1:
+            raise ValueError("COBS inválido")
+        saida += dados[i + 1:i + codigo]
+        i += codigo
+        if codigo < 0xFF and i < len(dados):
+            saida.append(0)
+    return bytes(saida)
+
+
+class Decodificador:
+    def __init__(self, saida):
+        self.saida = saida
+        self.seq_esperada = None
+        self.quadros = 0
+        self.invalidos = 0
+        self.perdidos = 0
+
+    def quadro(self, linha):
+        try:
+            q = cobs_decodifica(linha)
+        except ValueError:
+            self.invalidos += 1
+            return
+        if len(q) < 4 or q[0] != VERSAO:
+            self.invalidos += 1
+            return
+        if crc16(q[:-2]) != struct.unpack_from("<H", q, len(q) - 2)[0]:
+            self.invalidos += 1
+            return
+
+        seq = q[1]
+        if self.seq_esperada is not None and seq != self.seq_esperada:
+            self.perdidos += (seq - self.seq_esperada) & 0xFF
+        self.seq_esperada = (seq + 1) & 0xFF
+        self.quadros += 1
+
+        i, fim = 2, len(q) - 2
+        while i + 2 <= fim:
+            tipo, tam = q[i], q[i + 1]
+            self.registro(tipo, q[i + 2:i + 2 + tam])
+            i += 2 + tam
+
+    def registro(self, tipo, r):
+        w = self.saida.write
+        if tipo == TEL_AMOSTRA:
+            t, agua, chuva, agua_mm, chuva_x10 = struct.unpack("<IHHHH", r[:12])
+            w(f"amostra,{t},{agua},{chuva},{agua_mm},{chuva_x10 / 10:.1f}\n")
+        elif tipo == TEL_ESTADO:
+            t, de, para = struct.unpack("<IBB", r)
+            w(f"estado,{t},{ESTADOS.get(de, de)},{ESTADOS.get(para, para)}\n")
+        elif tipo == TEL_STATS:
+            t, desc, quadros, nbytes, ocup = struct.unpack("<IIIIH", r[:18])
+            w(f"stats,{t},{desc},{quadros},{nbytes},{ocup}\n")
+        elif tipo == TEL_BRUTO:
+            t0, periodo = struct.unpack_from("<IH", r)
+            pares = struct.unpack_from(f"<{(len(r) - 6) // 2}H", r, 6)
+            for k in range(0, len(pares) - 1, 2):
+                w(f"bruto,{(t0 + (k // 2) * periodo) & 0xFFFFFFFF},{pares[k]},{pares[k + 1]}\n")
+        elif tipo == TEL_CANAIS:
+            t, mascara = struct.unpack_from("<IH", r)
+            ids = [k for k in range(16) if mascara >> k & 1]
+            for k, valor in zip(ids, struct.unpack_from(f"<{len(ids)}i", r, 6)):
+                w(f"canais,{t},{k},{valor}\n")
+        elif tipo == TEL_REINICIO:
+            causa, tarefa, atraso, ligado = struct.unpack("<B4sII", r[:13])
+            tarefa = tarefa.rstrip(b"\0").decode("ascii", "replace")
+            w(f"reinicio,,{CAUSAS.get(causa, causa)},{tarefa},{atraso},{ligado}\n")
+        elif tipo == TEL_ALARME:
+            t, de, para, causa = struct.unpack("<IBBB", r[:7])
+            w(f"alarme,{t},{FASES.get(de, de)},{FASES.get(para, para)},{CAUSAS_ALARME.get(causa, causa)}\n")
+        elif tipo == TEL_BOOT:
+            (orcamento,) = struct.unpack_from("<H", r)
+            marcas = struct.unpack_from(f"<{(len(r) - 2) // 4}I", r, 2)
+            for k, t_us in enumerate(marcas):
+                w(f"boot,{t_us},{FASES_BOOT[k] if k < len(FASES_BOOT) else k}\n")
+            total_ms = max(marcas, default=0) / 1000
+            w(f"boot,{max(marcas, default=0)},total,{total_ms:.1f},{orcamento},{'ok' if total_ms <= orcamento else 'estourado'}\n")
+        elif tipo == TEL_TAREFA:
+            tarefa, exec_max, ativacoes = struct.unpack("<4sII", r[:12])
+            tarefa = tarefa.rstrip(b"\0").decode("ascii", "replace")
+            w(f"tarefa,,{tarefa},{exec_max},{ativacoes}\n")
+        elif tipo == TEL_XIP:
+            estagio, na_ram, chamadas, medio, maximo, acessos, acertos = struct.unpack("<BB5I", r[:22])
+            nome = ESTAGIOS_XIP[estagio] if estagio < len(ESTAGIOS_XIP) else estagio
+            w(f"xip,,{nome},{'ram' if na_ram else 'flash'},{chamadas},{medio},{maximo},{acessos},{acertos}\n")
+        elif tipo == TEL_TEXTO:
+            texto = r.decode("ascii", "replace")
+            print(texto, file=sys.stderr)
+            w(f"texto,,{texto}\n")
+        else:
+            w(f"desconhecido,{tipo},{r.hex()}\n")
+
+
+def fonte_serial(porta, comandos):
+    import serial  # pyserial
+
+    with serial.Serial(porta, timeout=1) as s:
+        # Comandos de configuração (lib/config.h); as respostas chegam como registros de texto
+        for cmd in comandos:
+            s.write(cmd.encode("ascii") + b"\n")
+        while True:
+            bloco = s.read(s.in_waiting or 1)
+            if bloco:
+                yield bloco
+
+
+def fonte_arquivo(caminho):
+    with open(caminho, "rb") as f:
+        while True:
+            bloco = f.read(4096)
+            if not bloco:
+                return
+            yield bloco
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__.splitlines()[1])
+    ap.add_argument("entrada", help="porta serial (ex.: /dev/ttyACM0, COM5) ou arquivo com --arquivo")
+    ap.add_argument("--arquivo", action="store_true", help="entrada é um arquivo binário gravado")
+    ap.add_argument("-o", "--saida", default="-", help="CSV de saída (padrão: stdout)")
+    ap.add_argument("--gravar", help="também grava os bytes crus recebidos neste arquivo")
+    ap.add_argument("-c", "--comando", action="append", default=[],
+                    help="envia um comando de configuração ao conectar (pode repetir)")
+    args = ap.parse_args()
+
+    saida = sys.stdout if args.saida == "-" else open(args.saida, "w", buffering=1)
+    gravacao = open(args.gravar, "wb") if args.gravar else None
+    dec = Decodificador(saida)
+    pendente = bytearray()
+
+    fonte = fonte_arquivo(args.entrada) if args.arquivo else fonte_serial(args.entrada, args.comando)
+    try:
+        for bloco in fonte:
+            if gravacao:
+                gravacao.write(bloco)
+            pendente += bloco
+            while True:
+                fim = pendente.find(0)
+                if fim < 0:
+                    break
+                if fim > 0:
+                    dec.quadro(bytes(pendente[:fim]))
+                del pendente[:fim + 1]
+    except KeyboardInterrupt:
+        pass
+    finally:
+        print(f"quadros={dec.quadros} invalidos={dec.invalidos} perdidos={dec.perdidos}", file=sys.stderr)
+        if gravacao:
+            gravacao.close()
+        if saida is not sys.stdout:
+            saida.close()
+
+
+if __name__ == "__main__":
+    main()